@@ -0,0 +1,185 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Helpers shared by the standalone benchmark executables: a Zipf sampler,
+// --key=value argument parsing and a small streaming JSON writer.
+namespace engagehub::bench {
+
+// Draws ranks in [0, n) with P(k) proportional to 1 / (k + 1)^exponent.
+// The CDF is precomputed, so a draw is one uniform sample and a binary
+// search.
+class ZipfGenerator {
+public:
+    ZipfGenerator(std::size_t n, double exponent, std::uint64_t seed)
+        : cdf_(n == 0 ? 1 : n), rng_(seed) {
+        double total = 0.0;
+        for (std::size_t k = 0; k < cdf_.size(); ++k) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+            cdf_[k] = total;
+        }
+        for (auto& value : cdf_) {
+            value /= total;
+        }
+    }
+
+    std::size_t operator()() {
+        const double u = uniform_(rng_);
+        const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return std::min(static_cast<std::size_t>(it - cdf_.begin()), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+};
+
+// Parses --key=value flags; a bare --flag reads as "true".
+class Options {
+public:
+    Options(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg(argv[i]);
+            if (arg.substr(0, 2) != "--") {
+                throw std::invalid_argument("unexpected argument: " + std::string(arg));
+            }
+            arg.remove_prefix(2);
+            const auto eq = arg.find('=');
+            if (eq == std::string_view::npos) {
+                values_[std::string(arg)] = "true";
+            } else {
+                values_[std::string(arg.substr(0, eq))] = std::string(arg.substr(eq + 1));
+            }
+        }
+    }
+
+    std::string get(const std::string& key, const std::string& fallback) const {
+        const auto it = values_.find(key);
+        return it == values_.end() ? fallback : it->second;
+    }
+
+    std::size_t get_size(const std::string& key, std::size_t fallback) const {
+        const auto it = values_.find(key);
+        return it == values_.end() ? fallback : static_cast<std::size_t>(std::stoull(it->second));
+    }
+
+    double get_double(const std::string& key, double fallback) const {
+        const auto it = values_.find(key);
+        return it == values_.end() ? fallback : std::stod(it->second);
+    }
+
+    // Comma-separated list, e.g. --producers=1,2,4,8.
+    std::vector<std::size_t> get_sizes(const std::string& key, const std::string& fallback) const {
+        std::vector<std::size_t> result;
+        std::stringstream list(get(key, fallback));
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            if (!item.empty()) {
+                result.push_back(static_cast<std::size_t>(std::stoull(item)));
+            }
+        }
+        return result;
+    }
+
+private:
+    std::unordered_map<std::string, std::string> values_;
+};
+
+// Streaming JSON writer; callers nest begin/end calls and the writer
+// places the commas.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& out) : out_(out) { out_ << std::setprecision(6) << std::fixed; }
+
+    void begin_object(std::string_view key = {}) { open(key, '{'); }
+    void end_object() { close('}'); }
+    void begin_array(std::string_view key = {}) { open(key, '['); }
+    void end_array() { close(']'); }
+
+    template <typename Value>
+    void field(std::string_view key, const Value& value) {
+        separate(key);
+        write(value);
+    }
+
+    // p50/p99/p999/max of a histogram, in the histogram's own unit.
+    void latency(std::string_view key, const LatencySummary& summary) {
+        begin_object(key);
+        field("count", summary.count);
+        field("mean", summary.mean);
+        field("p50", summary.p50);
+        field("p90", summary.p90);
+        field("p99", summary.p99);
+        field("p999", summary.p999);
+        field("max", summary.max);
+        end_object();
+    }
+
+private:
+    void separate(std::string_view key) {
+        if (!first_.empty()) {
+            if (!first_.back()) {
+                out_ << ',';
+            }
+            first_.back() = false;
+        }
+        if (!key.empty()) {
+            write(key);
+            out_ << ':';
+        }
+    }
+
+    void open(std::string_view key, char bracket) {
+        separate(key);
+        out_ << bracket;
+        first_.push_back(true);
+    }
+
+    void close(char bracket) {
+        first_.pop_back();
+        out_ << bracket;
+        if (first_.empty()) {
+            out_ << '\n';
+        }
+    }
+
+    void write(std::string_view text) {
+        out_ << '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                out_ << '\\';
+            }
+            out_ << c;
+        }
+        out_ << '"';
+    }
+    void write(const std::string& text) { write(std::string_view(text)); }
+    void write(const char* text) { write(std::string_view(text)); }
+    void write(bool value) { out_ << (value ? "true" : "false"); }
+    void write(double value) { out_ << (std::isfinite(value) ? value : 0.0); }
+    template <typename Int, typename = std::enable_if_t<std::is_integral_v<Int>>>
+    void write(Int value) { out_ << value; }
+
+    std::ostream& out_;
+    // one entry per open container: true until its first member is written
+    std::vector<bool> first_;
+};
+
+} // namespace engagehub::bench
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace engagehub {
+
+// Appends fixed-width little-endian integers and LEB128 varints to a byte
+// string. Fields are encoded byte by byte, so the format does not depend on
+// the host's byte order or alignment.
+class ByteWriter {
+public:
+    explicit ByteWriter(std::string& out) : out_(out) {}
+
+    template <typename Int>
+    void put(Int value) {
+        static_assert(std::is_integral_v<Int>, "ByteWriter::put takes integers");
+        using Unsigned = std::make_unsigned_t<Int>;
+        auto bits = static_cast<Unsigned>(value);
+        for (std::size_t i = 0; i < sizeof(Int); ++i) {
+            out_.push_back(static_cast<char>(bits & 0xFFU));
+            bits = static_cast<Unsigned>(bits >> 8U);
+        }
+    }
+
+    void put_varint(std::uint64_t value) {
+        while (value >= 0x80U) {
+            out_.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+            value >>= 7U;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void put_bytes(const void* data, std::size_t size) {
+        out_.append(static_cast<const char*>(data), size);
+    }
+
+    std::size_t size() const noexcept { return out_.size(); }
+
+private:
+    std::string& out_;
+};
+
+// Bounds-checked reader for ByteWriter output. Reading past the end throws
+// std::runtime_error, so a truncated or corrupt buffer never reads out of
+// bounds.
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data) : data_(data) {}
+
+    template <typename Int>
+    Int get() {
+        static_assert(std::is_integral_v<Int>, "ByteReader::get takes integers");
+        using Unsigned = std::make_unsigned_t<Int>;
+        const auto* bytes = reinterpret_cast<const unsigned char*>(take(sizeof(Int)));
+        Unsigned bits = 0;
+        for (std::size_t i = sizeof(Int); i-- > 0;) {
+            bits = static_cast<Unsigned>((bits << 8U) | bytes[i]);
+        }
+        return static_cast<Int>(bits);
+    }
+
+    std::uint64_t get_varint() {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const auto byte = static_cast<unsigned char>(*take(1));
+            value |= static_cast<std::uint64_t>(byte & 0x7FU) << shift;
+            if ((byte & 0x80U) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("malformed varint in serialized data");
+    }
+
+    // Returns a view of the next `size` bytes without copying them.
+    std::string_view get_bytes(std::size_t size) { return std::string_view(take(size), size); }
+
+    std::size_t remaining() const noexcept { return data_.size() - offset_; }
+    std::size_t offset() const noexcept { return offset_; }
+
+private:
+    const char* take(std::size_t size) {
+        if (size > remaining()) {
+            throw std::runtime_error("serialized data is truncated");
+        }
+        const char* at = data_.data() + offset_;
+        offset_ += size;
+        return at;
+    }
+
+    std::string_view data_;
+    std::size_t offset_ = 0;
+};
+
+} // namespace engagehub
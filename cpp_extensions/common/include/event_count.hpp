@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace engagehub {
+
+// Hint to the CPU that the caller is busy-waiting.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Wake-up channel that only pays for a kernel call when someone is parked.
+//
+// A waiter announces itself with prepare_wait(), re-checks its condition and
+// then either cancel_wait()s or wait_until()s with the returned key. A
+// notifier makes the condition true first and then calls notify(); when no
+// waiter is registered that is one fence and one load. The fences on both
+// sides order "condition published" against "waiter registered", so either
+// the waiter sees the condition or the notifier sees the waiter.
+class EventCount {
+public:
+    using Key = std::uint64_t;
+
+    Key prepare_wait() noexcept {
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    void cancel_wait() noexcept { waiters_.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Returns false if the deadline passed without a notify().
+    template <typename Clock, typename Duration>
+    bool wait_until(Key key, const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const bool woken = cv_.wait_until(lock, deadline, [this, key]() {
+            return epoch_.load(std::memory_order_acquire) != key;
+        });
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return woken;
+    }
+
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            epoch_.fetch_add(1, std::memory_order_release);
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::atomic<Key> epoch_{0};
+    std::atomic<std::uint32_t> waiters_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+} // namespace engagehub
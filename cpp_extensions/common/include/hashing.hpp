@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace engagehub {
+namespace hashing {
+
+// Seed of the 64-bit hash every sketch consumes. Changing it changes every
+// hash, including the ones cached by StringInterner.
+constexpr std::uint64_t kDefaultSeed = 0xadc83b19ULL;
+
+// MurmurHash3 x64-128, folded to 64 bits.
+std::uint64_t murmur3_64(const void* key, std::size_t len, std::uint64_t seed) noexcept;
+
+inline std::uint64_t hash64(std::string_view key) noexcept {
+    return murmur3_64(key.data(), key.size(), kDefaultSeed);
+}
+
+// Murmur3 finaliser: a cheap bijective mix used to derive further hashes
+// from one 64-bit key hash.
+constexpr std::uint64_t mix64(std::uint64_t k) noexcept {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// Kirsch-Mitzenmacher double hashing: row i of a sketch uses
+// first + i * step, so one key hash yields any number of row indices.
+struct DoubleHash {
+    std::uint64_t first;
+    std::uint64_t step;
+
+    constexpr std::uint64_t row(std::size_t i) const noexcept {
+        return first + static_cast<std::uint64_t>(i) * step;
+    }
+};
+
+constexpr DoubleHash double_hash(std::uint64_t hash, std::uint64_t seed) noexcept {
+    const std::uint64_t first = mix64(hash ^ seed);
+    // odd, so successive rows never collapse onto one column
+    const std::uint64_t step = mix64(first + 0x9e3779b97f4a7c15ULL) | 1ULL;
+    return DoubleHash{first, step};
+}
+
+} // namespace hashing
+} // namespace engagehub
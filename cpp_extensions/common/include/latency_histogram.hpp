@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace engagehub {
+
+// Point-in-time summary of a LatencyHistogram. Percentiles are bucket upper
+// bounds, so they overstate the true value by at most one bucket width.
+struct LatencySummary {
+    std::uint64_t count = 0;
+    std::uint64_t max = 0;
+    double mean = 0.0;
+    std::uint64_t p50 = 0;
+    std::uint64_t p90 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+};
+
+// HDR-style log-linear histogram over the full uint64 range.
+//
+// Values below kSubBuckets get one bucket each; above that every power of
+// two is split into kSubBuckets equal buckets, keeping the relative error
+// under 1 / kSubBuckets (about 6%). record() is a handful of relaxed atomic
+// increments with no allocation or lock, so any thread may record while
+// another summarises.
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 4;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+    static constexpr std::size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    void record(std::uint64_t value) noexcept;
+    LatencySummary summary() const noexcept;
+    void reset() noexcept;
+
+    static std::size_t bucket_index(std::uint64_t value) noexcept;
+    // Largest value that lands in bucket `index`.
+    static std::uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> counts_{};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+} // namespace engagehub
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace engagehub {
+
+// Move-only type-erased `void()` callable with inline storage.
+//
+// Callables up to kInlineSize bytes (a few captured pointers plus a batch
+// vector) are stored in place, so queueing one does not allocate. Larger
+// ones fall back to a single heap allocation. Unlike std::function this also
+// accepts move-only callables such as std::packaged_task.
+class Task {
+public:
+    static constexpr std::size_t kInlineSize = 64;
+
+    Task() noexcept = default;
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& fn) {  // implicit, like std::function
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>()) {
+            new (buffer_) Fn(std::forward<F>(fn));
+            ops_ = &inline_ops<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(buffer_) = new Fn(std::forward<F>(fn));
+            ops_ = &heap_ops<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept { take(other); }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { ops_->invoke(buffer_); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool fits_inline() {
+        return sizeof(Fn) <= kInlineSize &&
+               alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops inline_ops{
+        [](void* storage) { (*std::launder(reinterpret_cast<Fn*>(storage)))(); },
+        [](void* dst, void* src) noexcept {
+            auto* from = std::launder(reinterpret_cast<Fn*>(src));
+            new (dst) Fn(std::move(*from));
+            from->~Fn();
+        },
+        [](void* storage) noexcept { std::launder(reinterpret_cast<Fn*>(storage))->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops heap_ops{
+        [](void* storage) { (**reinterpret_cast<Fn**>(storage))(); },
+        [](void* dst, void* src) noexcept {
+            *reinterpret_cast<Fn**>(dst) = *reinterpret_cast<Fn**>(src);
+        },
+        [](void* storage) noexcept { delete *reinterpret_cast<Fn**>(storage); },
+    };
+
+    void take(Task& other) noexcept {
+        ops_ = other.ops_;
+        if (ops_) {
+            ops_->move(buffer_, other.buffer_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer_[kInlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+} // namespace engagehub
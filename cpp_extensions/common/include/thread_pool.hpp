@@ -0,0 +1,118 @@
+#pragma once
+
+#include "task.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace engagehub {
+
+// Work-stealing thread pool.
+//
+// Every worker owns a deque guarded by its own mutex: external submissions
+// are spread round-robin across the deques, tasks submitted from a worker go
+// to that worker's deque, owners pop LIFO and idle workers steal FIFO from
+// their peers. There is no pool-wide queue lock, so submission and execution
+// scale with the number of workers.
+//
+// Exceptions escaping a fire-and-forget task are counted and forwarded to the
+// exception handler if one is set; submit() delivers them through the future.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t num_threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Throws std::runtime_error once the pool is shut down; `task` is only
+    // moved from if it was accepted, so the caller can still run it inline.
+    void enqueue(Task&& task);
+
+    // Queues [first, last) with one lock per worker deque and one wake-up.
+    template <typename InputIt>
+    void enqueue_bulk(InputIt first, InputIt last);
+
+    template <typename F>
+    auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&>>;
+
+    void set_exception_handler(std::function<void(std::exception_ptr)> handler);
+
+    void shutdown();
+
+    std::size_t size() const noexcept { return queues_.size(); }
+    std::size_t pending() const noexcept { return queued_.load(std::memory_order_acquire); }
+    std::uint64_t failed_tasks() const noexcept { return failed_tasks_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void ensure_running() const;
+    std::size_t target_queue();
+    void push_tasks(std::size_t queue_index, std::vector<Task>& tasks);
+    void wake_workers(std::size_t count);
+    bool pop_local(std::size_t index, Task& task);
+    bool steal(std::size_t thief, Task& task);
+    void run(Task& task) noexcept;
+    void worker_loop(std::size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> next_queue_{0};
+    std::atomic<std::size_t> sleepers_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> stopping_;
+
+    std::atomic<std::uint64_t> failed_tasks_{0};
+    std::mutex handler_mutex_;
+    std::function<void(std::exception_ptr)> exception_handler_;
+};
+
+template <typename InputIt>
+void ThreadPool::enqueue_bulk(InputIt first, InputIt last) {
+    ensure_running();
+    std::vector<std::vector<Task>> slices(queues_.size());
+    std::size_t queue_index = next_queue_.fetch_add(1, std::memory_order_relaxed);
+    std::size_t count = 0;
+    for (; first != last; ++first, ++count) {
+        slices[queue_index++ % slices.size()].emplace_back(std::move(*first));
+    }
+    if (count == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i < slices.size(); ++i) {
+        if (!slices[i].empty()) {
+            push_tasks(i, slices[i]);
+        }
+    }
+    wake_workers(count);
+}
+
+template <typename F>
+auto ThreadPool::submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+    using Result = std::invoke_result_t<std::decay_t<F>&>;
+    std::packaged_task<Result()> packaged(std::forward<F>(fn));
+    auto future = packaged.get_future();
+    enqueue(Task(std::move(packaged)));
+    return future;
+}
+
+} // namespace engagehub
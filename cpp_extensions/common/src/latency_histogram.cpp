@@ -0,0 +1,77 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engagehub {
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value) noexcept {
+    if (value < kSubBuckets) {
+        return static_cast<std::size_t>(value);
+    }
+    const unsigned top_bit = 63U - static_cast<unsigned>(__builtin_clzll(value));
+    const unsigned shift = top_bit - kSubBucketBits;
+    // the kSubBucketBits bits below the leading one pick the sub-bucket
+    const auto sub = static_cast<std::size_t>((value >> shift) - kSubBuckets);
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) noexcept {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const auto shift = static_cast<unsigned>(index / kSubBuckets - 1);
+    const std::uint64_t lower = static_cast<std::uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    return lower + ((std::uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(std::uint64_t value) noexcept {
+    counts_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    std::uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySummary LatencyHistogram::summary() const noexcept {
+    // copy first so the percentiles agree with one another even while
+    // other threads keep recording
+    std::array<std::uint64_t, kBucketCount> counts{};
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        count += counts[i];
+    }
+
+    LatencySummary result;
+    result.count = count;
+    if (count == 0) {
+        return result;
+    }
+    result.max = max_.load(std::memory_order_relaxed);
+    result.mean = static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(count);
+
+    const std::pair<double, std::uint64_t*> targets[] = {
+        {0.50, &result.p50}, {0.90, &result.p90}, {0.99, &result.p99}, {0.999, &result.p999}};
+    std::size_t bucket = 0;
+    std::uint64_t seen = counts[0];
+    for (const auto& [quantile, out] : targets) {
+        const auto rank = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(std::ceil(quantile * static_cast<double>(count))));
+        while (seen < rank && bucket + 1 < kBucketCount) {
+            seen += counts[++bucket];
+        }
+        *out = std::min(bucket_upper_bound(bucket), result.max);
+    }
+    return result;
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace engagehub
@@ -0,0 +1,51 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace engagehub {
+
+namespace {
+std::runtime_error mapping_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+} // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw mapping_error("Failed to open", path);
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        const auto error = mapping_error("Failed to stat", path);
+        ::close(fd);
+        throw error;
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ != 0) {
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            const auto error = mapping_error("Failed to map", path);
+            ::close(fd);
+            throw error;
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+}
+
+} // namespace engagehub
@@ -0,0 +1,182 @@
+#include "thread_pool.hpp"
+
+#include <stdexcept>
+
+namespace engagehub {
+
+namespace {
+
+// Identifies the pool and deque owned by the calling worker thread so that
+// tasks spawned from inside a task stay on the local deque.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t num_threads)
+    : stopping_(false) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    queues_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+void ThreadPool::enqueue(Task&& task) {
+    ensure_running();
+    std::size_t index = target_queue();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+        queued_.fetch_add(1);
+    }
+    wake_workers(1);
+}
+
+void ThreadPool::set_exception_handler(std::function<void(std::exception_ptr)> handler) {
+    std::lock_guard<std::mutex> lock(handler_mutex_);
+    exception_handler_ = std::move(handler);
+}
+
+void ThreadPool::shutdown() {
+    bool expected = false;
+    if (!stopping_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        return; // already stopped
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_cv_.notify_all();
+    // Workers drain every queued task before exiting.
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+void ThreadPool::ensure_running() const {
+    if (stopping_.load(std::memory_order_acquire)) {
+        throw std::runtime_error("ThreadPool enqueue on stopped pool");
+    }
+}
+
+std::size_t ThreadPool::target_queue() {
+    if (current_pool == this) {
+        return current_index;
+    }
+    return next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+}
+
+void ThreadPool::push_tasks(std::size_t queue_index, std::vector<Task>& tasks) {
+    auto& queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto& task : tasks) {
+        queue.tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(tasks.size());
+}
+
+void ThreadPool::wake_workers(std::size_t count) {
+    // queued_ was raised (seq_cst) before sleepers_ is read here, and a worker
+    // raises sleepers_ before re-checking queued_ under sleep_mutex_, so at
+    // least one side always sees the other and no wake-up is lost.
+    if (sleepers_.load() == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    if (count == 1) {
+        wake_cv_.notify_one();
+    } else {
+        wake_cv_.notify_all();
+    }
+}
+
+bool ThreadPool::pop_local(std::size_t index, Task& task) {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued_.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, Task& task) {
+    const std::size_t count = queues_.size();
+    for (std::size_t offset = 1; offset < count; ++offset) {
+        auto& queue = *queues_[(thief + offset) % count];
+        // A contended victim is skipped; queued_ stays non-zero so the thief
+        // retries instead of going to sleep.
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued_.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(Task& task) noexcept {
+    try {
+        task();
+    } catch (...) {
+        failed_tasks_.fetch_add(1, std::memory_order_relaxed);
+        std::function<void(std::exception_ptr)> handler;
+        {
+            std::lock_guard<std::mutex> lock(handler_mutex_);
+            handler = exception_handler_;
+        }
+        if (handler) {
+            try {
+                handler(std::current_exception());
+            } catch (...) {
+                // a failing handler must not take the worker down
+            }
+        }
+    }
+    task.reset();
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+    current_pool = this;
+    current_index = index;
+    while (true) {
+        Task task;
+        if (pop_local(index, task) || steal(index, task)) {
+            run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        wake_cv_.wait(lock, [this]() {
+            return queued_.load() > 0 || stopping_.load(std::memory_order_acquire);
+        });
+        sleepers_.fetch_sub(1);
+        if (queued_.load() == 0 && stopping_.load(std::memory_order_acquire)) {
+            return;
+        }
+    }
+}
+
+} // namespace engagehub
@@ -0,0 +1,50 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "event_count.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using engagehub::EventCount;
+
+TEST_CASE("EventCount wakes a parked waiter") {
+    EventCount event;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> woke{false};
+
+    std::thread waiter([&]() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!ready.load()) {
+            const auto key = event.prepare_wait();
+            if (ready.load()) {
+                event.cancel_wait();
+                break;
+            }
+            event.wait_until(key, deadline);
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return;
+            }
+        }
+        woke.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ready.store(true);
+    event.notify();
+    waiter.join();
+    REQUIRE(woke.load());
+}
+
+TEST_CASE("EventCount wait_until times out without a notify") {
+    EventCount event;
+    const auto key = event.prepare_wait();
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(event.wait_until(key, start + std::chrono::milliseconds(10)));
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(10));
+
+    // a notify that lands between prepare_wait and wait_until is not lost
+    const auto next = event.prepare_wait();
+    event.notify();
+    REQUIRE(event.wait_until(next, std::chrono::steady_clock::now() + std::chrono::seconds(5)));
+}
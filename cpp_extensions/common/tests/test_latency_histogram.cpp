@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "latency_histogram.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using engagehub::LatencyHistogram;
+
+TEST_CASE("LatencyHistogram buckets stay within the relative error bound") {
+    REQUIRE(LatencyHistogram::bucket_index(0) == 0);
+    REQUIRE(LatencyHistogram::bucket_index(15) == 15);
+    REQUIRE(LatencyHistogram::bucket_index(std::numeric_limits<std::uint64_t>::max()) ==
+            LatencyHistogram::kBucketCount - 1);
+
+    for (std::uint64_t value = 1; value < (std::uint64_t{1} << 40); value = value * 3 + 1) {
+        const auto index = LatencyHistogram::bucket_index(value);
+        const auto upper = LatencyHistogram::bucket_upper_bound(index);
+        REQUIRE(upper >= value);
+        REQUIRE(upper - value <= value / LatencyHistogram::kSubBuckets);
+        if (index != 0) {
+            REQUIRE(LatencyHistogram::bucket_upper_bound(index - 1) < value);
+        }
+    }
+}
+
+TEST_CASE("LatencyHistogram reports percentiles of recorded values") {
+    LatencyHistogram histogram;
+    REQUIRE(histogram.summary().count == 0);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&histogram]() {
+            for (std::uint64_t value = 1; value <= 1000; ++value) {
+                histogram.record(value);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    const auto summary = histogram.summary();
+    REQUIRE(summary.count == 4000);
+    REQUIRE(summary.max == 1000);
+    REQUIRE(summary.mean > 500.0);
+    REQUIRE(summary.mean < 501.0);
+    REQUIRE(summary.p50 >= 500);
+    REQUIRE(summary.p50 <= 532);
+    REQUIRE(summary.p99 >= 990);
+    REQUIRE(summary.p999 == 1000);
+
+    histogram.reset();
+    REQUIRE(histogram.summary().count == 0);
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "task.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using engagehub::Task;
+using engagehub::ThreadPool;
+
+TEST_CASE("Task stores small and large callables") {
+    int calls = 0;
+    Task small([&calls]() { ++calls; });
+    REQUIRE(static_cast<bool>(small));
+    small();
+
+    struct Large {
+        int* calls;
+        char padding[Task::kInlineSize * 2];
+        void operator()() { ++*calls; }
+    };
+    Task large(Large{&calls, {}});
+    Task moved(std::move(large));
+    REQUIRE_FALSE(static_cast<bool>(large));
+    moved();
+
+    auto owned = std::make_unique<int>(5);
+    Task move_only([&calls, value = std::move(owned)]() { calls += *value; });
+    move_only();
+
+    REQUIRE(calls == 7);
+    moved.reset();
+    REQUIRE_FALSE(static_cast<bool>(moved));
+}
+
+TEST_CASE("ThreadPool submit returns values and exceptions through futures") {
+    ThreadPool pool(4);
+
+    auto value = pool.submit([]() { return 40 + 2; });
+    REQUIRE(value.get() == 42);
+
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    REQUIRE_THROWS_AS(failing.get(), std::runtime_error);
+
+    // Exceptions consumed by a future are not task failures.
+    REQUIRE(pool.failed_tasks() == 0);
+}
+
+TEST_CASE("ThreadPool enqueue_bulk runs every task") {
+    ThreadPool pool(4);
+    constexpr int task_count = 10000;
+    std::atomic<int> executed{0};
+
+    std::vector<Task> tasks;
+    tasks.reserve(task_count);
+    for (int i = 0; i < task_count; ++i) {
+        tasks.emplace_back([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+    }
+    pool.enqueue_bulk(tasks.begin(), tasks.end());
+    pool.shutdown();
+
+    REQUIRE(executed.load() == task_count);
+    REQUIRE(pool.pending() == 0);
+}
+
+TEST_CASE("ThreadPool tasks can spawn nested work") {
+    ThreadPool pool(2);
+    std::atomic<int> executed{0};
+    std::promise<void> done;
+
+    for (int i = 0; i < 100; ++i) {
+        pool.enqueue([&pool, &executed, &done]() {
+            pool.enqueue([&executed, &done]() {
+                if (executed.fetch_add(1) + 1 == 100) {
+                    done.set_value();
+                }
+            });
+        });
+    }
+    REQUIRE(done.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+}
+
+TEST_CASE("ThreadPool reports failed tasks to the exception handler") {
+    ThreadPool pool(2);
+    std::atomic<int> handled{0};
+    pool.set_exception_handler([&handled](std::exception_ptr error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::logic_error&) {
+            handled.fetch_add(1);
+        }
+    });
+
+    for (int i = 0; i < 3; ++i) {
+        pool.enqueue([]() { throw std::logic_error("bad task"); });
+    }
+    auto after = pool.submit([]() { return true; });
+    REQUIRE(after.get());
+    pool.shutdown();
+
+    REQUIRE(pool.failed_tasks() == 3);
+    REQUIRE(handled.load() == 3);
+}
+
+TEST_CASE("ThreadPool rejects work after shutdown without consuming it") {
+    ThreadPool pool(1);
+    pool.shutdown();
+
+    bool ran = false;
+    Task task([&ran]() { ran = true; });
+    REQUIRE_THROWS_AS(pool.enqueue(std::move(task)), std::runtime_error);
+    REQUIRE(static_cast<bool>(task));
+    task();
+    REQUIRE(ran);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "event_processor.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace engagehub {
+
+// Bounded hand-off of flushed batches to a thread that runs an event loop.
+// Pool workers push; the loop thread registers fd() with its poller (for
+// asyncio, loop.add_reader) and pops once it turns readable. The descriptor
+// is an eventfd where available and the read end of a pipe elsewhere; it
+// is readable exactly while batches are queued or the queue is closed.
+class BatchQueue {
+public:
+    // Throws std::runtime_error if the descriptor cannot be created.
+    explicit BatchQueue(std::size_t capacity);
+    ~BatchQueue();
+
+    BatchQueue(const BatchQueue&) = delete;
+    BatchQueue& operator=(const BatchQueue&) = delete;
+
+    // Returns false, leaving `batch` with the caller, when the queue is full
+    // or closed.
+    bool push(EventBatch& batch);
+    std::optional<EventBatch> try_pop();
+    // Rejects further pushes and wakes the reader; queued batches can still
+    // be popped.
+    void close();
+
+    bool closed() const;
+    std::size_t size() const;
+    std::size_t capacity() const noexcept { return capacity_; }
+    int fd() const noexcept { return read_fd_; }
+
+    // Flush callback feeding `queue`. A full or closed queue makes it throw,
+    // so the batch counts as a failed delivery and is spilled when the
+    // processor has a journal.
+    static std::function<void(EventBatch)> sink(std::shared_ptr<BatchQueue> queue);
+
+private:
+    void signal();
+    void clear_signal();
+
+    std::size_t capacity_;
+    int read_fd_ = -1;
+    int write_fd_ = -1;
+
+    mutable std::mutex mutex_;
+    std::deque<EventBatch> ready_;
+    bool closed_ = false;
+    // whether fd() is currently readable
+    bool signalled_ = false;
+};
+
+} // namespace engagehub
@@ -1,29 +1,117 @@
 #pragma once
 
+#include "byte_io.hpp"
+#include "hashing.hpp"
+
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <string>
-#include <vector>
+#include <memory>
+#include <string_view>
 
 namespace engagehub {
 
-class CountMinSketch {
+namespace detail {
+
+// Counter table with a compile-time Width x Depth shape, stored inline.
+template <std::size_t Width, std::size_t Depth>
+class SketchTable {
 public:
-    CountMinSketch(std::size_t width = 2048, std::size_t depth = 4, std::uint64_t seed = 12345);
+    SketchTable(std::size_t, std::size_t) {}
+
+    static constexpr std::size_t width() noexcept { return Width; }
+    static constexpr std::size_t depth() noexcept { return Depth; }
+    std::atomic<std::uint64_t>* data() noexcept { return counters_.data(); }
+    const std::atomic<std::uint64_t>* data() const noexcept { return counters_.data(); }
+
+private:
+    std::array<std::atomic<std::uint64_t>, Width * Depth> counters_{};
+};
 
-    void increment(const std::string& key, std::uint64_t count = 1);
-    std::uint64_t estimate(const std::string& key) const;
+// Runtime-sized table (Width == Depth == 0).
+template <>
+class SketchTable<0, 0> {
+public:
+    SketchTable(std::size_t width, std::size_t depth)
+        : width_(width), depth_(depth), counters_(new std::atomic<std::uint64_t>[width * depth]) {}
 
     std::size_t width() const noexcept { return width_; }
     std::size_t depth() const noexcept { return depth_; }
+    std::atomic<std::uint64_t>* data() noexcept { return counters_.get(); }
+    const std::atomic<std::uint64_t>* data() const noexcept { return counters_.get(); }
 
 private:
-    std::uint64_t hash(const std::string& key, std::size_t index) const;
-
     std::size_t width_;
     std::size_t depth_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counters_;
+};
+
+} // namespace detail
+
+// Counters are relaxed atomics: increments from several threads are safe and
+// estimates can be read concurrently without a lock. An estimate may miss an
+// in-flight increment but never exceeds the eventual value.
+//
+// Each key is hashed once (hashing::hash64, the same hash HyperLogLog and
+// StringInterner use) and the per-row columns come from double hashing, so
+// callers holding a cached hash use increment_hash / estimate_hash and skip
+// hashing entirely. Width and Depth fix the shape at compile time so row
+// indexing uses constants; Width == Depth == 0 takes it from the constructor.
+template <std::size_t Width = 0, std::size_t Depth = 0>
+class CountMinSketch {
+    static_assert((Width == 0) == (Depth == 0), "CountMinSketch width and depth must both be fixed or both runtime");
+    static_assert((Width & (Width - 1)) == 0, "CountMinSketch width must be power of two");
+
+public:
+    static constexpr std::uint64_t kDefaultSeed = 12345;
+
+    template <std::size_t W = Width, std::enable_if_t<W != 0, int> = 0>
+    explicit CountMinSketch(std::uint64_t seed = kDefaultSeed)
+        : seed_(seed), table_(Width, Depth) {
+        reset();
+    }
+
+    template <std::size_t W = Width, std::enable_if_t<W == 0, int> = 0>
+    CountMinSketch(std::size_t width = 2048, std::size_t depth = 4, std::uint64_t seed = kDefaultSeed);
+
+    void increment(std::string_view key, std::uint64_t count = 1) { increment_hash(hashing::hash64(key), count); }
+    void increment_hash(std::uint64_t hash, std::uint64_t count = 1);
+
+    std::uint64_t estimate(std::string_view key) const { return estimate_hash(hashing::hash64(key)); }
+    std::uint64_t estimate_hash(std::uint64_t hash) const;
+
+    std::size_t width() const noexcept { return table_.width(); }
+    std::size_t depth() const noexcept { return table_.depth(); }
+    std::uint64_t seed() const noexcept { return seed_; }
+
+    // Adds another sketch's counters to this one. Both must share width,
+    // depth and seed, which is what makes their cells line up.
+    template <std::size_t OtherWidth, std::size_t OtherDepth>
+    void merge(const CountMinSketch<OtherWidth, OtherDepth>& other);
+
+    // Shape and seed followed by every counter as a varint; idle cells cost
+    // one byte each.
+    void serialize(ByteWriter& out) const;
+    // Adds a serialized sketch's counters. The input is validated in full
+    // before any counter changes; throws std::runtime_error if it is
+    // malformed and std::invalid_argument if its shape or seed differs.
+    void merge_serialized(ByteReader& in);
+
+private:
+    template <std::size_t, std::size_t>
+    friend class CountMinSketch;
+
+
+    void reset();
+    std::size_t column(const hashing::DoubleHash& hash, std::size_t row) const noexcept {
+        return row * width() + (hash.row(row) & (width() - 1));
+    }
+
     std::uint64_t seed_;
-    std::vector<std::uint64_t> table_;
+    detail::SketchTable<Width, Depth> table_;
 };
 
 } // namespace engagehub
+
+#include "count_min_sketch.tpp"
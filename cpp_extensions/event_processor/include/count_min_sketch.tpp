@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace engagehub {
+
+template <std::size_t Width, std::size_t Depth>
+template <std::size_t W, std::enable_if_t<W == 0, int>>
+CountMinSketch<Width, Depth>::CountMinSketch(std::size_t width, std::size_t depth, std::uint64_t seed)
+    : seed_(seed), table_(width, depth) {
+    if (width == 0 || (width & (width - 1)) != 0) {
+        throw std::invalid_argument("CountMinSketch width must be power of two");
+    }
+    if (depth == 0) {
+        throw std::invalid_argument("CountMinSketch depth must be greater than zero");
+    }
+    reset();
+}
+
+template <std::size_t Width, std::size_t Depth>
+void CountMinSketch<Width, Depth>::reset() {
+    auto* counters = table_.data();
+    for (std::size_t i = 0; i < width() * depth(); ++i) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+template <std::size_t Width, std::size_t Depth>
+void CountMinSketch<Width, Depth>::increment_hash(std::uint64_t hash, std::uint64_t count) {
+    const auto rows = hashing::double_hash(hash, seed_);
+    auto* counters = table_.data();
+    for (std::size_t i = 0; i < depth(); ++i) {
+        counters[column(rows, i)].fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+template <std::size_t Width, std::size_t Depth>
+std::uint64_t CountMinSketch<Width, Depth>::estimate_hash(std::uint64_t hash) const {
+    const auto rows = hashing::double_hash(hash, seed_);
+    const auto* counters = table_.data();
+    std::uint64_t result = std::numeric_limits<std::uint64_t>::max();
+    for (std::size_t i = 0; i < depth(); ++i) {
+        result = std::min(result, counters[column(rows, i)].load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+template <std::size_t Width, std::size_t Depth>
+template <std::size_t OtherWidth, std::size_t OtherDepth>
+void CountMinSketch<Width, Depth>::merge(const CountMinSketch<OtherWidth, OtherDepth>& other) {
+    if (other.width() != width() || other.depth() != depth() || other.seed() != seed_) {
+        throw std::invalid_argument("Cannot merge CountMinSketch with a different shape or seed");
+    }
+    auto* counters = table_.data();
+    const auto* incoming = other.table_.data();
+    for (std::size_t i = 0; i < width() * depth(); ++i) {
+        counters[i].fetch_add(incoming[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+template <std::size_t Width, std::size_t Depth>
+void CountMinSketch<Width, Depth>::serialize(ByteWriter& out) const {
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(width()));
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(depth()));
+    out.put<std::uint64_t>(seed_);
+    const auto* counters = table_.data();
+    for (std::size_t i = 0; i < width() * depth(); ++i) {
+        out.put_varint(counters[i].load(std::memory_order_relaxed));
+    }
+}
+
+template <std::size_t Width, std::size_t Depth>
+void CountMinSketch<Width, Depth>::merge_serialized(ByteReader& in) {
+    const auto other_width = in.get<std::uint32_t>();
+    const auto other_depth = in.get<std::uint32_t>();
+    const auto other_seed = in.get<std::uint64_t>();
+    if (other_width != width() || other_depth != depth() || other_seed != seed_) {
+        throw std::invalid_argument("Cannot merge CountMinSketch with a different shape or seed");
+    }
+    std::vector<std::uint64_t> incoming(width() * depth());
+    for (auto& count : incoming) {
+        count = in.get_varint();
+    }
+    auto* counters = table_.data();
+    for (std::size_t i = 0; i < incoming.size(); ++i) {
+        counters[i].fetch_add(incoming[i], std::memory_order_relaxed);
+    }
+}
+
+} // namespace engagehub
@@ -1,99 +1,387 @@
 #pragma once
 
 #include "count_min_sketch.hpp"
+#include "event_count.hpp"
 #include "hyperloglog.hpp"
+#include "keyed_hyperloglog.hpp"
+#include "latency_histogram.hpp"
 #include "ring_buffer.hpp"
+#include "sliding_hyperloglog.hpp"
+#include "space_saving.hpp"
+#include "spill_journal.hpp"
+#include "string_interner.hpp"
 #include "thread_pool.hpp"
 
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
-#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 #include <thread>
 
 namespace engagehub {
 
+// Plain-data event; string fields are ids into the processor's StringInterner.
 struct Event {
-    std::string event_type;
-    std::string user_id;
-    std::string channel_id;
+    InternId event_type;
+    InternId user_id;
+    InternId channel_id;
+    // Low 32 bits of the steady clock in microseconds when a sampled event
+    // was pushed, 0 when it was not sampled. Fills what would otherwise be
+    // padding before `timestamp`.
+    std::uint32_t enqueued_us = 0;
     std::int64_t timestamp;
 };
+static_assert(sizeof(Event) == 24, "Event is carried by value through the rings; keep it compact");
+
+// A flushed batch together with the table needed to turn ids back into
+// strings. The table is shared, so a batch may outlive its processor. The
+// events are immutable and shared too, so copying a batch is cheap.
+class EventBatch {
+public:
+    EventBatch() = default;
+    EventBatch(std::vector<Event> events, std::shared_ptr<const StringInterner> strings)
+        : events_(std::make_shared<const std::vector<Event>>(std::move(events))), strings_(std::move(strings)) {}
+
+    const std::vector<Event>& events() const noexcept { return events_ ? *events_ : kNoEvents; }
+    std::size_t size() const noexcept { return events().size(); }
+    bool empty() const noexcept { return events().empty(); }
+    const Event& operator[](std::size_t index) const { return (*events_)[index]; }
+
+    const std::string& resolve(InternId id) const { return strings_->resolve(id); }
+    const std::string& event_type(const Event& event) const { return resolve(event.event_type); }
+    const std::string& user_id(const Event& event) const { return resolve(event.user_id); }
+    const std::string& channel_id(const Event& event) const { return resolve(event.channel_id); }
+
+    const std::shared_ptr<const StringInterner>& strings() const noexcept { return strings_; }
+
+private:
+    inline static const std::vector<Event> kNoEvents{};
+
+    std::shared_ptr<const std::vector<Event>> events_;
+    std::shared_ptr<const StringInterner> strings_;
+};
+
+// What a push does when its shard's ring is full.
+enum class OverflowPolicy {
+    Drop,            // reject the event and count it in events_dropped()
+    Block,           // wait up to block_timeout_ms for space, then drop
+    OverwriteOldest, // discard the oldest queued event to make room
+};
+
+// How much latency instrumentation the pipeline records. Counters and
+// gauges are always maintained.
+enum class MetricsMode {
+    Off,     // no latency histograms
+    Sampled, // enqueue latency from one event in kMetricsSampleInterval per producer thread
+    Full,    // enqueue latency from every event
+};
+
+struct ShardMetrics {
+    std::size_t ring_occupancy = 0;
+    std::size_t ring_capacity = 0;
+    std::size_t pending_batch = 0;
+    // fraction of the consumer's lifetime not spent parked
+    double busy_ratio = 0.0;
+};
+
+// Latencies are in microseconds.
+struct PipelineMetrics {
+    std::uint64_t events_processed = 0;
+    std::uint64_t events_dropped = 0;
+    std::uint64_t events_overwritten = 0;
+    std::uint64_t batches_flushed = 0;
+    std::uint64_t flush_callback_failures = 0;
+    std::uint64_t events_spilled = 0;
+    std::uint64_t events_replayed = 0;
+    std::size_t spill_pending_records = 0;
+    std::size_t pending_flush_tasks = 0;
+    std::size_t pool_queued_tasks = 0;
+    double consumer_busy_ratio = 0.0;
+    // push until the batch holding the event is handed to the pool
+    LatencySummary enqueue_to_flush_us;
+    // batch handed to the pool until its callback starts
+    LatencySummary flush_queue_us;
+    LatencySummary callback_us;
+    std::vector<ShardMetrics> shards;
+};
 
 class EventStreamProcessor {
 public:
     EventStreamProcessor(std::size_t buffer_size,
                          std::size_t num_threads,
                          std::size_t batch_size,
-                         std::size_t flush_interval_ms);
+                         std::size_t flush_interval_ms,
+                         std::size_t num_shards = 1,
+                         std::size_t top_channel_capacity = 1024,
+                         OverflowPolicy overflow_policy = OverflowPolicy::Drop,
+                         std::size_t block_timeout_ms = 100,
+                         std::size_t dimension_memory_budget = kDefaultDimensionMemoryBudget);
     ~EventStreamProcessor();
 
-    bool push_event(const std::string& event_type,
-                    const std::string& user_id,
-                    const std::string& channel_id,
+    // Per-channel and per-event-type unique-user sketches share this many
+    // bytes; 0 turns them off.
+    static constexpr std::size_t kDefaultDimensionMemoryBudget = 32 * 1024 * 1024;
+    // Longest window the per-dimension queries accept.
+    static constexpr std::int64_t kDimensionWindowSeconds = 3600;
+    // MetricsMode::Sampled stamps one push in this many per producer thread.
+    static constexpr std::uint32_t kMetricsSampleInterval = 64;
+
+    bool push_event(std::string_view event_type,
+                    std::string_view user_id,
+                    std::string_view channel_id,
                     std::int64_t timestamp);
 
+    // Interns the string fields; the result can be handed to push_events.
+    Event make_event(std::string_view event_type,
+                     std::string_view user_id,
+                     std::string_view channel_id,
+                     std::int64_t timestamp);
+
+    // Enqueues a whole batch with one ring reservation and one consumer
+    // wake-up per shard. Returns how many events were accepted; the rest are
+    // counted as dropped. A full ring is handled by the overflow policy, and
+    // by the spill journal when one is enabled.
+    std::size_t push_events(std::vector<Event> events);
+
     std::uint64_t get_unique_users_last_hour();
+    // Counts are Space-Saving upper bounds, exact until more distinct channels
+    // than top_channel_capacity have been seen on a shard.
     std::vector<std::pair<std::string, std::uint64_t>> get_top_channels(std::size_t k);
+    // Largest possible overestimate in get_top_channels counts.
+    std::uint64_t top_channels_error_bound();
+    // Count-Min estimate for any channel, including ones outside the top set.
+    std::uint64_t estimate_channel_count(std::string_view channel_id);
 
-    void set_flush_callback(std::function<void(std::vector<Event>)> callback);
+    // Unique users seen in one channel / with one event type over the last
+    // window_seconds (at most kDimensionWindowSeconds), at five-minute
+    // bucket granularity: every bucket the window touches counts whole, so
+    // a one-minute window reads the current bucket. Keys evicted by the memory budget count from
+    // their next event onwards.
+    std::uint64_t get_unique_users(std::string_view channel_id,
+                                   std::int64_t window_seconds = kDimensionWindowSeconds);
+    std::uint64_t get_unique_users_by_event_type(std::string_view event_type,
+                                                 std::int64_t window_seconds = kDimensionWindowSeconds);
+    // Bytes held by the per-dimension sketches, and keys evicted to stay
+    // within dimension_memory_budget.
+    std::size_t dimension_memory_bytes();
+    std::uint64_t dimension_evictions();
+
+    using FlushStage = std::function<void(const EventBatch&)>;
+
+    void set_flush_callback(std::function<void(EventBatch)> callback);
+    // Runs `stage` on every flushed batch, on the pool worker and before the
+    // flush callback. With a stage installed batches are flushed even when
+    // no callback is set. A throwing stage fails the delivery like a
+    // throwing callback; journal replays of failed deliveries only go to the
+    // callback.
+    void add_flush_stage(FlushStage stage);
+    void clear_flush_stages();
+    // Also replays spilled records while the callback accepts them.
     void flush_now();
 
+    // Spills what would otherwise be lost to a SpillJournal under
+    // `directory`: events the overflow policy would drop (they count as
+    // accepted), batches flushed while no callback is set, and batches whose
+    // callback threw. Spilled events are replayed in order on a pool worker
+    // after the next successful delivery and on flush_now(); overflow events
+    // re-enter the rings and delivery batches go straight to the callback.
+    // Records left by an earlier process are recovered and replayed too.
+    // Throws std::runtime_error on I/O errors or if a journal is already
+    // enabled.
+    void enable_spill_journal(const std::string& directory,
+                              std::size_t segment_bytes = SpillJournal::kDefaultSegmentBytes,
+                              std::size_t sync_interval_ms = 100);
+    bool spill_journal_enabled() const { return load_journal() != nullptr; }
+    // Journal records not yet replayed.
+    std::size_t spilled_pending() const;
+
+    // Versioned binary snapshot of the channel Count-Min table and the
+    // unique-user bucket ring, summed/unioned across shards. Top-channel
+    // counters are not included. Safe to call while ingest runs.
+    std::string serialize_sketches();
+    // Folds a serialize_sketches() snapshot, from this or another process,
+    // into the live sketches: channel counts add up and user buckets are
+    // unioned. Throws std::runtime_error if the snapshot is truncated,
+    // corrupt, or from an unknown format version, and std::invalid_argument
+    // if its sketch geometry differs; nothing is merged in either case.
+    void merge_from(std::string_view snapshot);
+    // serialize_sketches() to a temporary file renamed over `path`.
+    void save_sketches(const std::string& path);
+    // Memory-maps `path` and merges it, as merge_from().
+    void load_sketches(const std::string& path);
+
     std::uint64_t total_events_processed() const noexcept { return total_processed_.load(std::memory_order_relaxed); }
     std::uint64_t events_dropped() const noexcept { return events_dropped_.load(std::memory_order_relaxed); }
+    // Queued events discarded under OverflowPolicy::OverwriteOldest.
+    std::uint64_t events_overwritten() const noexcept { return events_overwritten_.load(std::memory_order_relaxed); }
+    OverflowPolicy overflow_policy() const noexcept { return overflow_policy_; }
+    std::size_t shard_count() const noexcept { return shards_.size(); }
+    // Flush callbacks that threw on a pool worker; the batch is retried only
+    // when a spill journal is enabled.
+    std::uint64_t flush_callback_failures() const noexcept { return thread_pool_.failed_tasks(); }
+    std::uint64_t events_spilled() const noexcept { return events_spilled_.load(std::memory_order_relaxed); }
+    std::uint64_t events_replayed() const noexcept { return events_replayed_.load(std::memory_order_relaxed); }
+
+    // Counters, gauges and latency summaries for the whole pipeline. Reading
+    // them never blocks ingest for longer than a pending-batch size check.
+    PipelineMetrics get_metrics() const;
+    void set_metrics_mode(MetricsMode mode) noexcept { metrics_mode_.store(mode, std::memory_order_relaxed); }
+    MetricsMode metrics_mode() const noexcept { return metrics_mode_.load(std::memory_order_relaxed); }
+    // Clears the latency histograms; counters keep running.
+    void reset_latency_metrics() noexcept;
 
 private:
-    using Buffer = LockFreeRingBuffer<Event, 0>;
+    // every shard has exactly one consumer thread
+    using Buffer = LockFreeRingBuffer<Event, 0, ring_policy::MPSC>;
+    using ChannelSketch = CountMinSketch<2048, 4>;
+
+    // Immutable view of one shard's statistics. Queries only ever read a
+    // published snapshot, so every answer from a shard is consistent with a
+    // single point in its stream (its epoch) and readers never contend with
+    // the consumer.
+    struct StatsSnapshot {
+        std::uint64_t epoch = 0;
+        std::int64_t taken_at = 0;
+        HyperLogLog users;
+        std::uint64_t unique_users = 0;
+        std::vector<HeavyHitter> top_channels;
+        std::uint64_t channel_error_bound = 0;
+    };
+
+    // One consumer pipeline. Events are routed to a shard by channel_id, so
+    // channel statistics are disjoint across shards and only the user
+    // sketches need a real merge at query time.
+    struct Shard {
+        Shard(std::size_t capacity,
+              std::int64_t window_seconds,
+              std::int64_t bucket_seconds,
+              std::size_t heavy_hitter_capacity,
+              std::size_t dimension_budget)
+            : buffer(capacity),
+              unique_users(window_seconds, bucket_seconds),
+              top_channels(heavy_hitter_capacity),
+              users_by_channel(dimension_budget, window_seconds),
+              users_by_event_type(dimension_budget, window_seconds) {}
+
+        Buffer buffer;
+        std::thread consumer_thread;
+
+        // atomic counters, readable from any thread
+        ChannelSketch channel_frequency;
 
-    struct HyperLogLogWindow {
-        std::int64_t window_start;
-        HyperLogLog sketch;
+        // Owned by the consumer thread; stats queries see them through
+        // `snapshot`. The consumer holds stats_mutex while it updates them,
+        // once per drained chunk, so sketch serialization, merges and the
+        // per-dimension queries can reach them from other threads. This
+        // partly undoes the lock-free consumer of the snapshot design:
+        // those callers stall the shard's ingest for as long as they hold
+        // the lock, so they keep only bucket copies and merges under it.
+        std::mutex stats_mutex;
+        SlidingHyperLogLog unique_users;
+        SpaceSaving top_channels;
+        // Too large to snapshot, so per-dimension queries read these under
+        // stats_mutex instead.
+        KeyedSlidingHyperLogLog users_by_channel;
+        KeyedSlidingHyperLogLog users_by_event_type;
+        bool stats_dirty = false;
+        std::uint64_t snapshot_epoch = 0;
+        std::int64_t snapshot_bucket = 0;
+        std::chrono::steady_clock::time_point last_publish;
+
+        // accessed only through std::atomic_load / std::atomic_store
+        std::shared_ptr<const StatsSnapshot> snapshot;
+
+        std::mutex batch_mutex;
+        std::vector<Event> pending_batch;
+
+        // producers only signal these when the other side is parked
+        EventCount data_ready;
+        EventCount space_ready;
+        // queued events the consumer still has to discard (OverwriteOldest)
+        std::atomic<std::size_t> overwrite_debt{0};
+        std::atomic<bool> flush_requested{false};
+        // time the consumer spent parked, for busy_ratio
+        std::atomic<std::uint64_t> parked_ns{0};
+
+        std::chrono::steady_clock::time_point last_flush_time;
     };
 
-    void consume_loop();
-    void process_event(const Event& event);
-    void flush_batch(std::vector<Event>& batch);
+    std::size_t shard_index(InternId channel_id) const;
+    void stamp_enqueue(Event* first, std::size_t count) const;
+    void record_enqueue_latency(const std::vector<Event>& batch);
+    std::size_t push_to_shard(Shard& shard, std::vector<Event>& events);
+    std::size_t push_overflow(Shard& shard, Event* first, std::size_t count);
+    std::size_t wait_for_space(Shard& shard, Event* first, std::size_t count, bool overwrite = false);
+    static std::size_t take_overwrite_debt(Shard& shard, std::size_t available);
+    void signal_data(Shard& shard);
+    bool spin_for_data(Shard& shard) const;
+    void park_consumer(Shard& shard);
+    void consume_loop(Shard& shard);
+    void process_event(Shard& shard, const Event& event);
+    void publish_snapshot(Shard& shard);
+    void maybe_publish_snapshot(Shard& shard, bool idle);
+    std::shared_ptr<const StatsSnapshot> load_snapshot(const Shard& shard) const;
+    void flush_batch(Shard& shard, std::vector<Event>& batch);
+    void finish_flush_task();
+    void rebuild_delivery_locked();
+    std::shared_ptr<SpillJournal> load_journal() const;
+    bool spill(std::uint8_t tag, const Event* first, std::size_t count) noexcept;
+    void schedule_replay();
+    void replay_spilled();
+    bool replay_ingest(std::vector<Event>& events);
+    void complete_flush_request(Shard& shard);
+    bool flush_pending() const;
     void notify_idle_state();
 
     std::size_t batch_size_;
     std::chrono::milliseconds flush_interval_;
+    OverflowPolicy overflow_policy_;
+    std::chrono::milliseconds block_timeout_;
+    bool track_dimensions_;
 
-    Buffer buffer_;
+    std::shared_ptr<StringInterner> strings_;
+    std::vector<std::unique_ptr<Shard>> shards_;
     ThreadPool thread_pool_;
 
-    std::function<void(std::vector<Event>)> flush_callback_;
+    // Channel counts folded in by merge_from. Imported cells cannot be
+    // routed to a shard, so estimates add this table to the owning shard's.
+    ChannelSketch imported_channels_;
+
+    // Shared so a queued flush task holds one reference instead of a copy.
+    // flush_callback_ runs the stages and then user_callback_.
+    std::shared_ptr<const std::function<void(EventBatch)>> flush_callback_;
+    std::shared_ptr<const std::function<void(EventBatch)>> user_callback_;
+    std::vector<FlushStage> flush_stages_;
     mutable std::mutex callback_mutex_;
 
+    // accessed only through std::atomic_load / std::atomic_store
+    std::shared_ptr<SpillJournal> journal_;
+    std::atomic<bool> replay_scheduled_{false};
+
     std::atomic<bool> running_;
-    std::thread consumer_thread_;
 
     std::atomic<std::uint64_t> total_processed_{0};
     std::atomic<std::uint64_t> events_dropped_{0};
+    std::atomic<std::uint64_t> events_overwritten_{0};
+    std::atomic<std::uint64_t> batches_flushed_{0};
+    std::atomic<std::uint64_t> events_spilled_{0};
+    std::atomic<std::uint64_t> events_replayed_{0};
 
-    CountMinSketch channel_frequency_;
-
-    std::mutex stats_mutex_;
-    std::deque<HyperLogLogWindow> windows_;
-    std::unordered_map<std::string, std::uint64_t> channel_counts_;
-
-    std::mutex batch_mutex_;
-    std::vector<Event> pending_batch_;
+    std::atomic<MetricsMode> metrics_mode_{MetricsMode::Sampled};
+    std::chrono::steady_clock::time_point started_at_ = std::chrono::steady_clock::now();
+    LatencyHistogram enqueue_to_flush_;
+    LatencyHistogram flush_queue_wait_;
+    LatencyHistogram callback_duration_;
 
-    std::mutex data_mutex_;
-    std::condition_variable data_cv_;
-
-    std::mutex flush_mutex_;
+    mutable std::mutex flush_mutex_;
     std::condition_variable flush_cv_;
-    std::atomic<bool> flush_requested_{false};
-
-    std::chrono::steady_clock::time_point last_flush_time_;
 
     std::atomic<std::size_t> pending_flush_tasks_{0};
     std::mutex pending_mutex_;
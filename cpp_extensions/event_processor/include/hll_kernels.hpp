@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engagehub {
+namespace hll_kernels {
+
+// Largest register value a 64-bit hash can produce (precision 4 leaves 60
+// bits, so rank <= 61); the inverse-power table covers every value up to it.
+constexpr std::size_t kMaxRank = 64;
+
+// 2^-rank for rank in [0, kMaxRank].
+const double* inverse_powers() noexcept;
+
+struct RegisterSum {
+    double inverse_sum = 0.0; // sum of 2^-register
+    std::size_t zeros = 0;    // registers still at zero
+};
+
+// dst[i] = max(dst[i], src[i]) over `count` registers.
+void max_registers(std::uint8_t* dst, const std::uint8_t* src, std::size_t count) noexcept;
+
+// Harmonic-mean inputs for the HyperLogLog estimate.
+RegisterSum sum_registers(const std::uint8_t* registers, std::size_t count) noexcept;
+
+// Portable versions the vectorised kernels must agree with.
+void max_registers_scalar(std::uint8_t* dst, const std::uint8_t* src, std::size_t count) noexcept;
+RegisterSum sum_registers_scalar(const std::uint8_t* registers, std::size_t count) noexcept;
+
+} // namespace hll_kernels
+} // namespace engagehub
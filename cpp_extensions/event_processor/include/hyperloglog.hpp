@@ -2,27 +2,66 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace engagehub {
 
+class ByteReader;
+class ByteWriter;
+
+// HyperLogLog cardinality sketch.
+//
+// A sketch starts sparse, as a sorted list of (index, rank) pairs for the
+// registers that are set, and is promoted to the dense byte array once the
+// list holds more than register_count / 16 four-byte entries, i.e. would
+// use more than a quarter of the dense size. Both forms hold the same
+// registers, so estimates and merges do not depend on which one a sketch
+// is in.
 class HyperLogLog {
 public:
     explicit HyperLogLog(std::uint8_t precision = 14);
 
-    void add(const std::string& value);
+    // Returns true when a register was raised, i.e. the estimate may have changed.
+    bool add(std::string_view value);
+    bool add_hash(std::uint64_t hash);
     void merge(const HyperLogLog& other);
+    void clear();
+
+    // The shared 64-bit key hash (hashing::hash64); feed it to add_hash.
+    static std::uint64_t hash(std::string_view value);
 
     std::uint64_t cardinality() const;
     std::uint8_t precision() const noexcept { return precision_; }
 
+    bool is_sparse() const noexcept { return registers_.empty(); }
+    // Heap bytes held by the register storage.
+    std::size_t memory_bytes() const noexcept;
+
+    // Compact binary form: precision, then either the delta-encoded sparse
+    // entries or the raw dense registers, whichever the sketch is in.
+    void serialize(ByteWriter& out) const;
+    // Throws std::runtime_error on truncated or malformed input.
+    static HyperLogLog deserialize(ByteReader& in);
+
 private:
+    // sparse entry layout: register index in the high bits, rank in the low 8
+    static constexpr unsigned kRankBits = 8;
+    static constexpr std::uint8_t kSparseForm = 0;
+    static constexpr std::uint8_t kDenseForm = 1;
+
     static double alpha(std::size_t m);
     static std::uint8_t rho(std::uint64_t x, std::uint8_t max_bits);
 
+    bool set_sparse(std::size_t index, std::uint8_t rank);
+    void merge_sparse(const std::vector<std::uint32_t>& other);
+    void promote();
+
     std::uint8_t precision_;
     std::size_t register_count_;
+    std::size_t sparse_limit_;
+    // exactly one of these is in use; registers_ is empty while sparse
+    std::vector<std::uint32_t> sparse_;
     std::vector<std::uint8_t> registers_;
 };
 
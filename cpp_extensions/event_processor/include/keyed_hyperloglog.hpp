@@ -0,0 +1,74 @@
+#pragma once
+
+#include "hyperloglog.hpp"
+#include "sliding_hyperloglog.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace engagehub {
+
+// Sliding-window unique counts for many keys (channels, event types) under
+// one memory budget.
+//
+// Each key gets its own SlidingHyperLogLog the first time it is seen, built
+// without the cached union since keys are only read through merge_window().
+// Its buckets start sparse, so a quiet key costs its ring of empty sketches,
+// about 1.2 KB at the default hour of five-minute buckets, rather than a
+// dense register array per bucket. Keys are kept in least-recently-updated
+// order; when the tracked total exceeds the budget the stalest keys are
+// evicted, and a later event for an evicted key starts it from scratch.
+// Not thread-safe.
+class KeyedSlidingHyperLogLog {
+public:
+    explicit KeyedSlidingHyperLogLog(std::size_t memory_budget_bytes,
+                                     std::int64_t window_seconds = 3600,
+                                     std::int64_t bucket_seconds = 300,
+                                     std::uint8_t precision = 12);
+
+    void add_hash(std::uint32_t key, std::uint64_t hash, std::int64_t timestamp);
+
+    // Folds the key's buckets overlapping [now - window_seconds, now] into
+    // `out`, which must share this family's precision. Returns false if the
+    // key is not tracked.
+    bool merge_window(std::uint32_t key, std::int64_t now, std::int64_t window_seconds,
+                      HyperLogLog& out) const;
+    std::uint64_t cardinality(std::uint32_t key, std::int64_t now, std::int64_t window_seconds) const;
+
+    bool contains(std::uint32_t key) const { return entries_.count(key) != 0; }
+    std::size_t key_count() const noexcept { return entries_.size(); }
+    // Tracked bytes across every key, including per-key bookkeeping.
+    std::size_t memory_bytes() const noexcept { return memory_bytes_; }
+    std::size_t memory_budget() const noexcept { return memory_budget_; }
+    std::uint64_t evictions() const noexcept { return evictions_; }
+    std::int64_t window_seconds() const noexcept { return window_seconds_; }
+    std::uint8_t precision() const noexcept { return precision_; }
+
+private:
+    using Recency = std::list<std::uint32_t>;
+
+    struct Entry {
+        SlidingHyperLogLog sketch;
+        Recency::iterator recency;
+        std::size_t bytes;
+    };
+
+    static std::size_t footprint(const SlidingHyperLogLog& sketch) noexcept;
+    Entry& touch(std::uint32_t key);
+    void evict_to_budget();
+
+    std::size_t memory_budget_;
+    std::int64_t window_seconds_;
+    std::int64_t bucket_seconds_;
+    std::uint8_t precision_;
+
+    std::unordered_map<std::uint32_t, Entry> entries_;
+    // most recently updated key first
+    Recency recency_;
+    std::size_t memory_bytes_ = 0;
+    std::uint64_t evictions_ = 0;
+};
+
+} // namespace engagehub
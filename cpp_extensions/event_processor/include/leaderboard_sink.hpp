@@ -0,0 +1,44 @@
+#pragma once
+
+#include "event_processor.hpp"
+#include "leaderboard.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace engagehub {
+
+// Native scoring stage: maps each event's type to points through a rule
+// table and applies the batch to every board, taking each board's lock once
+// per batch. Install with EventStreamProcessor::add_flush_stage(stage()).
+class LeaderboardSink {
+public:
+    // Event types missing from `points_by_event_type` score
+    // `default_points`; events worth zero points are skipped.
+    LeaderboardSink(std::vector<std::shared_ptr<leaderboard::Leaderboard>> boards,
+                    std::unordered_map<std::string, double> points_by_event_type,
+                    double default_points = 0.0);
+
+    void apply(const EventBatch& batch);
+    // Flush stage bound to a shared sink.
+    static EventStreamProcessor::FlushStage stage(std::shared_ptr<LeaderboardSink> sink);
+
+    std::uint64_t events_scored() const noexcept { return events_scored_.load(std::memory_order_relaxed); }
+    std::uint64_t batches_applied() const noexcept { return batches_applied_.load(std::memory_order_relaxed); }
+
+private:
+    double points_for(const std::string& event_type) const;
+
+    std::vector<std::shared_ptr<leaderboard::Leaderboard>> boards_;
+    std::unordered_map<std::string, double> points_by_event_type_;
+    double default_points_;
+
+    std::atomic<std::uint64_t> events_scored_{0};
+    std::atomic<std::uint64_t> batches_applied_{0};
+};
+
+} // namespace engagehub
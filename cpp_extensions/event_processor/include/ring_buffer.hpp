@@ -2,15 +2,35 @@
 
 #include <atomic>
 #include <cstddef>
+#include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <new>
+#include <thread>
 #include <type_traits>
-#include <vector>
 
 namespace engagehub {
 
 constexpr std::size_t cache_line_size = 64;
 
+// Concurrency contracts for LockFreeRingBuffer. A single-threaded side skips
+// the CAS on its index; SPSC also drops the per-cell sequence numbers and
+// keeps a cached copy of the other side's index.
+namespace ring_policy {
+struct MPMC {
+    static constexpr bool multi_producer = true;
+    static constexpr bool multi_consumer = true;
+};
+struct MPSC {
+    static constexpr bool multi_producer = true;
+    static constexpr bool multi_consumer = false;
+};
+struct SPSC {
+    static constexpr bool multi_producer = false;
+    static constexpr bool multi_consumer = false;
+};
+} // namespace ring_policy
+
 namespace detail {
 
 inline std::size_t round_up_to_power_of_two(std::size_t value) {
@@ -24,129 +44,155 @@ inline std::size_t round_up_to_power_of_two(std::size_t value) {
     return value + 1;
 }
 
-} // namespace detail
+// Claims up to `wanted` consecutive enqueue positions with one CAS. Only
+// positions whose previous occupant has already been claimed by a consumer
+// are handed out, so every claimed cell is released without waiting on
+// another producer. Returns the first claimed position.
+inline std::size_t claim_slots(std::atomic<std::size_t>& enqueue_pos,
+                               const std::atomic<std::size_t>& dequeue_pos,
+                               std::size_t capacity,
+                               std::size_t wanted,
+                               std::size_t& claimed) {
+    claimed = 0;
+    std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    while (wanted != 0) {
+        const std::size_t head = dequeue_pos.load(std::memory_order_acquire);
+        const auto in_flight = static_cast<intptr_t>(pos - head);
+        if (in_flight < 0) {
+            // stale enqueue position, consumers have moved past it
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (static_cast<std::size_t>(in_flight) >= capacity) {
+            return pos;
+        }
+        const std::size_t take = std::min(wanted, capacity - static_cast<std::size_t>(in_flight));
+        if (enqueue_pos.compare_exchange_weak(pos, pos + take, std::memory_order_relaxed)) {
+            claimed = take;
+            return pos;
+        }
+    }
+    return pos;
+}
 
-template <typename T, std::size_t Size>
-class LockFreeRingBuffer {
-    static_assert(Size > 0, "Ring buffer size must be greater than zero");
-    static_assert((Size & (Size - 1)) == 0, "Ring buffer size must be a power of two");
+// Waits for a consumer that has already claimed the previous lap of a cell
+// to finish moving its value out.
+inline void wait_for_sequence(const std::atomic<std::size_t>& sequence, std::size_t expected) {
+    while (sequence.load(std::memory_order_acquire) != expected) {
+        std::this_thread::yield();
+    }
+}
 
+// Cell array with a compile-time capacity, stored inline.
+template <typename Cell, std::size_t Size>
+class CellArray {
 public:
-    LockFreeRingBuffer();
-    ~LockFreeRingBuffer();
-
-    bool push(const T& value);
-    bool push(T&& value);
+    CellArray() = default;
 
-    bool pop(T& result);
-
-    std::size_t capacity() const noexcept { return Size; }
-    bool empty() const noexcept;
+    static constexpr std::size_t capacity() noexcept { return Size; }
+    Cell& operator[](std::size_t pos) noexcept { return cells_[pos & (Size - 1)]; }
 
 private:
-    template <typename U>
-    bool emplace(U&& value);
+    Cell cells_[Size];
+};
 
-    struct alignas(cache_line_size) Cell {
-        std::atomic<std::size_t> sequence;
-        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
-    };
+// Runtime-sized cell array, rounded up to a power of two.
+template <typename Cell>
+class CellArray<Cell, 0> {
+public:
+    explicit CellArray(std::size_t size)
+        : size_(round_up_to_power_of_two(size == 0 ? 1 : size)),
+          mask_(size_ - 1),
+          cells_(new Cell[size_]) {}
+
+    std::size_t capacity() const noexcept { return size_; }
+    Cell& operator[](std::size_t pos) noexcept { return cells_[pos & mask_]; }
 
-    Cell buffer_[Size];
-    alignas(cache_line_size) std::atomic<std::size_t> enqueue_pos_;
-    alignas(cache_line_size) std::atomic<std::size_t> dequeue_pos_;
+private:
+    std::size_t size_;
+    std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
 };
 
-// Runtime-sized specialisation using Size == 0
+} // namespace detail
+
+// Bounded lock-free queue. Size == 0 selects a capacity given at runtime;
+// Policy picks how many threads may push and pop concurrently (see
+// ring_policy). The defaults keep the original Vyukov MPMC behaviour.
+template <typename T, std::size_t Size = 0, typename Policy = ring_policy::MPMC>
+class LockFreeRingBuffer {
+    static_assert((Size & (Size - 1)) == 0, "Ring buffer size must be a power of two");
+    static_assert(Policy::multi_producer || !Policy::multi_consumer,
+                  "single-producer multi-consumer rings are not supported");
 
-template <typename T>
-class LockFreeRingBuffer<T, 0> {
 public:
-    explicit LockFreeRingBuffer(std::size_t size)
-        : size_(detail::round_up_to_power_of_two(size == 0 ? 1 : size)),
-          mask_(size_ - 1),
-          buffer_(size_),
-          enqueue_pos_(0),
-          dequeue_pos_(0) {
-        for (std::size_t i = 0; i < size_; ++i) {
-            buffer_[i].sequence.store(i, std::memory_order_relaxed);
-        }
+    template <std::size_t S = Size, std::enable_if_t<S != 0, int> = 0>
+    LockFreeRingBuffer() {
+        init_sequences();
     }
 
-    ~LockFreeRingBuffer() {
-        T value;
-        while (pop(value)) {
-            // drain remaining items to invoke destructors
-        }
+    template <std::size_t S = Size, std::enable_if_t<S == 0, int> = 0>
+    explicit LockFreeRingBuffer(std::size_t size)
+        : cells_(size) {
+        init_sequences();
     }
 
-    bool push(const T& value) { return emplace(value); }
-    bool push(T&& value) { return emplace(std::move(value)); }
-
-    bool pop(T& result) {
-        Cell* cell;
-        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
-        for (;;) {
-            cell = &buffer_[pos & mask_];
-            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
-            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
-            if (diff == 0) {
-                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
-                    break;
-                }
-            } else if (diff < 0) {
-                return false;
-            } else {
-                pos = dequeue_pos_.load(std::memory_order_relaxed);
-            }
-        }
-        result = std::move(*reinterpret_cast<T*>(&cell->storage));
-        reinterpret_cast<T*>(&cell->storage)->~T();
-        cell->sequence.store(pos + size_, std::memory_order_release);
-        return true;
-    }
+    ~LockFreeRingBuffer();
 
-    std::size_t capacity() const noexcept { return size_; }
+    LockFreeRingBuffer(const LockFreeRingBuffer&) = delete;
+    LockFreeRingBuffer& operator=(const LockFreeRingBuffer&) = delete;
 
-    bool empty() const noexcept {
-        return enqueue_pos_.load(std::memory_order_acquire) ==
-               dequeue_pos_.load(std::memory_order_acquire);
-    }
+    bool push(const T& value);
+    bool push(T&& value);
+
+    // Reserves up to `count` consecutive slots at once and moves elements
+    // from `first` into them. Returns how many were accepted; the remainder
+    // did not fit and is left untouched.
+    template <typename InputIt>
+    std::size_t try_push_bulk(InputIt first, std::size_t count);
+
+    bool pop(T& result);
+
+    // Moves up to `max` queued elements to `out`, oldest first, and returns
+    // how many were taken. A single consumer does this without a CAS.
+    template <typename OutputIt>
+    std::size_t try_pop_bulk(OutputIt out, std::size_t max);
+
+    std::size_t capacity() const noexcept { return cells_.capacity(); }
+    bool empty() const noexcept;
+    // Queued elements, including claimed slots still being written or read;
+    // exact only when both sides are quiet. Meant for gauges.
+    std::size_t size_approx() const noexcept;
 
 private:
-    template <typename U>
-    bool emplace(U&& value) {
-        Cell* cell;
-        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
-        for (;;) {
-            cell = &buffer_[pos & mask_];
-            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
-            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
-            if (diff == 0) {
-                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
-                    break;
-                }
-            } else if (diff < 0) {
-                return false;
-            } else {
-                pos = enqueue_pos_.load(std::memory_order_relaxed);
-            }
-        }
-        new (&cell->storage) T(std::forward<U>(value));
-        cell->sequence.store(pos + 1, std::memory_order_release);
-        return true;
-    }
+    static constexpr bool sequenced = Policy::multi_producer || Policy::multi_consumer;
 
-    struct alignas(cache_line_size) Cell {
+    struct SequencedCell {
         std::atomic<std::size_t> sequence;
         typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
     };
+    struct PlainCell {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+    // Cells are packed rather than padded to a cache line so small payloads
+    // share lines; only the contended indices below are padded.
+    using Cell = std::conditional_t<sequenced, SequencedCell, PlainCell>;
+
+    // Each side's index, plus its cached view of the other side's index when
+    // that side is single-threaded (SPSC only).
+    struct alignas(cache_line_size) Index {
+        std::atomic<std::size_t> pos{0};
+        std::size_t cached_peer = 0;
+    };
 
-    std::size_t size_;
-    std::size_t mask_;
-    std::vector<Cell> buffer_;
-    alignas(cache_line_size) std::atomic<std::size_t> enqueue_pos_;
-    alignas(cache_line_size) std::atomic<std::size_t> dequeue_pos_;
+    template <typename U>
+    bool emplace(U&& value);
+    void init_sequences();
+    static T* value_of(Cell& cell) noexcept { return std::launder(reinterpret_cast<T*>(&cell.storage)); }
+
+    detail::CellArray<Cell, Size> cells_;
+    Index producer_;
+    Index consumer_;
 };
 
 } // namespace engagehub
@@ -4,84 +4,215 @@
 
 namespace engagehub {
 
-template <typename T, std::size_t Size>
-LockFreeRingBuffer<T, Size>::LockFreeRingBuffer()
-    : enqueue_pos_(0), dequeue_pos_(0) {
-    for (std::size_t i = 0; i < Size; ++i) {
-        buffer_[i].sequence.store(i, std::memory_order_relaxed);
-    }
-}
-
-template <typename T, std::size_t Size>
-LockFreeRingBuffer<T, Size>::~LockFreeRingBuffer() {
+template <typename T, std::size_t Size, typename Policy>
+LockFreeRingBuffer<T, Size, Policy>::~LockFreeRingBuffer() {
     T value;
     while (pop(value)) {
         // drain remaining items to destroy them
     }
 }
 
-template <typename T, std::size_t Size>
-bool LockFreeRingBuffer<T, Size>::push(const T& value) {
+template <typename T, std::size_t Size, typename Policy>
+void LockFreeRingBuffer<T, Size, Policy>::init_sequences() {
+    if constexpr (sequenced) {
+        for (std::size_t i = 0; i < capacity(); ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T, std::size_t Size, typename Policy>
+bool LockFreeRingBuffer<T, Size, Policy>::push(const T& value) {
     return emplace(value);
 }
 
-template <typename T, std::size_t Size>
-bool LockFreeRingBuffer<T, Size>::push(T&& value) {
+template <typename T, std::size_t Size, typename Policy>
+bool LockFreeRingBuffer<T, Size, Policy>::push(T&& value) {
     return emplace(std::move(value));
 }
 
-template <typename T, std::size_t Size>
+template <typename T, std::size_t Size, typename Policy>
 template <typename U>
-bool LockFreeRingBuffer<T, Size>::emplace(U&& value) {
-    Cell* cell;
-    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
-    for (;;) {
-        cell = &buffer_[pos & (Size - 1)];
-        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
-        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
-        if (diff == 0) {
-            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
-                break;
+bool LockFreeRingBuffer<T, Size, Policy>::emplace(U&& value) {
+    if constexpr (Policy::multi_producer) {
+        Cell* cell;
+        std::size_t pos = producer_.pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (producer_.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = producer_.pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::forward<U>(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    } else {
+        const std::size_t tail = producer_.pos.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_peer >= capacity()) {
+            producer_.cached_peer = consumer_.pos.load(std::memory_order_acquire);
+            if (tail - producer_.cached_peer >= capacity()) {
+                return false;
+            }
+        }
+        new (&cells_[tail].storage) T(std::forward<U>(value));
+        producer_.pos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+}
+
+template <typename T, std::size_t Size, typename Policy>
+template <typename InputIt>
+std::size_t LockFreeRingBuffer<T, Size, Policy>::try_push_bulk(InputIt first, std::size_t count) {
+    if constexpr (Policy::multi_producer) {
+        std::size_t claimed = 0;
+        const std::size_t pos = detail::claim_slots(producer_.pos, consumer_.pos, capacity(), count, claimed);
+        for (std::size_t i = 0; i < claimed; ++i, ++first) {
+            Cell& cell = cells_[pos + i];
+            detail::wait_for_sequence(cell.sequence, pos + i);
+            new (&cell.storage) T(std::move(*first));
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return claimed;
+    } else {
+        const std::size_t tail = producer_.pos.load(std::memory_order_relaxed);
+        std::size_t free_slots = capacity() - (tail - producer_.cached_peer);
+        if (free_slots < count) {
+            producer_.cached_peer = consumer_.pos.load(std::memory_order_acquire);
+            free_slots = capacity() - (tail - producer_.cached_peer);
+        }
+        const std::size_t accepted = std::min(count, free_slots);
+        for (std::size_t i = 0; i < accepted; ++i, ++first) {
+            new (&cells_[tail + i].storage) T(std::move(*first));
+        }
+        if (accepted != 0) {
+            producer_.pos.store(tail + accepted, std::memory_order_release);
+        }
+        return accepted;
+    }
+}
+
+template <typename T, std::size_t Size, typename Policy>
+bool LockFreeRingBuffer<T, Size, Policy>::pop(T& result) {
+    if constexpr (Policy::multi_consumer) {
+        Cell* cell;
+        std::size_t pos = consumer_.pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (consumer_.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = consumer_.pos.load(std::memory_order_relaxed);
             }
-        } else if (diff < 0) {
-            return false;
-        } else {
-            pos = enqueue_pos_.load(std::memory_order_relaxed);
         }
+        result = std::move(*value_of(*cell));
+        value_of(*cell)->~T();
+        cell->sequence.store(pos + capacity(), std::memory_order_release);
+        return true;
+    } else {
+        return try_pop_bulk(&result, 1) == 1;
     }
-    new (&cell->storage) T(std::forward<U>(value));
-    cell->sequence.store(pos + 1, std::memory_order_release);
-    return true;
 }
 
-template <typename T, std::size_t Size>
-bool LockFreeRingBuffer<T, Size>::pop(T& result) {
-    Cell* cell;
-    std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
-    for (;;) {
-        cell = &buffer_[pos & (Size - 1)];
-        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
-        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
-        if (diff == 0) {
-            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+template <typename T, std::size_t Size, typename Policy>
+template <typename OutputIt>
+std::size_t LockFreeRingBuffer<T, Size, Policy>::try_pop_bulk(OutputIt out, std::size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+    const std::size_t cap = capacity();
+
+    if constexpr (Policy::multi_consumer) {
+        // Find the run of published cells at the head, then claim all of
+        // them with one CAS.
+        std::size_t pos = consumer_.pos.load(std::memory_order_relaxed);
+        std::size_t ready = 0;
+        for (;;) {
+            ready = 0;
+            while (ready < max &&
+                   cells_[pos + ready].sequence.load(std::memory_order_acquire) == pos + ready + 1) {
+                ++ready;
+            }
+            if (ready == 0) {
+                const std::size_t seq = cells_[pos].sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+                    return 0;
+                }
+                pos = consumer_.pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (consumer_.pos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < ready; ++i, ++out) {
+            Cell& cell = cells_[pos + i];
+            *out = std::move(*value_of(cell));
+            value_of(cell)->~T();
+            cell.sequence.store(pos + i + cap, std::memory_order_release);
+        }
+        return ready;
+    } else if constexpr (sequenced) {
+        // Producers publish out of order, so each cell's sequence is still
+        // checked, but the index is ours alone and is stored once.
+        const std::size_t pos = consumer_.pos.load(std::memory_order_relaxed);
+        std::size_t taken = 0;
+        for (; taken < max; ++taken, ++out) {
+            Cell& cell = cells_[pos + taken];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + taken + 1) {
                 break;
             }
-        } else if (diff < 0) {
-            return false;
-        } else {
-            pos = dequeue_pos_.load(std::memory_order_relaxed);
+            *out = std::move(*value_of(cell));
+            value_of(cell)->~T();
+            cell.sequence.store(pos + taken + cap, std::memory_order_release);
+        }
+        if (taken != 0) {
+            consumer_.pos.store(pos + taken, std::memory_order_release);
+        }
+        return taken;
+    } else {
+        const std::size_t head = consumer_.pos.load(std::memory_order_relaxed);
+        if (consumer_.cached_peer - head < max) {
+            consumer_.cached_peer = producer_.pos.load(std::memory_order_acquire);
         }
+        const std::size_t taken = std::min(max, consumer_.cached_peer - head);
+        for (std::size_t i = 0; i < taken; ++i, ++out) {
+            Cell& cell = cells_[head + i];
+            *out = std::move(*value_of(cell));
+            value_of(cell)->~T();
+        }
+        if (taken != 0) {
+            consumer_.pos.store(head + taken, std::memory_order_release);
+        }
+        return taken;
     }
-    result = std::move(*reinterpret_cast<T*>(&cell->storage));
-    reinterpret_cast<T*>(&cell->storage)->~T();
-    cell->sequence.store(pos + Size, std::memory_order_release);
-    return true;
 }
 
-template <typename T, std::size_t Size>
-bool LockFreeRingBuffer<T, Size>::empty() const noexcept {
-    return enqueue_pos_.load(std::memory_order_acquire) ==
-           dequeue_pos_.load(std::memory_order_acquire);
+template <typename T, std::size_t Size, typename Policy>
+bool LockFreeRingBuffer<T, Size, Policy>::empty() const noexcept {
+    return producer_.pos.load(std::memory_order_acquire) ==
+           consumer_.pos.load(std::memory_order_acquire);
+}
+
+template <typename T, std::size_t Size, typename Policy>
+std::size_t LockFreeRingBuffer<T, Size, Policy>::size_approx() const noexcept {
+    const std::size_t head = consumer_.pos.load(std::memory_order_acquire);
+    const std::size_t tail = producer_.pos.load(std::memory_order_acquire);
+    const auto queued = static_cast<intptr_t>(tail - head);
+    return queued <= 0 ? 0 : std::min(static_cast<std::size_t>(queued), capacity());
 }
 
 } // namespace engagehub
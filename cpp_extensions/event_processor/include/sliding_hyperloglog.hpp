@@ -0,0 +1,96 @@
+#pragma once
+
+#include "hyperloglog.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace engagehub {
+
+// Unique-count estimate over a sliding time window.
+//
+// Time is cut into fixed buckets kept in a circular array indexed by
+// (timestamp / bucket_seconds), so locating the bucket for an event is O(1).
+// The union of all live buckets is cached and updated in place as values are
+// added; it is only rebuilt when a bucket falls out of the window, which
+// happens at most once per bucket span. Reading the estimate is therefore a
+// cached lookup in the common case.
+//
+// Callers that only ever read through merge_window() can construct the ring
+// with cache_union = false: adds then touch just their bucket, and
+// window_union() rebuilds from the buckets on every call.
+class SlidingHyperLogLog {
+public:
+    explicit SlidingHyperLogLog(std::int64_t window_seconds = 3600,
+                                std::int64_t bucket_seconds = 60,
+                                std::uint8_t precision = 14,
+                                bool cache_union = true);
+
+    // Return true when a bucket register was raised, which is also the only
+    // way memory_bytes() can grow.
+    bool add(const std::string& value, std::int64_t timestamp);
+    bool add_hash(std::uint64_t hash, std::int64_t timestamp);
+
+    // Union of every bucket that overlaps [now - window, now]. A bucket that
+    // the window only partly covers counts whole, and buckets starting after
+    // `now` are left out.
+    const HyperLogLog& window_union(std::int64_t now);
+    // As window_union for a shorter span, folded into `out` without touching
+    // the cached union. `out` must have the same precision. A span shorter
+    // than one bucket still reads the bucket holding `now`.
+    void merge_window(std::int64_t now, std::int64_t span_seconds, HyperLogLog& out) const;
+    std::uint64_t cardinality(std::int64_t now);
+    void clear();
+
+    // Folds another ring with the same geometry into this one, bucket by
+    // bucket. Buckets with the same start are unioned; a slot keeps whichever
+    // bucket is newer. Merging the same ring twice changes nothing.
+    void merge(const SlidingHyperLogLog& other);
+
+    // Geometry followed by every live bucket's start and sketch.
+    void serialize(ByteWriter& out) const;
+    // Throws std::runtime_error on truncated or malformed input.
+    static SlidingHyperLogLog deserialize(ByteReader& in);
+
+    std::int64_t window_seconds() const noexcept { return window_seconds_; }
+    std::int64_t bucket_seconds() const noexcept { return bucket_seconds_; }
+    std::uint8_t precision() const noexcept { return union_.precision(); }
+    std::size_t bucket_count() const noexcept { return buckets_.size(); }
+    bool caches_union() const noexcept { return cache_union_; }
+    // Heap bytes held by the bucket array, every bucket sketch and the
+    // cached union.
+    std::size_t memory_bytes() const noexcept;
+
+private:
+    static constexpr std::int64_t kEmptyBucket = std::numeric_limits<std::int64_t>::min();
+
+    struct Bucket {
+        std::int64_t start;
+        HyperLogLog sketch;
+    };
+
+    std::size_t slot_for(std::int64_t bucket_start) const noexcept;
+    // The one test window_union and merge_window share for a bucket.
+    bool in_window(std::int64_t bucket_start, std::int64_t now, std::int64_t span_seconds) const noexcept;
+    void rebuild_union(std::int64_t now);
+
+    std::int64_t window_seconds_;
+    std::int64_t bucket_seconds_;
+    std::vector<Bucket> buckets_;
+
+    HyperLogLog union_;
+    bool cache_union_;
+    bool union_valid_;
+    // buckets starting at or after union_floor_ are folded into union_
+    std::int64_t union_floor_;
+    std::int64_t union_oldest_;
+    std::int64_t union_newest_;
+
+    std::uint64_t cached_cardinality_;
+    bool cardinality_dirty_;
+};
+
+} // namespace engagehub
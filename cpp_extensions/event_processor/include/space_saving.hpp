@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace engagehub {
+
+struct HeavyHitter {
+    std::uint32_t key;
+    // upper bound on the true frequency; count - error is a lower bound
+    std::uint64_t count;
+    std::uint64_t error;
+};
+
+// Space-Saving heavy-hitters summary with a fixed number of counters.
+//
+// Counters are kept in an array sorted by count (descending), so top-k is a
+// prefix read. A unit increment only ever swaps a counter with the first one
+// of equal count, which keeps offer() at O(log capacity) with no allocation
+// once the summary is full. Any key whose true frequency exceeds
+// total() / capacity() is guaranteed to be present.
+class SpaceSaving {
+public:
+    explicit SpaceSaving(std::size_t capacity = 1024);
+
+    void offer(std::uint32_t key, std::uint64_t count = 1);
+    std::vector<HeavyHitter> top_k(std::size_t k) const;
+    void clear();
+
+    std::size_t capacity() const noexcept { return capacity_; }
+    std::size_t size() const noexcept { return entries_.size(); }
+    std::uint64_t total() const noexcept { return total_; }
+    // Largest possible overestimate of any reported count.
+    std::uint64_t error_bound() const noexcept;
+
+private:
+    void promote(std::size_t index, std::uint64_t delta);
+
+    std::size_t capacity_;
+    std::uint64_t total_;
+    std::vector<HeavyHitter> entries_;
+    std::unordered_map<std::uint32_t, std::uint32_t> positions_;
+};
+
+} // namespace engagehub
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace engagehub {
+
+// Append-only record log kept in memory-mapped segment files under one
+// directory. Records are opaque tagged payloads, read back oldest first and
+// retired one by one with acknowledge(); a segment file is deleted once
+// every record in it is acknowledged. At most the read and the write
+// segment are mapped at a time, so resident memory stays around two
+// segments however much is spilled.
+//
+// Writes reach the files through the shared mappings and are msync'ed at
+// most once per sync_interval (every append when it is zero). Opening a
+// directory that already holds segments recovers their unacknowledged
+// records; a torn record at the tail of a segment ends that segment.
+// Acknowledgements are synced lazily, so after a crash a few delivered
+// records may be read again.
+//
+// All members are thread-safe.
+class SpillJournal {
+public:
+    static constexpr std::size_t kDefaultSegmentBytes = 16 * 1024 * 1024;
+
+    struct Record {
+        std::uint8_t tag = 0;
+        std::string payload;
+        // where the record lives, for acknowledge()
+        std::uint64_t segment = 0;
+        std::size_t offset = 0;
+    };
+
+    // Creates `directory` if needed and recovers any segments in it.
+    // Throws std::runtime_error on I/O errors or a segment from an unknown
+    // format version.
+    explicit SpillJournal(std::string directory,
+                          std::size_t segment_bytes = kDefaultSegmentBytes,
+                          std::chrono::milliseconds sync_interval = std::chrono::milliseconds(100));
+    ~SpillJournal();
+
+    SpillJournal(const SpillJournal&) = delete;
+    SpillJournal& operator=(const SpillJournal&) = delete;
+
+    // A payload larger than a segment gets a segment of its own. Throws
+    // std::runtime_error if the segment cannot be created or mapped.
+    void append(std::uint8_t tag, std::string_view payload);
+    // Oldest unacknowledged record; it stays pending until acknowledged.
+    std::optional<Record> peek();
+    void acknowledge(const Record& record);
+    // Forces appended records and acknowledgements to disk.
+    void sync();
+
+    std::size_t pending_records() const;
+    // Unacknowledged records found when the journal was opened.
+    std::size_t recovered_records() const noexcept { return recovered_records_; }
+    std::size_t segment_count() const;
+    const std::string& directory() const noexcept { return directory_; }
+
+private:
+    class Mapping;
+
+    struct Segment {
+        Segment(std::uint64_t sequence, std::string path);
+        Segment(Segment&&) noexcept;
+        ~Segment();
+
+        std::uint64_t sequence;
+        std::string path;
+        // end of the last valid record; appends go here
+        std::size_t end = 0;
+        std::size_t capacity = 0;
+        std::size_t pending = 0;
+        std::unique_ptr<Mapping> mapping;
+    };
+
+    void recover();
+    Segment& writable_segment(std::size_t record_bytes);
+    Mapping& map(Segment& segment);
+    bool is_writer(const Segment& segment) const;
+    void retire_front();
+    void sync_locked();
+
+    std::string directory_;
+    std::size_t segment_bytes_;
+    std::chrono::milliseconds sync_interval_;
+
+    mutable std::mutex mutex_;
+    // oldest first; reads happen in the front segment
+    std::deque<Segment> segments_;
+    std::size_t read_offset_ = 0;
+    // segments_.back() was created by this journal and takes appends
+    bool writer_open_ = false;
+    std::uint64_t next_sequence_ = 0;
+    std::size_t pending_records_ = 0;
+    std::size_t recovered_records_ = 0;
+    // writer bytes already synced, and whether acknowledgements are not
+    std::size_t synced_end_ = 0;
+    bool acks_dirty_ = false;
+    std::chrono::steady_clock::time_point last_sync_;
+};
+
+} // namespace engagehub
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace engagehub {
+
+using InternId = std::uint32_t;
+
+// Append-only table mapping strings to dense 32-bit ids.
+//
+// Interning takes a shared lock for the lookup and an exclusive lock only
+// the first time a string is seen. Entries are stored in fixed-size chunks
+// that are never moved or freed, so resolving an id (and its cached hash)
+// is lock-free. The table is meant for small, stable vocabularies such as
+// Discord snowflakes and event types; ids are never released.
+class StringInterner {
+public:
+    StringInterner();
+    ~StringInterner();
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    InternId intern(std::string_view value);
+    // Looks a string up without adding it.
+    std::optional<InternId> find(std::string_view value) const;
+
+    const std::string& resolve(InternId id) const { return entry(id).value; }
+    // hashing::hash64 of the string, identical across processes
+    std::uint64_t hash_of(InternId id) const { return entry(id).hash; }
+
+    std::size_t size() const noexcept { return size_.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        std::string value;
+        std::uint64_t hash = 0;
+    };
+
+    static constexpr std::size_t kChunkBits = 12;
+    static constexpr std::size_t kChunkSize = std::size_t{1} << kChunkBits;
+    static constexpr std::size_t kMaxChunks = std::size_t{1} << 14;
+
+    const Entry& entry(InternId id) const {
+        const Entry* chunk = chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+        return chunk[id & (kChunkSize - 1)];
+    }
+
+    mutable std::shared_mutex mutex_;
+    // keys point into chunk storage, which never moves
+    std::unordered_map<std::string_view, InternId> ids_;
+    std::unique_ptr<std::atomic<Entry*>[]> chunks_;
+    std::atomic<std::size_t> size_;
+};
+
+} // namespace engagehub
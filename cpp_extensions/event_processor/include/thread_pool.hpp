@@ -1,33 +0,0 @@
-#pragma once
-
-#include <atomic>
-#include <condition_variable>
-#include <cstddef>
-#include <functional>
-#include <future>
-#include <mutex>
-#include <queue>
-#include <thread>
-#include <vector>
-
-namespace engagehub {
-
-class ThreadPool {
-public:
-    explicit ThreadPool(std::size_t num_threads = std::thread::hardware_concurrency());
-    ~ThreadPool();
-
-    void enqueue(std::function<void()> task);
-    void shutdown();
-
-private:
-    void worker_loop();
-
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    std::atomic<bool> stopping_;
-};
-
-} // namespace engagehub
@@ -0,0 +1,122 @@
+#include "batch_queue.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+namespace engagehub {
+
+BatchQueue::BatchQueue(std::size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {
+#if defined(__linux__)
+    read_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (read_fd_ < 0) {
+        throw std::runtime_error(std::string("Failed to create eventfd: ") + std::strerror(errno));
+    }
+    write_fd_ = read_fd_;
+#else
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        throw std::runtime_error(std::string("Failed to create pipe: ") + std::strerror(errno));
+    }
+    for (const int fd : fds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+#endif
+}
+
+BatchQueue::~BatchQueue() {
+    ::close(read_fd_);
+    if (write_fd_ != read_fd_) {
+        ::close(write_fd_);
+    }
+}
+
+bool BatchQueue::push(EventBatch& batch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || ready_.size() >= capacity_) {
+        return false;
+    }
+    ready_.push_back(std::move(batch));
+    signal();
+    return true;
+}
+
+std::optional<EventBatch> BatchQueue::try_pop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ready_.empty()) {
+        return std::nullopt;
+    }
+    EventBatch batch = std::move(ready_.front());
+    ready_.pop_front();
+    if (ready_.empty() && !closed_) {
+        clear_signal();
+    }
+    return batch;
+}
+
+void BatchQueue::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    signal();
+}
+
+bool BatchQueue::closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+std::size_t BatchQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_.size();
+}
+
+std::function<void(EventBatch)> BatchQueue::sink(std::shared_ptr<BatchQueue> queue) {
+    return [queue = std::move(queue)](EventBatch batch) {
+        if (!queue->push(batch)) {
+            throw std::runtime_error("Batch queue is full or closed");
+        }
+    };
+}
+
+// Both helpers run under mutex_, so readiness always matches the queue.
+void BatchQueue::signal() {
+    if (signalled_) {
+        return;
+    }
+#if defined(__linux__)
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const auto written = ::write(write_fd_, &one, sizeof(one));
+#else
+    const char one = 1;
+    [[maybe_unused]] const auto written = ::write(write_fd_, &one, sizeof(one));
+#endif
+    signalled_ = true;
+}
+
+void BatchQueue::clear_signal() {
+    if (!signalled_) {
+        return;
+    }
+#if defined(__linux__)
+    std::uint64_t count = 0;
+    [[maybe_unused]] const auto drained = ::read(read_fd_, &count, sizeof(count));
+#else
+    char drain[64];
+    while (::read(read_fd_, drain, sizeof(drain)) > 0) {
+    }
+#endif
+    signalled_ = false;
+}
+
+} // namespace engagehub
@@ -1,29 +1,315 @@
+#include "batch_queue.hpp"
 #include "event_processor.hpp"
+#include "leaderboard_sink.hpp"
 
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
 namespace py = pybind11;
 using namespace engagehub;
 
+namespace {
+
+std::vector<Event> events_from_tuples(EventStreamProcessor& processor, const py::sequence& events) {
+    const std::size_t count = py::len(events);
+    std::vector<Event> batch;
+    batch.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const py::object item = events[i];
+        const auto fields = item.cast<py::sequence>();
+        if (py::len(fields) != 4) {
+            throw py::value_error("push_events expects (event_type, user_id, channel_id, timestamp) tuples");
+        }
+        batch.push_back(processor.make_event(py::object(fields[0]).cast<std::string_view>(),
+                                             py::object(fields[1]).cast<std::string_view>(),
+                                             py::object(fields[2]).cast<std::string_view>(),
+                                             py::object(fields[3]).cast<std::int64_t>()));
+    }
+    return batch;
+}
+
+std::vector<Event> events_from_columns(EventStreamProcessor& processor,
+                                       const py::sequence& event_types,
+                                       const py::sequence& user_ids,
+                                       const py::sequence& channel_ids,
+                                       const py::sequence& timestamps) {
+    const std::size_t count = py::len(event_types);
+    if (py::len(user_ids) != count || py::len(channel_ids) != count || py::len(timestamps) != count) {
+        throw py::value_error("push_events column sequences must have equal length");
+    }
+    std::vector<Event> batch;
+    batch.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        batch.push_back(processor.make_event(py::object(event_types[i]).cast<std::string_view>(),
+                                             py::object(user_ids[i]).cast<std::string_view>(),
+                                             py::object(channel_ids[i]).cast<std::string_view>(),
+                                             py::object(timestamps[i]).cast<std::int64_t>()));
+    }
+    return batch;
+}
+
+py::list batch_to_dicts(const EventBatch& batch) {
+    // ids repeat heavily within a batch, so decode each string once
+    std::unordered_map<InternId, py::str> decoded;
+    const auto text = [&](InternId id) -> const py::str& {
+        auto it = decoded.find(id);
+        if (it == decoded.end()) {
+            it = decoded.emplace(id, py::str(batch.resolve(id))).first;
+        }
+        return it->second;
+    };
+    py::list payload(batch.size());
+    std::size_t index = 0;
+    for (const auto& event : batch.events()) {
+        py::dict item;
+        item["type"] = text(event.event_type);
+        item["user_id"] = text(event.user_id);
+        item["channel_id"] = text(event.channel_id);
+        item["timestamp"] = event.timestamp;
+        payload[index++] = std::move(item);
+    }
+    return payload;
+}
+
+// Read-only strided view over one field of a batch's events. It exports the
+// buffer protocol, so memoryview()/numpy.asarray() see the C++ storage
+// directly, and it keeps the batch alive for as long as the view exists.
+struct EventColumn {
+    std::shared_ptr<const EventBatch> batch;
+    std::size_t offset;
+    std::size_t itemsize;
+    std::string format;
+};
+
+template <typename Field>
+EventColumn make_column(const std::shared_ptr<const EventBatch>& batch, std::size_t offset) {
+    return EventColumn{batch, offset, sizeof(Field), py::format_descriptor<Field>::format()};
+}
+
+// Python face of a flushed batch in columnar mode. Nothing is converted
+// up front; the string table is only decoded on first access.
+struct ColumnarBatch {
+    std::shared_ptr<const EventBatch> batch;
+    py::object strings;
+};
+
+py::dict decode_string_table(const EventBatch& batch) {
+    py::dict table;
+    for (const auto& event : batch.events()) {
+        for (const InternId id : {event.event_type, event.user_id, event.channel_id}) {
+            py::int_ key(id);
+            if (!table.contains(key)) {
+                table[key] = py::str(batch.resolve(id));
+            }
+        }
+    }
+    return table;
+}
+
+// Flush tasks keep the installed callback alive, so its last reference can
+// go on a pool worker after a new callback replaces it. The deleter takes
+// the GIL so the Python reference is always dropped under it.
+std::shared_ptr<py::function> gil_owned(py::function fn) {
+    return std::shared_ptr<py::function>(new py::function(std::move(fn)), [](py::function* held) {
+        py::gil_scoped_acquire acquire;
+        delete held;
+    });
+}
+
+py::object batch_to_python(EventBatch batch, bool columnar) {
+    if (columnar) {
+        return py::cast(ColumnarBatch{std::make_shared<const EventBatch>(std::move(batch)), py::none()});
+    }
+    return batch_to_dicts(batch);
+}
+
+// Async iterator over the batches a BatchQueue receives. Workers only move
+// batches into the queue; conversion and handling happen on the event loop
+// thread, which learns about new batches through loop.add_reader. Meant for
+// one consumer at a time.
+struct BatchStream {
+    std::shared_ptr<BatchQueue> queue;
+    bool columnar;
+};
+
+// Returns an asyncio future for the next batch; it fails with
+// StopAsyncIteration once the stream is closed and drained.
+py::object next_batch(const BatchStream& stream) {
+    py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+    py::object future = loop.attr("create_future")();
+    if (auto batch = stream.queue->try_pop()) {
+        future.attr("set_result")(batch_to_python(std::move(*batch), stream.columnar));
+        return future;
+    }
+    if (stream.queue->closed()) {
+        PyErr_SetNone(PyExc_StopAsyncIteration);
+        throw py::error_already_set();
+    }
+
+    const int fd = stream.queue->fd();
+    auto on_ready = [queue = stream.queue, columnar = stream.columnar, future]() {
+        if (future.attr("done")().cast<bool>()) {
+            return;
+        }
+        if (auto batch = queue->try_pop()) {
+            future.attr("set_result")(batch_to_python(std::move(*batch), columnar));
+        } else if (queue->closed()) {
+            future.attr("set_exception")(py::handle(PyExc_StopAsyncIteration)());
+        }
+    };
+    loop.attr("add_reader")(fd, py::cpp_function(std::move(on_ready)));
+    // also runs when the awaiting task is cancelled
+    future.attr("add_done_callback")(py::cpp_function([loop, fd](const py::object&) {
+        loop.attr("remove_reader")(fd);
+    }));
+    return future;
+}
+
+py::dict latency_to_dict(const LatencySummary& summary) {
+    py::dict out;
+    out["count"] = summary.count;
+    out["mean"] = summary.mean;
+    out["max"] = summary.max;
+    out["p50"] = summary.p50;
+    out["p90"] = summary.p90;
+    out["p99"] = summary.p99;
+    out["p999"] = summary.p999;
+    return out;
+}
+
+py::dict metrics_to_dict(const PipelineMetrics& metrics) {
+    py::dict out;
+    out["events_processed"] = metrics.events_processed;
+    out["events_dropped"] = metrics.events_dropped;
+    out["events_overwritten"] = metrics.events_overwritten;
+    out["batches_flushed"] = metrics.batches_flushed;
+    out["flush_callback_failures"] = metrics.flush_callback_failures;
+    out["events_spilled"] = metrics.events_spilled;
+    out["events_replayed"] = metrics.events_replayed;
+    out["spill_pending_records"] = metrics.spill_pending_records;
+    out["pending_flush_tasks"] = metrics.pending_flush_tasks;
+    out["pool_queued_tasks"] = metrics.pool_queued_tasks;
+    out["consumer_busy_ratio"] = metrics.consumer_busy_ratio;
+    out["enqueue_to_flush_us"] = latency_to_dict(metrics.enqueue_to_flush_us);
+    out["flush_queue_us"] = latency_to_dict(metrics.flush_queue_us);
+    out["callback_us"] = latency_to_dict(metrics.callback_us);
+    py::list shards;
+    for (const auto& shard : metrics.shards) {
+        py::dict entry;
+        entry["ring_occupancy"] = shard.ring_occupancy;
+        entry["ring_capacity"] = shard.ring_capacity;
+        entry["pending_batch"] = shard.pending_batch;
+        entry["busy_ratio"] = shard.busy_ratio;
+        shards.append(std::move(entry));
+    }
+    out["shards"] = std::move(shards);
+    return out;
+}
+
+} // namespace
+
 PYBIND11_MODULE(cpp_event_processor, m) {
+    // Events carry interned ids; strings are only materialised at flush time
     py::class_<Event>(m, "Event")
-        .def_property_readonly("event_type", [](const Event& e) { return e.event_type; })
-        .def_property_readonly("user_id", [](const Event& e) { return e.user_id; })
-        .def_property_readonly("channel_id", [](const Event& e) { return e.channel_id; })
+        .def_property_readonly("event_type_key", [](const Event& e) { return e.event_type; })
+        .def_property_readonly("user_key", [](const Event& e) { return e.user_id; })
+        .def_property_readonly("channel_key", [](const Event& e) { return e.channel_id; })
         .def_property_readonly("timestamp", [](const Event& e) { return e.timestamp; });
 
+    py::class_<EventColumn>(m, "EventColumn", py::buffer_protocol())
+        .def_buffer([](EventColumn& column) {
+            const auto& events = column.batch->events();
+            auto* base = reinterpret_cast<const char*>(events.data()) + column.offset;
+            return py::buffer_info(const_cast<char*>(base),
+                                   static_cast<py::ssize_t>(column.itemsize),
+                                   column.format,
+                                   1,
+                                   {static_cast<py::ssize_t>(events.size())},
+                                   {static_cast<py::ssize_t>(sizeof(Event))},
+                                   true);
+        })
+        .def("__len__", [](const EventColumn& column) { return column.batch->size(); });
+
+    py::class_<ColumnarBatch>(m, "EventBatch")
+        .def("__len__", [](const ColumnarBatch& self) { return self.batch->size(); })
+        .def_property_readonly("timestamps", [](const ColumnarBatch& self) {
+            return make_column<std::int64_t>(self.batch, offsetof(Event, timestamp));
+        })
+        .def_property_readonly("event_type_ids", [](const ColumnarBatch& self) {
+            return make_column<InternId>(self.batch, offsetof(Event, event_type));
+        })
+        .def_property_readonly("user_ids", [](const ColumnarBatch& self) {
+            return make_column<InternId>(self.batch, offsetof(Event, user_id));
+        })
+        .def_property_readonly("channel_ids", [](const ColumnarBatch& self) {
+            return make_column<InternId>(self.batch, offsetof(Event, channel_id));
+        })
+        .def_property_readonly("strings", [](ColumnarBatch& self) {
+            if (self.strings.is_none()) {
+                self.strings = decode_string_table(*self.batch);
+            }
+            return self.strings;
+        })
+        .def("decode", [](const ColumnarBatch& self, InternId id) {
+            if (id >= self.batch->strings()->size()) {
+                throw py::index_error("unknown interned id");
+            }
+            return self.batch->resolve(id);
+        }, py::arg("id"))
+        .def("to_list", [](const ColumnarBatch& self) { return batch_to_dicts(*self.batch); });
+
+    py::class_<BatchStream>(m, "BatchStream")
+        .def("__aiter__", [](py::object self) { return self; })
+        .def("__anext__", &next_batch)
+        .def("poll", [](const BatchStream& self) -> py::object {
+            if (auto batch = self.queue->try_pop()) {
+                return batch_to_python(std::move(*batch), self.columnar);
+            }
+            return py::none();
+        })
+        .def("fileno", [](const BatchStream& self) { return self.queue->fd(); })
+        .def("close", [](const BatchStream& self) { self.queue->close(); })
+        .def_property_readonly("closed", [](const BatchStream& self) { return self.queue->closed(); })
+        .def_property_readonly("pending", [](const BatchStream& self) { return self.queue->size(); })
+        .def_property_readonly("max_pending", [](const BatchStream& self) { return self.queue->capacity(); });
+
+    py::class_<LeaderboardSink, std::shared_ptr<LeaderboardSink>>(m, "LeaderboardSink")
+        .def("events_scored", &LeaderboardSink::events_scored)
+        .def("batches_applied", &LeaderboardSink::batches_applied);
+
+    py::enum_<OverflowPolicy>(m, "OverflowPolicy")
+        .value("DROP", OverflowPolicy::Drop)
+        .value("BLOCK", OverflowPolicy::Block)
+        .value("OVERWRITE_OLDEST", OverflowPolicy::OverwriteOldest);
+
+    py::enum_<MetricsMode>(m, "MetricsMode")
+        .value("OFF", MetricsMode::Off)
+        .value("SAMPLED", MetricsMode::Sampled)
+        .value("FULL", MetricsMode::Full);
+
     py::class_<EventStreamProcessor>(m, "EventStreamProcessor")
-        .def(py::init<std::size_t, std::size_t, std::size_t, std::size_t>(),
+        .def(py::init<std::size_t, std::size_t, std::size_t, std::size_t, std::size_t, std::size_t,
+                      OverflowPolicy, std::size_t, std::size_t>(),
              py::arg("buffer_size"),
              py::arg("num_threads"),
              py::arg("batch_size"),
-             py::arg("flush_interval_ms"))
+             py::arg("flush_interval_ms"),
+             py::arg("num_shards") = 1,
+             py::arg("top_channel_capacity") = 1024,
+             py::arg("overflow_policy") = OverflowPolicy::Drop,
+             py::arg("block_timeout_ms") = 100,
+             py::arg("dimension_memory_budget") = EventStreamProcessor::kDefaultDimensionMemoryBudget)
         .def("push_event", [](EventStreamProcessor& self,
-                               const std::string& event_type,
-                               const std::string& user_id,
-                               const std::string& channel_id,
+                               std::string_view event_type,
+                               std::string_view user_id,
+                               std::string_view channel_id,
                                std::int64_t timestamp) {
             // Release GIL for better concurrency
             py::gil_scoped_release release;
@@ -32,6 +318,24 @@ PYBIND11_MODULE(cpp_event_processor, m) {
            py::arg("user_id"),
            py::arg("channel_id"),
            py::arg("timestamp"))
+        .def("push_events", [](EventStreamProcessor& self, const py::sequence& events) {
+            // Convert everything while holding the GIL, then enqueue in one go
+            auto batch = events_from_tuples(self, events);
+            py::gil_scoped_release release;
+            return self.push_events(std::move(batch));
+        }, py::arg("events"))
+        .def("push_events", [](EventStreamProcessor& self,
+                                const py::sequence& event_types,
+                                const py::sequence& user_ids,
+                                const py::sequence& channel_ids,
+                                const py::sequence& timestamps) {
+            auto batch = events_from_columns(self, event_types, user_ids, channel_ids, timestamps);
+            py::gil_scoped_release release;
+            return self.push_events(std::move(batch));
+        }, py::arg("event_types"),
+           py::arg("user_ids"),
+           py::arg("channel_ids"),
+           py::arg("timestamps"))
         .def("get_unique_users_last_hour", &EventStreamProcessor::get_unique_users_last_hour)
         .def("get_top_channels", [](EventStreamProcessor& self, std::size_t k) {
             const auto top = self.get_top_channels(k);
@@ -41,31 +345,106 @@ PYBIND11_MODULE(cpp_event_processor, m) {
             }
             return result;
         }, py::arg("k"))
-        .def("set_flush_callback", [](EventStreamProcessor& self, py::object callback) {
+        .def("top_channels_error_bound", &EventStreamProcessor::top_channels_error_bound)
+        .def("estimate_channel_count", &EventStreamProcessor::estimate_channel_count,
+             py::arg("channel_id"))
+        .def("get_unique_users", &EventStreamProcessor::get_unique_users,
+             py::arg("channel_id"),
+             py::arg("window_seconds") = EventStreamProcessor::kDimensionWindowSeconds,
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_unique_users_by_event_type", &EventStreamProcessor::get_unique_users_by_event_type,
+             py::arg("event_type"),
+             py::arg("window_seconds") = EventStreamProcessor::kDimensionWindowSeconds,
+             py::call_guard<py::gil_scoped_release>())
+        .def("dimension_memory_bytes", &EventStreamProcessor::dimension_memory_bytes)
+        .def("dimension_evictions", &EventStreamProcessor::dimension_evictions)
+        .def("set_flush_callback", [](EventStreamProcessor& self, py::object callback, bool columnar) {
             if (callback.is_none()) {
                 self.set_flush_callback(nullptr);
                 return;
             }
-            py::function fn = callback;
-            self.set_flush_callback([fn](std::vector<Event> events) {
+            auto fn = gil_owned(callback);
+            if (columnar) {
+                self.set_flush_callback([fn](EventBatch batch) {
+                    auto shared = std::make_shared<const EventBatch>(std::move(batch));
+                    py::gil_scoped_acquire acquire;
+                    (*fn)(ColumnarBatch{std::move(shared), py::none()});
+                });
+                return;
+            }
+            self.set_flush_callback([fn](EventBatch batch) {
                 py::gil_scoped_acquire acquire;
-                py::list payload;
-                for (const auto& event : events) {
-                    py::dict item;
-                    item["type"] = event.event_type;
-                    item["user_id"] = event.user_id;
-                    item["channel_id"] = event.channel_id;
-                    item["timestamp"] = event.timestamp;
-                    payload.append(std::move(item));
-                }
-                fn(payload);
+                (*fn)(batch_to_dicts(batch));
             });
-        }, py::arg("callback"))
+        }, py::arg("callback"),
+           py::arg("columnar") = false)
+        .def("add_leaderboard_sink", [](EventStreamProcessor& self,
+                                         std::vector<std::shared_ptr<leaderboard::Leaderboard>> leaderboards,
+                                         std::unordered_map<std::string, double> points_by_event_type,
+                                         double default_points) {
+            // cpp_leaderboard boards use a shared holder, so the stage keeps them alive
+            auto sink = std::make_shared<LeaderboardSink>(std::move(leaderboards),
+                                                          std::move(points_by_event_type), default_points);
+            self.add_flush_stage(LeaderboardSink::stage(sink));
+            return sink;
+        }, py::arg("leaderboards"),
+           py::arg("points_by_event_type"),
+           py::arg("default_points") = 0.0)
+        .def("clear_flush_stages", &EventStreamProcessor::clear_flush_stages)
+        .def("batches", [](EventStreamProcessor& self, std::size_t max_pending, bool columnar) {
+            // replaces the flush callback; deliveries beyond max_pending fail
+            auto queue = std::make_shared<BatchQueue>(max_pending);
+            self.set_flush_callback(BatchQueue::sink(queue));
+            return BatchStream{std::move(queue), columnar};
+        }, py::arg("max_pending") = 64,
+           py::arg("columnar") = false)
         .def("flush_now", [](EventStreamProcessor& self) {
             // Release GIL to avoid deadlock with callback threads
             py::gil_scoped_release release;
             self.flush_now();
         })
+        .def("serialize_sketches", [](EventStreamProcessor& self) {
+            std::string bytes;
+            {
+                py::gil_scoped_release release;
+                bytes = self.serialize_sketches();
+            }
+            return py::bytes(bytes);
+        })
+        .def("merge_from", [](EventStreamProcessor& self, const py::bytes& snapshot) {
+            // the view stays valid because `snapshot` keeps the buffer alive
+            const auto view = static_cast<std::string_view>(snapshot);
+            py::gil_scoped_release release;
+            self.merge_from(view);
+        }, py::arg("snapshot"))
+        .def("save_sketches", &EventStreamProcessor::save_sketches,
+             py::arg("path"), py::call_guard<py::gil_scoped_release>())
+        .def("load_sketches", &EventStreamProcessor::load_sketches,
+             py::arg("path"), py::call_guard<py::gil_scoped_release>())
+        .def("enable_spill_journal", &EventStreamProcessor::enable_spill_journal,
+             py::arg("directory"),
+             py::arg("segment_bytes") = engagehub::SpillJournal::kDefaultSegmentBytes,
+             py::arg("sync_interval_ms") = 100,
+             py::call_guard<py::gil_scoped_release>())
+        .def("spill_journal_enabled", &EventStreamProcessor::spill_journal_enabled)
+        .def("spilled_pending", &EventStreamProcessor::spilled_pending)
+        .def("events_spilled", &EventStreamProcessor::events_spilled)
+        .def("events_replayed", &EventStreamProcessor::events_replayed)
         .def("total_events_processed", &EventStreamProcessor::total_events_processed)
-        .def("events_dropped", &EventStreamProcessor::events_dropped);
+        .def("events_dropped", &EventStreamProcessor::events_dropped)
+        .def("events_overwritten", &EventStreamProcessor::events_overwritten)
+        .def_property_readonly("overflow_policy", &EventStreamProcessor::overflow_policy)
+        .def("flush_callback_failures", &EventStreamProcessor::flush_callback_failures)
+        .def("shard_count", &EventStreamProcessor::shard_count)
+        .def("get_metrics", [](const EventStreamProcessor& self) {
+            PipelineMetrics metrics;
+            {
+                py::gil_scoped_release release;
+                metrics = self.get_metrics();
+            }
+            return metrics_to_dict(metrics);
+        })
+        .def_property("metrics_mode", &EventStreamProcessor::metrics_mode,
+                      &EventStreamProcessor::set_metrics_mode)
+        .def("reset_latency_metrics", &EventStreamProcessor::reset_latency_metrics);
 }
@@ -1,124 +1,592 @@
 #include "event_processor.hpp"
 
+#include "byte_io.hpp"
+#include "hashing.hpp"
+#include "mapped_file.hpp"
+
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <thread>
+#include <unordered_map>
 
 namespace engagehub {
 namespace {
 constexpr std::int64_t kWindowSpanSeconds = 3600;
 constexpr std::int64_t kBucketSpanSeconds = 60;
+// how stale a busy shard's published statistics may get
+constexpr auto kSnapshotInterval = std::chrono::milliseconds(50);
+// events processed between clock reads on the hot path
+constexpr std::uint64_t kSnapshotCheckStride = 256;
+// empty polls before the consumer parks, roughly a few microseconds
+constexpr int kConsumerSpinIterations = 256;
+// longest a parked consumer sleeps without a push, so idle shards still
+// notice the window sliding past a bucket boundary
+constexpr auto kIdleParkTimeout = std::chrono::milliseconds(1000);
+// failed pushes before a blocked producer parks on space_ready
+constexpr int kProducerSpinIterations = 64;
+
+// Sketch snapshot layout, all integers little-endian:
+//   "EHSK" | u16 version | u16 reserved
+//   channel Count-Min table (CountMinSketch::serialize)
+//   unique-user bucket ring (SlidingHyperLogLog::serialize)
+//   u64 MurmurHash3 of every preceding byte
+constexpr char kSketchMagic[4] = {'E', 'H', 'S', 'K'};
+constexpr std::uint16_t kSketchFormatVersion = 1;
+constexpr std::size_t kSketchHeaderSize = sizeof(kSketchMagic) + 2 * sizeof(std::uint16_t);
+
+// Spill journal record tags. Overflow events have not been processed yet and
+// go back through the rings; delivery batches only still need the callback.
+constexpr std::uint8_t kSpillOverflow = 1;
+constexpr std::uint8_t kSpillDelivery = 2;
+
+// Spilled events carry their strings, since intern ids mean nothing to
+// another process:
+//   varint string count | (varint length, bytes) per string
+//   varint event count | (varint type, user, channel string index, u64 timestamp) per event
+std::string encode_spill(const StringInterner& strings, const Event* first, std::size_t count) {
+    std::vector<InternId> ids;
+    std::unordered_map<InternId, std::uint32_t> index;
+    const auto local = [&](InternId id) {
+        const auto [it, inserted] = index.emplace(id, static_cast<std::uint32_t>(ids.size()));
+        if (inserted) {
+            ids.push_back(id);
+        }
+        return it->second;
+    };
+    std::string events;
+    ByteWriter event_out(events);
+    for (std::size_t i = 0; i < count; ++i) {
+        event_out.put_varint(local(first[i].event_type));
+        event_out.put_varint(local(first[i].user_id));
+        event_out.put_varint(local(first[i].channel_id));
+        event_out.put<std::int64_t>(first[i].timestamp);
+    }
 
-std::int64_t bucket_start(std::int64_t timestamp) {
-    if (timestamp <= 0) {
-        timestamp = static_cast<std::int64_t>(
-            std::chrono::duration_cast<std::chrono::seconds>(
-                std::chrono::system_clock::now().time_since_epoch())
-                .count());
+    std::string out;
+    ByteWriter writer(out);
+    writer.put_varint(ids.size());
+    for (const auto id : ids) {
+        const auto& value = strings.resolve(id);
+        writer.put_varint(value.size());
+        writer.put_bytes(value.data(), value.size());
     }
-    return (timestamp / kBucketSpanSeconds) * kBucketSpanSeconds;
+    writer.put_varint(count);
+    writer.put_bytes(events.data(), events.size());
+    return out;
+}
+
+std::vector<Event> decode_spill(StringInterner& strings, std::string_view payload) {
+    ByteReader in(payload);
+    std::vector<InternId> ids(in.get_varint());
+    for (auto& id : ids) {
+        id = strings.intern(in.get_bytes(in.get_varint()));
+    }
+    const auto lookup = [&](std::uint64_t index) {
+        if (index >= ids.size()) {
+            throw std::runtime_error("Spilled event refers to an unknown string");
+        }
+        return ids[index];
+    };
+    std::vector<Event> events(in.get_varint());
+    for (auto& event : events) {
+        event.event_type = lookup(in.get_varint());
+        event.user_id = lookup(in.get_varint());
+        event.channel_id = lookup(in.get_varint());
+        event.timestamp = in.get<std::int64_t>();
+    }
+    return events;
+}
+
+void check_dimension_window(std::int64_t window_seconds) {
+    if (window_seconds <= 0 || window_seconds > EventStreamProcessor::kDimensionWindowSeconds) {
+        throw std::invalid_argument("window_seconds must be between 1 and " +
+                                    std::to_string(EventStreamProcessor::kDimensionWindowSeconds));
+    }
+}
+
+// Low 32 bits of the steady clock in microseconds. Differences stay correct
+// across wrap-around for anything under about 71 minutes. The low bit is
+// forced on so a stamp is never 0, which marks an unsampled event.
+std::uint32_t enqueue_stamp() {
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+    return static_cast<std::uint32_t>(micros) | 1U;
+}
+
+std::uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since)
+            .count());
+}
+
+std::int64_t now_seconds() {
+    return static_cast<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
 }
 } // namespace
 
 EventStreamProcessor::EventStreamProcessor(std::size_t buffer_size,
                                            std::size_t num_threads,
                                            std::size_t batch_size,
-                                           std::size_t flush_interval_ms)
+                                           std::size_t flush_interval_ms,
+                                           std::size_t num_shards,
+                                           std::size_t top_channel_capacity,
+                                           OverflowPolicy overflow_policy,
+                                           std::size_t block_timeout_ms,
+                                           std::size_t dimension_memory_budget)
     : batch_size_(batch_size == 0 ? 1 : batch_size),
       flush_interval_(std::chrono::milliseconds(flush_interval_ms == 0 ? 1 : flush_interval_ms)),
-      buffer_(buffer_size == 0 ? 1024 : buffer_size),
-      thread_pool_(num_threads == 0 ? std::thread::hardware_concurrency() : num_threads),
-      channel_frequency_(),
-      last_flush_time_(std::chrono::steady_clock::now()) {
-    pending_batch_.reserve(batch_size_ * 2);
+      overflow_policy_(overflow_policy),
+      block_timeout_(std::chrono::milliseconds(block_timeout_ms)),
+      track_dimensions_(dimension_memory_budget != 0),
+      strings_(std::make_shared<StringInterner>()),
+      thread_pool_(num_threads == 0 ? std::thread::hardware_concurrency() : num_threads) {
+    const std::size_t shard_count = num_shards == 0 ? 1 : num_shards;
+    const std::size_t total_capacity = buffer_size == 0 ? 1024 : buffer_size;
+    const std::size_t shard_capacity = (total_capacity + shard_count - 1) / shard_count;
+    // split between the two dimension families of every shard
+    const std::size_t dimension_budget = dimension_memory_budget / (2 * shard_count);
+
+    shards_.reserve(shard_count);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<Shard>(shard_capacity, kWindowSpanSeconds, kBucketSpanSeconds,
+                                             top_channel_capacity == 0 ? 1 : top_channel_capacity,
+                                             dimension_budget);
+        shard->pending_batch.reserve(batch_size_ * 2);
+        shard->last_flush_time = std::chrono::steady_clock::now();
+        publish_snapshot(*shard);
+        shards_.push_back(std::move(shard));
+    }
+
     running_.store(true, std::memory_order_release);
-    consumer_thread_ = std::thread([this]() { consume_loop(); });
+    for (auto& shard : shards_) {
+        Shard* target = shard.get();
+        target->consumer_thread = std::thread([this, target]() { consume_loop(*target); });
+    }
 }
 
 EventStreamProcessor::~EventStreamProcessor() {
     running_.store(false, std::memory_order_release);
-    flush_requested_.store(true, std::memory_order_release);
-    data_cv_.notify_all();
-    if (consumer_thread_.joinable()) {
-        consumer_thread_.join();
+    for (auto& shard : shards_) {
+        shard->flush_requested.store(true, std::memory_order_release);
+        shard->data_ready.notify();
+        shard->space_ready.notify();
+    }
+    for (auto& shard : shards_) {
+        if (shard->consumer_thread.joinable()) {
+            shard->consumer_thread.join();
+        }
     }
 
     thread_pool_.shutdown();
 }
 
-bool EventStreamProcessor::push_event(const std::string& event_type,
-                                      const std::string& user_id,
-                                      const std::string& channel_id,
+std::size_t EventStreamProcessor::shard_index(InternId channel_id) const {
+    if (shards_.size() == 1) {
+        return 0;
+    }
+    return strings_->hash_of(channel_id) % shards_.size();
+}
+
+Event EventStreamProcessor::make_event(std::string_view event_type,
+                                       std::string_view user_id,
+                                       std::string_view channel_id,
+                                       std::int64_t timestamp) {
+    return Event{strings_->intern(event_type),
+                 strings_->intern(user_id),
+                 strings_->intern(channel_id),
+                 0,
+                 timestamp};
+}
+
+bool EventStreamProcessor::push_event(std::string_view event_type,
+                                      std::string_view user_id,
+                                      std::string_view channel_id,
                                       std::int64_t timestamp) {
-    Event event{event_type, user_id, channel_id, timestamp};
-    const bool pushed = buffer_.push(std::move(event));
-    if (!pushed) {
-        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+    Event event = make_event(event_type, user_id, channel_id, timestamp);
+    stamp_enqueue(&event, 1);
+    Shard& shard = *shards_[shard_index(event.channel_id)];
+    if (!shard.buffer.push(event) && push_overflow(shard, &event, 1) == 0) {
         return false;
     }
-    drained_.store(false, std::memory_order_release);
-    data_cv_.notify_one();
+    signal_data(shard);
     return true;
 }
 
-std::uint64_t EventStreamProcessor::get_unique_users_last_hour() {
-    HyperLogLog aggregate;
-    const auto now_seconds = static_cast<std::int64_t>(
-        std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::system_clock::now().time_since_epoch())
+std::size_t EventStreamProcessor::push_events(std::vector<Event> events) {
+    if (events.empty()) {
+        return 0;
+    }
+    if (shards_.size() == 1) {
+        return push_to_shard(*shards_.front(), events);
+    }
+
+    std::vector<std::vector<Event>> routed(shards_.size());
+    for (auto& event : events) {
+        routed[shard_index(event.channel_id)].push_back(event);
+    }
+    std::size_t accepted = 0;
+    for (std::size_t i = 0; i < routed.size(); ++i) {
+        if (!routed[i].empty()) {
+            accepted += push_to_shard(*shards_[i], routed[i]);
+        }
+    }
+    return accepted;
+}
+
+std::size_t EventStreamProcessor::push_to_shard(Shard& shard, std::vector<Event>& events) {
+    stamp_enqueue(events.data(), events.size());
+    std::size_t accepted = shard.buffer.try_push_bulk(events.begin(), events.size());
+    if (accepted < events.size()) {
+        if (accepted != 0) {
+            // let the consumer start on what fits while the rest waits for space
+            signal_data(shard);
+        }
+        accepted += push_overflow(shard, events.data() + accepted, events.size() - accepted);
+    }
+    if (accepted != 0) {
+        signal_data(shard);
+    }
+    return accepted;
+}
+
+void EventStreamProcessor::stamp_enqueue(Event* first, std::size_t count) const {
+    switch (metrics_mode_.load(std::memory_order_relaxed)) {
+    case MetricsMode::Off:
+        return;
+    case MetricsMode::Full: {
+        const auto stamp = enqueue_stamp();
+        for (std::size_t i = 0; i < count; ++i) {
+            first[i].enqueued_us = stamp;
+        }
+        return;
+    }
+    case MetricsMode::Sampled: {
+        // per thread, so producers never share a cache line for sampling
+        thread_local std::uint32_t until_sample = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (until_sample == 0) {
+                until_sample = kMetricsSampleInterval;
+                first[i].enqueued_us = enqueue_stamp();
+            }
+            --until_sample;
+        }
+        return;
+    }
+    }
+}
+
+void EventStreamProcessor::record_enqueue_latency(const std::vector<Event>& batch) {
+    if (metrics_mode_.load(std::memory_order_relaxed) == MetricsMode::Off) {
+        return;
+    }
+    const auto now = enqueue_stamp();
+    for (const auto& event : batch) {
+        if (event.enqueued_us != 0) {
+            // unsigned subtraction handles the 32-bit wrap
+            enqueue_to_flush_.record(static_cast<std::uint32_t>(now - event.enqueued_us));
+        }
+    }
+}
+
+PipelineMetrics EventStreamProcessor::get_metrics() const {
+    PipelineMetrics metrics;
+    metrics.events_processed = total_events_processed();
+    metrics.events_dropped = events_dropped();
+    metrics.events_overwritten = events_overwritten();
+    metrics.batches_flushed = batches_flushed_.load(std::memory_order_relaxed);
+    metrics.flush_callback_failures = flush_callback_failures();
+    metrics.events_spilled = events_spilled();
+    metrics.events_replayed = events_replayed();
+    metrics.spill_pending_records = spilled_pending();
+    metrics.pending_flush_tasks = pending_flush_tasks_.load(std::memory_order_relaxed);
+    metrics.pool_queued_tasks = thread_pool_.pending();
+
+    const auto lifetime_ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_at_)
             .count());
-    const auto cutoff = now_seconds - kWindowSpanSeconds;
+    double busy_total = 0.0;
+    metrics.shards.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+        ShardMetrics entry;
+        entry.ring_occupancy = shard->buffer.size_approx();
+        entry.ring_capacity = shard->buffer.capacity();
+        {
+            std::lock_guard<std::mutex> lock(shard->batch_mutex);
+            entry.pending_batch = shard->pending_batch.size();
+        }
+        const auto parked = static_cast<double>(shard->parked_ns.load(std::memory_order_relaxed));
+        entry.busy_ratio = lifetime_ns > 0.0 ? std::clamp(1.0 - parked / lifetime_ns, 0.0, 1.0) : 0.0;
+        busy_total += entry.busy_ratio;
+        metrics.shards.push_back(entry);
+    }
+    metrics.consumer_busy_ratio = busy_total / static_cast<double>(shards_.size());
+
+    metrics.enqueue_to_flush_us = enqueue_to_flush_.summary();
+    metrics.flush_queue_us = flush_queue_wait_.summary();
+    metrics.callback_us = callback_duration_.summary();
+    return metrics;
+}
+
+void EventStreamProcessor::reset_latency_metrics() noexcept {
+    enqueue_to_flush_.reset();
+    flush_queue_wait_.reset();
+    callback_duration_.reset();
+}
+
+// Applies the overflow policy to events that did not fit in the ring.
+// Returns how many were eventually accepted or spilled; the rest count as
+// dropped.
+std::size_t EventStreamProcessor::push_overflow(Shard& shard, Event* first, std::size_t count) {
+    std::size_t accepted = 0;
+    switch (overflow_policy_) {
+    case OverflowPolicy::Drop:
+        break;
+
+    case OverflowPolicy::Block:
+        accepted = wait_for_space(shard, first, count);
+        break;
+
+    case OverflowPolicy::OverwriteOldest:
+        // Only the consumer may pop from the MPSC ring, so each overflowing
+        // event that gets in is recorded as a debt the consumer pays by
+        // discarding the oldest queued event. Debt is taken on only for
+        // events already pushed, so one that times out is lost on its own
+        // and never costs a queued event as well.
+        accepted = wait_for_space(shard, first, count, true);
+        break;
+    }
+
+    if (accepted < count && spill(kSpillOverflow, first + accepted, count - accepted)) {
+        accepted = count;
+    }
+    if (accepted < count) {
+        events_dropped_.fetch_add(count - accepted, std::memory_order_relaxed);
+    }
+    return accepted;
+}
+
+// Pushes [first, first + count) as space frees up, spinning briefly and then
+// parking on space_ready, until block_timeout_ runs out. With `overwrite`
+// every pushed event adds one unit of overwrite debt. If the consumer pops
+// the new events before their debt lands, the debt goes to the next queued
+// events instead; either way each pushed overflow costs one queued event.
+std::size_t EventStreamProcessor::wait_for_space(Shard& shard, Event* first, std::size_t count,
+                                                 bool overwrite) {
+    std::size_t accepted = 0;
+    const auto push = [&] {
+        const std::size_t pushed = shard.buffer.try_push_bulk(first + accepted, count - accepted);
+        if (overwrite && pushed != 0) {
+            shard.overwrite_debt.fetch_add(pushed, std::memory_order_relaxed);
+        }
+        accepted += pushed;
+        return pushed;
+    };
+    const auto deadline = std::chrono::steady_clock::now() + block_timeout_;
+    for (int spin = 0; accepted < count && spin < kProducerSpinIterations; ++spin) {
+        cpu_relax();
+        push();
+    }
+    while (accepted < count && running_.load(std::memory_order_acquire)) {
+        const auto key = shard.space_ready.prepare_wait();
+        if (push() != 0) {
+            shard.space_ready.cancel_wait();
+            signal_data(shard);
+            continue;
+        }
+        if (!shard.space_ready.wait_until(key, deadline) &&
+            std::chrono::steady_clock::now() >= deadline) {
+            push();
+            break;
+        }
+    }
+    return accepted;
+}
+
+// Claims up to `available` units of overwrite debt for the consumer to pay.
+std::size_t EventStreamProcessor::take_overwrite_debt(Shard& shard, std::size_t available) {
+    std::size_t debt = shard.overwrite_debt.load(std::memory_order_relaxed);
+    std::size_t take = 0;
+    do {
+        take = std::min(debt, available);
+    } while (take != 0 &&
+             !shard.overwrite_debt.compare_exchange_weak(debt, debt - take, std::memory_order_relaxed));
+    return take;
+}
 
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    while (!windows_.empty() && windows_.front().window_start < cutoff) {
-        windows_.pop_front();
+void EventStreamProcessor::signal_data(Shard& shard) {
+    drained_.store(false, std::memory_order_release);
+    shard.data_ready.notify();
+}
+
+std::uint64_t EventStreamProcessor::get_unique_users_last_hour() {
+    if (shards_.size() == 1) {
+        return load_snapshot(*shards_.front())->unique_users;
     }
-    for (const auto& window : windows_) {
-        aggregate.merge(window.sketch);
+
+    HyperLogLog aggregate;
+    for (const auto& shard : shards_) {
+        aggregate.merge(load_snapshot(*shard)->users);
     }
     return aggregate.cardinality();
 }
 
 std::vector<std::pair<std::string, std::uint64_t>> EventStreamProcessor::get_top_channels(std::size_t k) {
-    std::vector<std::pair<std::string, std::uint64_t>> entries;
+    std::vector<HeavyHitter> candidates;
+    for (const auto& shard : shards_) {
+        // channels never span shards, so each shard's top-k is a complete candidate set
+        const auto snapshot = load_snapshot(*shard);
+        const auto& top = snapshot->top_channels;
+        candidates.insert(candidates.end(), top.begin(),
+                          top.begin() + static_cast<std::ptrdiff_t>(std::min(k, top.size())));
+    }
+    const auto by_count = [](const HeavyHitter& lhs, const HeavyHitter& rhs) {
+        return lhs.count > rhs.count;
+    };
+    if (shards_.size() > 1) {
+        const auto keep = std::min(k, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(keep),
+                          candidates.end(), by_count);
+        candidates.resize(keep);
+    }
+
+    std::vector<std::pair<std::string, std::uint64_t>> result;
+    result.reserve(candidates.size());
+    for (const auto& entry : candidates) {
+        result.emplace_back(strings_->resolve(entry.key), entry.count);
+    }
+    return result;
+}
+
+std::uint64_t EventStreamProcessor::top_channels_error_bound() {
+    std::uint64_t bound = 0;
+    for (const auto& shard : shards_) {
+        bound = std::max(bound, load_snapshot(*shard)->channel_error_bound);
+    }
+    return bound;
+}
+
+std::uint64_t EventStreamProcessor::estimate_channel_count(std::string_view channel_id) {
+    const auto id = strings_->find(channel_id);
+    if (!id) {
+        // only merged-in snapshots can have counted it
+        return imported_channels_.estimate_hash(hashing::hash64(channel_id));
+    }
+    const Shard& shard = *shards_[shard_index(*id)];
+    const auto hash = strings_->hash_of(*id);
+    return shard.channel_frequency.estimate_hash(hash) + imported_channels_.estimate_hash(hash);
+}
+
+std::uint64_t EventStreamProcessor::get_unique_users(std::string_view channel_id, std::int64_t window_seconds) {
+    check_dimension_window(window_seconds);
+    const auto id = strings_->find(channel_id);
+    if (!id) {
+        return 0;
+    }
+    Shard& shard = *shards_[shard_index(*id)];
+    HyperLogLog users(shard.users_by_channel.precision());
     {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        entries.reserve(channel_counts_.size());
-        for (const auto& kv : channel_counts_) {
-            entries.emplace_back(kv.first, kv.second);
-        }
+        // only the bucket merge needs the consumer's lock; the estimate is
+        // computed after releasing it
+        std::lock_guard<std::mutex> lock(shard.stats_mutex);
+        shard.users_by_channel.merge_window(*id, now_seconds(), window_seconds, users);
+    }
+    return users.cardinality();
+}
+
+std::uint64_t EventStreamProcessor::get_unique_users_by_event_type(std::string_view event_type,
+                                                                   std::int64_t window_seconds) {
+    check_dimension_window(window_seconds);
+    const auto id = strings_->find(event_type);
+    if (!id) {
+        return 0;
+    }
+    const auto now = now_seconds();
+    // event types span shards, so their per-shard sketches are unioned
+    HyperLogLog aggregate(shards_.front()->users_by_event_type.precision());
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->stats_mutex);
+        shard->users_by_event_type.merge_window(*id, now, window_seconds, aggregate);
+    }
+    return aggregate.cardinality();
+}
+
+std::size_t EventStreamProcessor::dimension_memory_bytes() {
+    std::size_t bytes = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->stats_mutex);
+        bytes += shard->users_by_channel.memory_bytes() + shard->users_by_event_type.memory_bytes();
+    }
+    return bytes;
+}
+
+std::uint64_t EventStreamProcessor::dimension_evictions() {
+    std::uint64_t evicted = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->stats_mutex);
+        evicted += shard->users_by_channel.evictions() + shard->users_by_event_type.evictions();
     }
-    if (entries.size() > k) {
-        std::partial_sort(entries.begin(), entries.begin() + k, entries.end(),
-                          [](const auto& lhs, const auto& rhs) {
-                              return lhs.second > rhs.second;
-                          });
-        entries.resize(k);
-    } else {
-        std::sort(entries.begin(), entries.end(),
-                  [](const auto& lhs, const auto& rhs) {
-                      return lhs.second > rhs.second;
-                  });
+    return evicted;
+}
+
+void EventStreamProcessor::set_flush_callback(std::function<void(EventBatch)> callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    user_callback_ = callback
+        ? std::make_shared<const std::function<void(EventBatch)>>(std::move(callback))
+        : nullptr;
+    rebuild_delivery_locked();
+}
+
+void EventStreamProcessor::add_flush_stage(FlushStage stage) {
+    if (!stage) {
+        return;
     }
-    return entries;
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    flush_stages_.push_back(std::move(stage));
+    rebuild_delivery_locked();
 }
 
-void EventStreamProcessor::set_flush_callback(std::function<void(std::vector<Event>)> callback) {
+void EventStreamProcessor::clear_flush_stages() {
     std::lock_guard<std::mutex> lock(callback_mutex_);
-    flush_callback_ = std::move(callback);
+    flush_stages_.clear();
+    rebuild_delivery_locked();
+}
+
+// Folds the stages and the user callback into the one function a flush
+// task holds, so queued tasks keep whatever was installed when they flushed.
+void EventStreamProcessor::rebuild_delivery_locked() {
+    if (flush_stages_.empty()) {
+        flush_callback_ = user_callback_;
+        return;
+    }
+    flush_callback_ = std::make_shared<const std::function<void(EventBatch)>>(
+        [stages = flush_stages_, callback = user_callback_](EventBatch batch) {
+            for (const auto& stage : stages) {
+                stage(batch);
+            }
+            if (callback) {
+                (*callback)(std::move(batch));
+            }
+        });
 }
 
 void EventStreamProcessor::flush_now() {
-    flush_requested_.store(true, std::memory_order_release);
-    data_cv_.notify_all();
+    schedule_replay();
+    for (auto& shard : shards_) {
+        shard->flush_requested.store(true, std::memory_order_release);
+        shard->data_ready.notify();
+    }
 
     std::unique_lock<std::mutex> lock(flush_mutex_);
-    flush_cv_.wait(lock, [this]() {
-        return !flush_requested_.load(std::memory_order_acquire);
-    });
+    flush_cv_.wait(lock, [this]() { return !flush_pending(); });
     lock.unlock();
 
     std::unique_lock<std::mutex> pending_lock(pending_mutex_);
@@ -135,188 +603,546 @@ void EventStreamProcessor::flush_now() {
     });
 }
 
-void EventStreamProcessor::consume_loop() {
-    last_flush_time_ = std::chrono::steady_clock::now();
+std::string EventStreamProcessor::serialize_sketches() {
+    std::string out;
+    ByteWriter writer(out);
+    writer.put_bytes(kSketchMagic, sizeof(kSketchMagic));
+    writer.put<std::uint16_t>(kSketchFormatVersion);
+    writer.put<std::uint16_t>(0);
 
-    while (running_.load(std::memory_order_acquire) || !buffer_.empty()) {
-        Event event;
-        if (buffer_.pop(event)) {
-            process_event(event);
-            total_processed_.fetch_add(1, std::memory_order_relaxed);
+    // too large for the stack
+    auto channels = std::make_unique<ChannelSketch>();
+    channels->merge(imported_channels_);
+    SlidingHyperLogLog users(kWindowSpanSeconds, kBucketSpanSeconds);
+    for (auto& shard : shards_) {
+        channels->merge(shard->channel_frequency);
+        std::lock_guard<std::mutex> lock(shard->stats_mutex);
+        users.merge(shard->unique_users);
+    }
+    channels->serialize(writer);
+    users.serialize(writer);
+    writer.put<std::uint64_t>(hashing::murmur3_64(out.data(), out.size(), hashing::kDefaultSeed));
+    return out;
+}
+
+void EventStreamProcessor::merge_from(std::string_view snapshot) {
+    if (snapshot.size() < kSketchHeaderSize + sizeof(std::uint64_t)) {
+        throw std::runtime_error("Sketch snapshot is truncated");
+    }
+    const auto body = snapshot.substr(0, snapshot.size() - sizeof(std::uint64_t));
+    ByteReader in(body);
+    if (in.get_bytes(sizeof(kSketchMagic)) != std::string_view(kSketchMagic, sizeof(kSketchMagic))) {
+        throw std::runtime_error("Not a sketch snapshot");
+    }
+    const auto version = in.get<std::uint16_t>();
+    if (version != kSketchFormatVersion) {
+        throw std::runtime_error("Unsupported sketch snapshot version: " + std::to_string(version));
+    }
+    in.get<std::uint16_t>();
+    ByteReader trailer(snapshot.substr(body.size()));
+    if (trailer.get<std::uint64_t>() != hashing::murmur3_64(body.data(), body.size(), hashing::kDefaultSeed)) {
+        throw std::runtime_error("Sketch snapshot checksum mismatch");
+    }
+
+    // decode everything before touching live state
+    auto channels = std::make_unique<ChannelSketch>();
+    channels->merge_serialized(in);
+    const auto users = SlidingHyperLogLog::deserialize(in);
+    if (in.remaining() != 0) {
+        throw std::runtime_error("Sketch snapshot has trailing bytes");
+    }
+
+    // Users are not partitioned across shards, so one shard holding the
+    // imported buckets is enough for every unique-user query.
+    Shard& shard = *shards_.front();
+    {
+        std::lock_guard<std::mutex> lock(shard.stats_mutex);
+        shard.unique_users.merge(users);
+        publish_snapshot(shard);
+    }
+    imported_channels_.merge(*channels);
+}
+
+void EventStreamProcessor::save_sketches(const std::string& path) {
+    const auto bytes = serialize_sketches();
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to open file for writing: " + temp_path);
+        }
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out.flush()) {
+            throw std::runtime_error("Failed to write sketch snapshot: " + temp_path);
+        }
+    }
+    // readers of `path` see either the old snapshot or the new one
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to replace sketch snapshot: " + path);
+    }
+}
+
+void EventStreamProcessor::load_sketches(const std::string& path) {
+    const MappedFile file(path);
+    merge_from(file.bytes());
+}
+
+bool EventStreamProcessor::flush_pending() const {
+    for (const auto& shard : shards_) {
+        if (shard->flush_requested.load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EventStreamProcessor::complete_flush_request(Shard& shard) {
+    shard.flush_requested.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(flush_mutex_);
+    flush_cv_.notify_all();
+}
+
+void EventStreamProcessor::consume_loop(Shard& shard) {
+    shard.last_flush_time = std::chrono::steady_clock::now();
+    std::uint64_t since_snapshot_check = 0;
+
+    // Drain at most what completes the pending batch, so flushed batches
+    // keep their batch_size_ shape.
+    std::vector<Event> drained(batch_size_);
+    std::size_t room = batch_size_;
+
+    while (running_.load(std::memory_order_acquire) || !shard.buffer.empty()) {
+        const std::size_t popped = shard.buffer.try_pop_bulk(drained.begin(), room);
+        if (popped != 0) {
+            if (overflow_policy_ != OverflowPolicy::Drop) {
+                shard.space_ready.notify();
+            }
+            std::size_t skip = 0;
+            if (overflow_policy_ == OverflowPolicy::OverwriteOldest) {
+                skip = take_overwrite_debt(shard, popped);
+                events_overwritten_.fetch_add(skip, std::memory_order_relaxed);
+            }
+            {
+                std::lock_guard<std::mutex> stats_lock(shard.stats_mutex);
+                for (std::size_t i = skip; i < popped; ++i) {
+                    process_event(shard, drained[i]);
+                }
+                since_snapshot_check += popped - skip;
+                if (since_snapshot_check >= kSnapshotCheckStride) {
+                    since_snapshot_check = 0;
+                    maybe_publish_snapshot(shard, false);
+                }
+            }
+            total_processed_.fetch_add(popped - skip, std::memory_order_relaxed);
 
             bool reached_batch = false;
             {
-                std::lock_guard<std::mutex> lock(batch_mutex_);
-                pending_batch_.push_back(std::move(event));
-                reached_batch = pending_batch_.size() >= batch_size_;
+                std::lock_guard<std::mutex> lock(shard.batch_mutex);
+                shard.pending_batch.insert(shard.pending_batch.end(),
+                                           drained.begin() + static_cast<std::ptrdiff_t>(skip),
+                                           drained.begin() + static_cast<std::ptrdiff_t>(popped));
+                reached_batch = shard.pending_batch.size() >= batch_size_;
+                room = reached_batch ? batch_size_ : batch_size_ - shard.pending_batch.size();
             }
 
             if (reached_batch) {
                 std::vector<Event> batch;
                 {
-                    std::lock_guard<std::mutex> lock(batch_mutex_);
-                    batch.swap(pending_batch_);
+                    std::lock_guard<std::mutex> lock(shard.batch_mutex);
+                    batch.swap(shard.pending_batch);
                 }
-                flush_batch(batch);
-                last_flush_time_ = std::chrono::steady_clock::now();
+                flush_batch(shard, batch);
+                shard.last_flush_time = std::chrono::steady_clock::now();
                 notify_idle_state();
             }
             continue;
         }
 
+        if (spin_for_data(shard)) {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> stats_lock(shard.stats_mutex);
+            maybe_publish_snapshot(shard, true);
+        }
+
         const auto now = std::chrono::steady_clock::now();
         bool should_flush = false;
         {
-            std::lock_guard<std::mutex> lock(batch_mutex_);
-            should_flush = !pending_batch_.empty() &&
-                           (now - last_flush_time_ >= flush_interval_);
+            std::lock_guard<std::mutex> lock(shard.batch_mutex);
+            should_flush = !shard.pending_batch.empty() &&
+                           (now - shard.last_flush_time >= flush_interval_);
         }
 
-        if (should_flush || flush_requested_.load(std::memory_order_acquire)) {
+        if (should_flush || shard.flush_requested.load(std::memory_order_acquire)) {
             std::vector<Event> batch;
             {
-                std::lock_guard<std::mutex> lock(batch_mutex_);
-                batch.swap(pending_batch_);
+                std::lock_guard<std::mutex> lock(shard.batch_mutex);
+                batch.swap(shard.pending_batch);
             }
             if (!batch.empty()) {
-                flush_batch(batch);
-            }
-            last_flush_time_ = std::chrono::steady_clock::now();
-            flush_requested_.store(false, std::memory_order_release);
-            {
-                std::lock_guard<std::mutex> lock(flush_mutex_);
-                flush_cv_.notify_all();
+                flush_batch(shard, batch);
             }
+            room = batch_size_;
+            shard.last_flush_time = std::chrono::steady_clock::now();
+            complete_flush_request(shard);
             notify_idle_state();
             continue;
         }
 
-        std::unique_lock<std::mutex> lock(data_mutex_);
-        data_cv_.wait_for(lock, std::chrono::milliseconds(5), [this]() {
-            return !running_.load(std::memory_order_acquire) ||
-                   !buffer_.empty() ||
-                   flush_requested_.load(std::memory_order_acquire);
-        });
-        lock.unlock();
+        park_consumer(shard);
         notify_idle_state();
     }
 
     // drain remaining events
     std::vector<Event> remaining;
     {
-        std::lock_guard<std::mutex> lock(batch_mutex_);
-        remaining.swap(pending_batch_);
+        std::lock_guard<std::mutex> lock(shard.batch_mutex);
+        remaining.swap(shard.pending_batch);
     }
     if (!remaining.empty()) {
-        flush_batch(remaining);
+        flush_batch(shard, remaining);
     }
-    flush_requested_.store(false, std::memory_order_release);
     {
-        std::lock_guard<std::mutex> lock(flush_mutex_);
-        flush_cv_.notify_all();
+        std::lock_guard<std::mutex> stats_lock(shard.stats_mutex);
+        maybe_publish_snapshot(shard, true);
     }
+    complete_flush_request(shard);
     notify_idle_state();
 }
 
-void EventStreamProcessor::process_event(const Event& event) {
-    const auto bucket = bucket_start(event.timestamp);
-    const auto cutoff = bucket - kWindowSpanSeconds;
+// Busy-polls briefly so a steady stream never pays for a park/unpark.
+// Returns true once data arrives; a flush request ends the spin early.
+bool EventStreamProcessor::spin_for_data(Shard& shard) const {
+    for (int spin = 0; spin < kConsumerSpinIterations; ++spin) {
+        if (!shard.buffer.empty()) {
+            return true;
+        }
+        if (shard.flush_requested.load(std::memory_order_acquire)) {
+            return false;
+        }
+        cpu_relax();
+    }
+    return false;
+}
 
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    channel_frequency_.increment(event.channel_id);
-    channel_counts_[event.channel_id] += 1;
+// Sleeps until a producer signals data_ready, a flush is requested, or the
+// pending batch is due by flush_interval_.
+void EventStreamProcessor::park_consumer(Shard& shard) {
+    auto deadline = std::chrono::steady_clock::now() + kIdleParkTimeout;
+    {
+        std::lock_guard<std::mutex> lock(shard.batch_mutex);
+        if (!shard.pending_batch.empty()) {
+            deadline = std::min(deadline, shard.last_flush_time + flush_interval_);
+        }
+    }
 
-    // maintain time windows for unique user estimation
-    while (!windows_.empty() && windows_.front().window_start < cutoff) {
-        windows_.pop_front();
+    const auto key = shard.data_ready.prepare_wait();
+    if (!running_.load(std::memory_order_acquire) ||
+        !shard.buffer.empty() ||
+        shard.flush_requested.load(std::memory_order_acquire)) {
+        shard.data_ready.cancel_wait();
+        return;
     }
+    const auto parked_at = std::chrono::steady_clock::now();
+    shard.data_ready.wait_until(key, deadline);
+    shard.parked_ns.fetch_add(static_cast<std::uint64_t>(
+                                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - parked_at)
+                                      .count()),
+                              std::memory_order_relaxed);
+}
 
-    auto it = std::find_if(windows_.begin(), windows_.end(), [&](const HyperLogLogWindow& window) {
-        return window.window_start == bucket;
-    });
-    if (it == windows_.end()) {
-        HyperLogLogWindow window{bucket, HyperLogLog()};
-        window.sketch.add(event.user_id);
-        windows_.push_back(std::move(window));
-        std::sort(windows_.begin(), windows_.end(), [](const HyperLogLogWindow& lhs, const HyperLogLogWindow& rhs) {
-            return lhs.window_start < rhs.window_start;
-        });
-    } else {
-        it->sketch.add(event.user_id);
+void EventStreamProcessor::process_event(Shard& shard, const Event& event) {
+    const auto timestamp = event.timestamp > 0 ? event.timestamp : now_seconds();
+
+    shard.stats_dirty = true;
+    shard.channel_frequency.increment_hash(strings_->hash_of(event.channel_id));
+    shard.top_channels.offer(event.channel_id);
+    const auto user_hash = strings_->hash_of(event.user_id);
+    shard.unique_users.add_hash(user_hash, timestamp);
+    if (track_dimensions_) {
+        shard.users_by_channel.add_hash(event.channel_id, user_hash, timestamp);
+        shard.users_by_event_type.add_hash(event.event_type, user_hash, timestamp);
+    }
+}
+
+void EventStreamProcessor::publish_snapshot(Shard& shard) {
+    const auto now = now_seconds();
+    auto snapshot = std::make_shared<StatsSnapshot>();
+    snapshot->epoch = ++shard.snapshot_epoch;
+    snapshot->taken_at = now;
+    snapshot->users = shard.unique_users.window_union(now);
+    snapshot->unique_users = shard.unique_users.cardinality(now);
+    snapshot->top_channels = shard.top_channels.top_k(shard.top_channels.capacity());
+    snapshot->channel_error_bound = shard.top_channels.error_bound();
+
+    std::atomic_store_explicit(&shard.snapshot,
+                               std::shared_ptr<const StatsSnapshot>(std::move(snapshot)),
+                               std::memory_order_release);
+    shard.stats_dirty = false;
+    shard.snapshot_bucket = now / kBucketSpanSeconds;
+    shard.last_publish = std::chrono::steady_clock::now();
+}
+
+void EventStreamProcessor::maybe_publish_snapshot(Shard& shard, bool idle) {
+    if (idle) {
+        // an idle shard still republishes when the window slides past a bucket
+        if (shard.stats_dirty || now_seconds() / kBucketSpanSeconds != shard.snapshot_bucket) {
+            publish_snapshot(shard);
+        }
+        return;
+    }
+    if (shard.stats_dirty && std::chrono::steady_clock::now() - shard.last_publish >= kSnapshotInterval) {
+        publish_snapshot(shard);
     }
 }
 
-void EventStreamProcessor::flush_batch(std::vector<Event>& batch) {
+std::shared_ptr<const EventStreamProcessor::StatsSnapshot>
+EventStreamProcessor::load_snapshot(const Shard& shard) const {
+    return std::atomic_load_explicit(&shard.snapshot, std::memory_order_acquire);
+}
+
+void EventStreamProcessor::flush_batch(Shard& shard, std::vector<Event>& batch) {
     if (batch.empty()) {
         return;
     }
 
-    std::function<void(std::vector<Event>)> callback;
+    std::shared_ptr<const std::function<void(EventBatch)>> callback;
     {
         std::lock_guard<std::mutex> lock(callback_mutex_);
         callback = flush_callback_;
     }
 
     if (!callback) {
-        std::lock_guard<std::mutex> lock(batch_mutex_);
-        pending_batch_.insert(pending_batch_.end(),
-                              std::make_move_iterator(batch.begin()),
-                              std::make_move_iterator(batch.end()));
+        if (spill(kSpillDelivery, batch.data(), batch.size())) {
+            batch.clear();
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shard.batch_mutex);
+        shard.pending_batch.insert(shard.pending_batch.end(),
+                                   std::make_move_iterator(batch.begin()),
+                                   std::make_move_iterator(batch.end()));
         batch.clear();
         return;
     }
 
-    auto payload_data = std::make_shared<std::vector<Event>>(std::move(batch));
+    record_enqueue_latency(batch);
+    batches_flushed_.fetch_add(1, std::memory_order_relaxed);
+    pending_flush_tasks_.fetch_add(1, std::memory_order_acq_rel);
+    // The events move straight into the task's inline storage and only get
+    // wrapped in an EventBatch on the worker; the pool counts a throwing
+    // callback as a failed task. With a journal the worker holds a second
+    // reference to the batch's events, so a failed batch can be spilled for
+    // retry without copying every delivery.
+    Task deliver([this, callback = std::move(callback), events = std::move(batch),
+                  handed_off = std::chrono::steady_clock::now()]() mutable {
+        const bool timed = metrics_mode_.load(std::memory_order_relaxed) != MetricsMode::Off;
+        const auto started = std::chrono::steady_clock::now();
+        if (timed) {
+            flush_queue_wait_.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(started - handed_off).count()));
+        }
+        EventBatch delivered(std::move(events), strings_);
+        const EventBatch retry = load_journal() ? delivered : EventBatch();
+        try {
+            (*callback)(std::move(delivered));
+        } catch (...) {
+            if (timed) {
+                callback_duration_.record(elapsed_us(started));
+            }
+            spill(kSpillDelivery, retry.events().data(), retry.size());
+            finish_flush_task();
+            throw;
+        }
+        if (timed) {
+            callback_duration_.record(elapsed_us(started));
+        }
+        // a delivery that went through is the cue that the callback recovered
+        schedule_replay();
+        finish_flush_task();
+    });
     batch.clear();
 
+    try {
+        thread_pool_.enqueue(std::move(deliver));
+    } catch (const std::runtime_error&) {
+        deliver();
+    }
+}
+
+void EventStreamProcessor::enable_spill_journal(const std::string& directory,
+                                                std::size_t segment_bytes,
+                                                std::size_t sync_interval_ms) {
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if (load_journal()) {
+            throw std::runtime_error("Spill journal is already enabled");
+        }
+        auto journal = std::make_shared<SpillJournal>(directory, segment_bytes,
+                                                      std::chrono::milliseconds(sync_interval_ms));
+        std::atomic_store_explicit(&journal_, std::move(journal), std::memory_order_release);
+    }
+    // records recovered from an earlier run
+    schedule_replay();
+}
+
+std::size_t EventStreamProcessor::spilled_pending() const {
+    const auto journal = load_journal();
+    return journal ? journal->pending_records() : 0;
+}
+
+std::shared_ptr<SpillJournal> EventStreamProcessor::load_journal() const {
+    return std::atomic_load_explicit(&journal_, std::memory_order_acquire);
+}
+
+// Appends [first, first + count) to the journal under `tag`. Returns false,
+// leaving the events to the caller, when there is no journal or it cannot
+// be written.
+bool EventStreamProcessor::spill(std::uint8_t tag, const Event* first, std::size_t count) noexcept {
+    const auto journal = load_journal();
+    if (!journal || count == 0) {
+        return false;
+    }
+    try {
+        journal->append(tag, encode_spill(*strings_, first, count));
+    } catch (const std::exception&) {
+        return false;
+    }
+    events_spilled_.fetch_add(count, std::memory_order_relaxed);
+    return true;
+}
+
+// Queues one replay pass on the pool unless one is queued already. It
+// counts as a flush task, so flush_now() waits for it.
+void EventStreamProcessor::schedule_replay() {
+    const auto journal = load_journal();
+    if (!journal || journal->pending_records() == 0 || !running_.load(std::memory_order_acquire) ||
+        replay_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
     pending_flush_tasks_.fetch_add(1, std::memory_order_acq_rel);
     try {
-        thread_pool_.enqueue([this, callback, payload_data]() mutable {
-            auto payload = std::move(*payload_data);
-            payload_data->clear();
-            try {
-                callback(std::move(payload));
-            } catch (...) {
-                pending_flush_tasks_.fetch_sub(1, std::memory_order_acq_rel);
-                pending_cv_.notify_all();
-                notify_idle_state();
-                throw;
+        thread_pool_.enqueue(Task([this]() {
+            replay_spilled();
+            replay_scheduled_.store(false, std::memory_order_release);
+            finish_flush_task();
+        }));
+    } catch (const std::runtime_error&) {
+        replay_scheduled_.store(false, std::memory_order_release);
+        finish_flush_task();
+    }
+}
+
+// Replays journal records oldest first until the journal is empty, the
+// callback fails or is missing, or the rings fill up. Records spilled
+// during the pass wait for the next one, so a failing callback cannot keep
+// a worker busy.
+void EventStreamProcessor::replay_spilled() {
+    const auto journal = load_journal();
+    for (auto budget = journal->pending_records(); budget != 0 && running_.load(std::memory_order_acquire);
+         --budget) {
+        auto record = journal->peek();
+        if (!record) {
+            return;
+        }
+        std::vector<Event> events;
+        try {
+            events = decode_spill(*strings_, record->payload);
+        } catch (const std::runtime_error&) {
+            // checksummed, so only a foreign writer gets here; skip the record
+            journal->acknowledge(*record);
+            continue;
+        }
+        const std::size_t count = events.size();
+
+        if (record->tag == kSpillOverflow) {
+            const bool complete = replay_ingest(events);
+            journal->acknowledge(*record);
+            events_replayed_.fetch_add(count - events.size(), std::memory_order_relaxed);
+            if (!complete) {
+                return;
             }
-            pending_flush_tasks_.fetch_sub(1, std::memory_order_acq_rel);
-            pending_cv_.notify_all();
-            notify_idle_state();
-        });
-    } catch (...) {
-        auto payload = std::move(*payload_data);
-        payload_data->clear();
+            continue;
+        }
+
+        // the stages saw this batch before its callback failed
+        std::shared_ptr<const std::function<void(EventBatch)>> callback;
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            callback = user_callback_;
+        }
+        if (!callback) {
+            return;
+        }
         try {
-            callback(std::move(payload));
+            (*callback)(EventBatch(std::move(events), strings_));
         } catch (...) {
-            pending_flush_tasks_.fetch_sub(1, std::memory_order_acq_rel);
-            pending_cv_.notify_all();
-            notify_idle_state();
-            throw;
+            return;
         }
-        pending_flush_tasks_.fetch_sub(1, std::memory_order_acq_rel);
-        pending_cv_.notify_all();
-        notify_idle_state();
+        journal->acknowledge(*record);
+        batches_flushed_.fetch_add(1, std::memory_order_relaxed);
+        events_replayed_.fetch_add(count, std::memory_order_relaxed);
     }
 }
 
-void EventStreamProcessor::notify_idle_state() {
-    if (!buffer_.empty()) {
-        drained_.store(false, std::memory_order_release);
-        return;
+// Pushes replayed overflow events into their shards without blocking.
+// Whatever still does not fit is spilled again and left in `events`;
+// returns true if everything went in.
+bool EventStreamProcessor::replay_ingest(std::vector<Event>& events) {
+    std::vector<std::vector<Event>> routed(shards_.size());
+    for (const auto& event : events) {
+        routed[shard_index(event.channel_id)].push_back(event);
     }
-
-    bool batch_empty = false;
-    {
-        std::lock_guard<std::mutex> batch_lock(batch_mutex_);
-        batch_empty = pending_batch_.empty();
+    std::vector<Event> rest;
+    for (std::size_t i = 0; i < routed.size(); ++i) {
+        auto& part = routed[i];
+        if (part.empty()) {
+            continue;
+        }
+        Shard& shard = *shards_[i];
+        const std::size_t accepted = shard.buffer.try_push_bulk(part.begin(), part.size());
+        if (accepted != 0) {
+            signal_data(shard);
+        }
+        rest.insert(rest.end(), part.begin() + static_cast<std::ptrdiff_t>(accepted), part.end());
     }
-    if (!batch_empty) {
-        drained_.store(false, std::memory_order_release);
-        return;
+    if (!rest.empty()) {
+        if (spill(kSpillOverflow, rest.data(), rest.size())) {
+            // already counted when first spilled
+            events_spilled_.fetch_sub(rest.size(), std::memory_order_relaxed);
+        } else {
+            events_dropped_.fetch_add(rest.size(), std::memory_order_relaxed);
+        }
+    }
+    events.swap(rest);
+    return events.empty();
+}
+
+void EventStreamProcessor::finish_flush_task() {
+    pending_flush_tasks_.fetch_sub(1, std::memory_order_acq_rel);
+    pending_cv_.notify_all();
+    notify_idle_state();
+}
+
+void EventStreamProcessor::notify_idle_state() {
+    for (auto& shard : shards_) {
+        if (!shard->buffer.empty()) {
+            drained_.store(false, std::memory_order_release);
+            return;
+        }
+
+        bool batch_empty = false;
+        {
+            std::lock_guard<std::mutex> batch_lock(shard->batch_mutex);
+            batch_empty = shard->pending_batch.empty();
+        }
+        if (!batch_empty) {
+            drained_.store(false, std::memory_order_release);
+            return;
+        }
     }
 
     if (pending_flush_tasks_.load(std::memory_order_acquire) != 0) {
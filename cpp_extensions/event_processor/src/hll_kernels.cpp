@@ -0,0 +1,151 @@
+#include "hll_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace engagehub {
+namespace hll_kernels {
+namespace {
+
+std::array<double, kMaxRank + 1> make_inverse_powers() {
+    std::array<double, kMaxRank + 1> table{};
+    double value = 1.0;
+    for (auto& entry : table) {
+        entry = value;
+        value *= 0.5;
+    }
+    return table;
+}
+
+const std::array<double, kMaxRank + 1> kInversePowers = make_inverse_powers();
+
+} // namespace
+
+const double* inverse_powers() noexcept {
+    return kInversePowers.data();
+}
+
+void max_registers_scalar(std::uint8_t* dst, const std::uint8_t* src, std::size_t count) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = std::max(dst[i], src[i]);
+    }
+}
+
+RegisterSum sum_registers_scalar(const std::uint8_t* registers, std::size_t count) noexcept {
+    RegisterSum result;
+    for (std::size_t i = 0; i < count; ++i) {
+        result.inverse_sum += kInversePowers[registers[i]];
+        result.zeros += registers[i] == 0 ? 1 : 0;
+    }
+    return result;
+}
+
+#if defined(__AVX2__)
+
+void max_registers(std::uint8_t* dst, const std::uint8_t* src, std::size_t count) noexcept {
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(a, b));
+    }
+    max_registers_scalar(dst + i, src + i, count - i);
+}
+
+// 2^-r is built directly as a double whose exponent field is 1023 - r, which
+// is the inverse-power table evaluated four lanes at a time.
+RegisterSum sum_registers(const std::uint8_t* registers, std::size_t count) noexcept {
+    const __m256i bias = _mm256_set1_epi64x(1023);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    std::size_t zeros = 0;
+
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(registers + i));
+        const auto zero_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zero)));
+        zeros += static_cast<std::size_t>(__builtin_popcount(zero_mask));
+
+        const __m128i halves[2] = {_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1)};
+        for (const __m128i& half : halves) {
+            const __m128i quarters[4] = {half, _mm_srli_si128(half, 4), _mm_srli_si128(half, 8),
+                                         _mm_srli_si128(half, 12)};
+            for (int q = 0; q < 4; ++q) {
+                const __m256i ranks = _mm256_cvtepu8_epi64(quarters[q]);
+                const __m256i bits = _mm256_slli_epi64(_mm256_sub_epi64(bias, ranks), 52);
+                acc[q] = _mm256_add_pd(acc[q], _mm256_castsi256_pd(bits));
+            }
+        }
+    }
+
+    const __m256d total = _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3]));
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, total);
+
+    RegisterSum tail = sum_registers_scalar(registers + i, count - i);
+    tail.inverse_sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    tail.zeros += zeros;
+    return tail;
+}
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+
+void max_registers(std::uint8_t* dst, const std::uint8_t* src, std::size_t count) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+    }
+    max_registers_scalar(dst + i, src + i, count - i);
+}
+
+RegisterSum sum_registers(const std::uint8_t* registers, std::size_t count) noexcept {
+    const int64x2_t bias = vdupq_n_s64(1023);
+    float64x2_t acc[2] = {vdupq_n_f64(0.0), vdupq_n_f64(0.0)};
+    std::size_t zeros = 0;
+
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(registers + i);
+        // each zero register becomes 1 in the mask; vaddvq sums the lanes
+        zeros += vaddvq_u8(vandq_u8(vceqzq_u8(bytes), vdupq_n_u8(1)));
+
+        const uint16x8_t words[2] = {vmovl_u8(vget_low_u8(bytes)), vmovl_high_u8(bytes)};
+        for (const uint16x8_t& word : words) {
+            const uint32x4_t dwords[2] = {vmovl_u16(vget_low_u16(word)), vmovl_high_u16(word)};
+            for (const uint32x4_t& dword : dwords) {
+                const int64x2_t ranks[2] = {vreinterpretq_s64_u64(vmovl_u32(vget_low_u32(dword))),
+                                            vreinterpretq_s64_u64(vmovl_high_u32(dword))};
+                for (int q = 0; q < 2; ++q) {
+                    const int64x2_t bits = vshlq_n_s64(vsubq_s64(bias, ranks[q]), 52);
+                    acc[q] = vaddq_f64(acc[q], vreinterpretq_f64_s64(bits));
+                }
+            }
+        }
+    }
+
+    RegisterSum tail = sum_registers_scalar(registers + i, count - i);
+    tail.inverse_sum += vaddvq_f64(vaddq_f64(acc[0], acc[1]));
+    tail.zeros += zeros;
+    return tail;
+}
+
+#else
+
+void max_registers(std::uint8_t* dst, const std::uint8_t* src, std::size_t count) noexcept {
+    max_registers_scalar(dst, src, count);
+}
+
+RegisterSum sum_registers(const std::uint8_t* registers, std::size_t count) noexcept {
+    return sum_registers_scalar(registers, count);
+}
+
+#endif
+
+} // namespace hll_kernels
+} // namespace engagehub
@@ -1,5 +1,9 @@
 #include "hyperloglog.hpp"
 
+#include "byte_io.hpp"
+#include "hashing.hpp"
+#include "hll_kernels.hpp"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
@@ -7,136 +11,200 @@
 #include <stdexcept>
 
 namespace engagehub {
-namespace {
-
-std::uint64_t rotl64(std::uint64_t x, int8_t r) {
-    return (x << r) | (x >> (64 - r));
-}
-
-std::uint64_t fmix64(std::uint64_t k) {
-    k ^= k >> 33;
-    k *= 0xff51afd7ed558ccdULL;
-    k ^= k >> 33;
-    k *= 0xc4ceb9fe1a85ec53ULL;
-    k ^= k >> 33;
-    return k;
-}
-
-std::uint64_t murmurhash3_64(const void* key, std::size_t len, std::uint64_t seed) {
-    const std::uint8_t* data = static_cast<const std::uint8_t*>(key);
-    const int nblocks = static_cast<int>(len / 16);
-
-    std::uint64_t h1 = seed;
-    std::uint64_t h2 = seed;
-
-    constexpr std::uint64_t c1 = 0x87c37b91114253d5ULL;
-    constexpr std::uint64_t c2 = 0x4cf5ad432745937fULL;
-
-    const std::uint64_t* blocks = reinterpret_cast<const std::uint64_t*>(data);
-    for (int i = 0; i < nblocks; ++i) {
-        std::uint64_t k1 = blocks[i * 2 + 0];
-        std::uint64_t k2 = blocks[i * 2 + 1];
-
-        k1 *= c1;
-        k1 = rotl64(k1, 31);
-        k1 *= c2;
-        h1 ^= k1;
-        h1 = rotl64(h1, 27);
-        h1 += h2;
-        h1 = h1 * 5 + 0x52dce729;
-
-        k2 *= c2;
-        k2 = rotl64(k2, 33);
-        k2 *= c1;
-        h2 ^= k2;
-        h2 = rotl64(h2, 31);
-        h2 += h1;
-        h2 = h2 * 5 + 0x38495ab5;
-    }
-
-    const std::uint8_t* tail = data + nblocks * 16;
-    std::uint64_t k1 = 0;
-    std::uint64_t k2 = 0;
-
-    switch (len & 15) {
-        case 15: k2 ^= static_cast<std::uint64_t>(tail[14]) << 48; [[fallthrough]];
-        case 14: k2 ^= static_cast<std::uint64_t>(tail[13]) << 40; [[fallthrough]];
-        case 13: k2 ^= static_cast<std::uint64_t>(tail[12]) << 32; [[fallthrough]];
-        case 12: k2 ^= static_cast<std::uint64_t>(tail[11]) << 24; [[fallthrough]];
-        case 11: k2 ^= static_cast<std::uint64_t>(tail[10]) << 16; [[fallthrough]];
-        case 10: k2 ^= static_cast<std::uint64_t>(tail[9]) << 8; [[fallthrough]];
-        case 9:  k2 ^= static_cast<std::uint64_t>(tail[8]) << 0;
-                 k2 *= c2;
-                 k2 = rotl64(k2, 33);
-                 k2 *= c1;
-                 h2 ^= k2;
-                 [[fallthrough]];
-        case 8:  k1 ^= static_cast<std::uint64_t>(tail[7]) << 56; [[fallthrough]];
-        case 7:  k1 ^= static_cast<std::uint64_t>(tail[6]) << 48; [[fallthrough]];
-        case 6:  k1 ^= static_cast<std::uint64_t>(tail[5]) << 40; [[fallthrough]];
-        case 5:  k1 ^= static_cast<std::uint64_t>(tail[4]) << 32; [[fallthrough]];
-        case 4:  k1 ^= static_cast<std::uint64_t>(tail[3]) << 24; [[fallthrough]];
-        case 3:  k1 ^= static_cast<std::uint64_t>(tail[2]) << 16; [[fallthrough]];
-        case 2:  k1 ^= static_cast<std::uint64_t>(tail[1]) << 8;  [[fallthrough]];
-        case 1:  k1 ^= static_cast<std::uint64_t>(tail[0]) << 0;
-                 k1 *= c1;
-                 k1 = rotl64(k1, 31);
-                 k1 *= c2;
-                 h1 ^= k1;
-                 break;
-        default:;
-    }
-
-    h1 ^= static_cast<std::uint64_t>(len);
-    h2 ^= static_cast<std::uint64_t>(len);
-
-    h1 += h2;
-    h2 += h1;
-
-    h1 = fmix64(h1);
-    h2 = fmix64(h2);
-
-    h1 += h2;
-    return h1;
-}
-
-} // namespace
-
 HyperLogLog::HyperLogLog(std::uint8_t precision)
     : precision_(precision),
       register_count_(1ULL << precision),
-      registers_(register_count_, 0) {
+      sparse_limit_(std::max<std::size_t>(register_count_ / 16, 1)) {
     if (precision_ < 4 || precision_ > 18) {
         throw std::invalid_argument("HyperLogLog precision must be between 4 and 18");
     }
 }
 
-void HyperLogLog::add(const std::string& value) {
-    const auto hash = murmurhash3_64(value.data(), value.size(), 0xadc83b19ULL);
+std::uint64_t HyperLogLog::hash(std::string_view value) {
+    return hashing::hash64(value);
+}
+
+bool HyperLogLog::add(std::string_view value) {
+    return add_hash(hash(value));
+}
+
+bool HyperLogLog::add_hash(std::uint64_t hash) {
     const std::size_t index = hash >> (64 - precision_);
     const std::uint64_t remaining = (hash << precision_);
     const std::uint8_t rank = rho(remaining, static_cast<std::uint8_t>(64 - precision_));
-    registers_[index] = std::max(registers_[index], rank);
+    if (is_sparse()) {
+        return set_sparse(index, rank);
+    }
+    if (rank <= registers_[index]) {
+        return false;
+    }
+    registers_[index] = rank;
+    return true;
+}
+
+bool HyperLogLog::set_sparse(std::size_t index, std::uint8_t rank) {
+    const auto key = static_cast<std::uint32_t>(index << kRankBits);
+    auto it = std::lower_bound(sparse_.begin(), sparse_.end(), key);
+    if (it != sparse_.end() && (*it >> kRankBits) == index) {
+        if (rank <= (*it & 0xFFU)) {
+            return false;
+        }
+        *it = key | rank;
+        return true;
+    }
+    sparse_.insert(it, key | rank);
+    if (sparse_.size() > sparse_limit_) {
+        promote();
+    }
+    return true;
 }
 
 void HyperLogLog::merge(const HyperLogLog& other) {
     if (other.precision_ != precision_) {
         throw std::invalid_argument("Cannot merge HyperLogLog with different precision");
     }
-    for (std::size_t i = 0; i < register_count_; ++i) {
-        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    if (other.is_sparse()) {
+        if (is_sparse()) {
+            merge_sparse(other.sparse_);
+        } else {
+            for (const std::uint32_t entry : other.sparse_) {
+                auto& reg = registers_[entry >> kRankBits];
+                reg = std::max(reg, static_cast<std::uint8_t>(entry & 0xFFU));
+            }
+        }
+        return;
+    }
+    if (is_sparse()) {
+        promote();
+    }
+    hll_kernels::max_registers(registers_.data(), other.registers_.data(), register_count_);
+}
+
+void HyperLogLog::merge_sparse(const std::vector<std::uint32_t>& other) {
+    std::vector<std::uint32_t> merged;
+    merged.reserve(sparse_.size() + other.size());
+    auto lhs = sparse_.begin();
+    auto rhs = other.begin();
+    while (lhs != sparse_.end() && rhs != other.end()) {
+        const auto lhs_index = *lhs >> kRankBits;
+        const auto rhs_index = *rhs >> kRankBits;
+        if (lhs_index == rhs_index) {
+            // same index, so the larger entry has the larger rank
+            merged.push_back(std::max(*lhs++, *rhs++));
+        } else if (lhs_index < rhs_index) {
+            merged.push_back(*lhs++);
+        } else {
+            merged.push_back(*rhs++);
+        }
+    }
+    merged.insert(merged.end(), lhs, sparse_.end());
+    merged.insert(merged.end(), rhs, other.end());
+    sparse_ = std::move(merged);
+    if (sparse_.size() > sparse_limit_) {
+        promote();
+    }
+}
+
+void HyperLogLog::promote() {
+    registers_.assign(register_count_, 0);
+    for (const std::uint32_t entry : sparse_) {
+        registers_[entry >> kRankBits] = static_cast<std::uint8_t>(entry & 0xFFU);
+    }
+    sparse_.clear();
+    sparse_.shrink_to_fit();
+}
+
+void HyperLogLog::clear() {
+    // back to sparse, so a recycled bucket gives its dense array back
+    registers_.clear();
+    registers_.shrink_to_fit();
+    sparse_.clear();
+}
+
+std::size_t HyperLogLog::memory_bytes() const noexcept {
+    return registers_.capacity() + sparse_.capacity() * sizeof(std::uint32_t);
+}
+
+void HyperLogLog::serialize(ByteWriter& out) const {
+    out.put<std::uint8_t>(precision_);
+    if (is_sparse()) {
+        out.put<std::uint8_t>(kSparseForm);
+        out.put_varint(sparse_.size());
+        // entries are sorted by index, so the deltas stay small
+        std::uint32_t previous = 0;
+        for (const std::uint32_t entry : sparse_) {
+            out.put_varint(entry - previous);
+            previous = entry;
+        }
+        return;
     }
+    out.put<std::uint8_t>(kDenseForm);
+    out.put_bytes(registers_.data(), registers_.size());
+}
+
+HyperLogLog HyperLogLog::deserialize(ByteReader& in) {
+    const auto precision = in.get<std::uint8_t>();
+    if (precision < 4 || precision > 18) {
+        throw std::runtime_error("serialized HyperLogLog has an invalid precision");
+    }
+    HyperLogLog sketch(precision);
+    const auto max_rank = static_cast<std::uint8_t>(64 - precision + 1);
+    const auto form = in.get<std::uint8_t>();
+
+    if (form == kSparseForm) {
+        const auto count = in.get_varint();
+        if (count > sketch.register_count_) {
+            throw std::runtime_error("serialized HyperLogLog has too many sparse entries");
+        }
+        sketch.sparse_.reserve(static_cast<std::size_t>(count));
+        std::uint64_t entry = 0;
+        for (std::uint64_t i = 0; i < count; ++i) {
+            const auto previous_index = entry >> kRankBits;
+            entry += in.get_varint();
+            const auto index = entry >> kRankBits;
+            const auto rank = entry & 0xFFU;
+            // indices must be strictly increasing and every rank in range
+            if ((i != 0 && index <= previous_index) || index >= sketch.register_count_ ||
+                rank == 0 || rank > max_rank) {
+                throw std::runtime_error("serialized HyperLogLog has a malformed sparse entry");
+            }
+            sketch.sparse_.push_back(static_cast<std::uint32_t>(entry));
+        }
+        if (sketch.sparse_.size() > sketch.sparse_limit_) {
+            sketch.promote();
+        }
+        return sketch;
+    }
+
+    if (form != kDenseForm) {
+        throw std::runtime_error("serialized HyperLogLog has an unknown register form");
+    }
+    const auto bytes = in.get_bytes(sketch.register_count_);
+    sketch.registers_.assign(bytes.begin(), bytes.end());
+    for (const std::uint8_t rank : sketch.registers_) {
+        if (rank > max_rank) {
+            throw std::runtime_error("serialized HyperLogLog has an out-of-range register");
+        }
+    }
+    return sketch;
 }
 
 std::uint64_t HyperLogLog::cardinality() const {
     const double alpha_m = alpha(register_count_);
-    double sum = 0.0;
-    for (std::uint8_t reg : registers_) {
-        sum += std::pow(2.0, -static_cast<int>(reg));
+    hll_kernels::RegisterSum sums;
+    if (is_sparse()) {
+        const double* inverse = hll_kernels::inverse_powers();
+        sums.zeros = register_count_ - sparse_.size();
+        sums.inverse_sum = static_cast<double>(sums.zeros);
+        for (const std::uint32_t entry : sparse_) {
+            sums.inverse_sum += inverse[entry & 0xFFU];
+        }
+    } else {
+        sums = hll_kernels::sum_registers(registers_.data(), register_count_);
     }
 
-    double estimate = alpha_m * register_count_ * register_count_ / sum;
-    const std::size_t zeros = static_cast<std::size_t>(std::count(registers_.begin(), registers_.end(), 0));
+    double estimate = alpha_m * register_count_ * register_count_ / sums.inverse_sum;
+    const std::size_t zeros = sums.zeros;
 
     if (estimate <= 5.0 * register_count_) {
         if (zeros != 0) {
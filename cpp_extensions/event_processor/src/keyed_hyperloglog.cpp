@@ -0,0 +1,91 @@
+#include "keyed_hyperloglog.hpp"
+
+#include <stdexcept>
+
+namespace engagehub {
+
+namespace {
+// hash-map node and recency-list node around each Entry
+constexpr std::size_t kNodeOverhead = 4 * sizeof(void*) + sizeof(std::uint32_t);
+} // namespace
+
+KeyedSlidingHyperLogLog::KeyedSlidingHyperLogLog(std::size_t memory_budget_bytes,
+                                                 std::int64_t window_seconds,
+                                                 std::int64_t bucket_seconds,
+                                                 std::uint8_t precision)
+    : memory_budget_(memory_budget_bytes),
+      window_seconds_(window_seconds),
+      bucket_seconds_(bucket_seconds),
+      precision_(precision) {
+    // fail here rather than on the first event
+    SlidingHyperLogLog probe(window_seconds_, bucket_seconds_, precision_, false);
+}
+
+std::size_t KeyedSlidingHyperLogLog::footprint(const SlidingHyperLogLog& sketch) noexcept {
+    return sizeof(Entry) + kNodeOverhead + sketch.memory_bytes();
+}
+
+void KeyedSlidingHyperLogLog::add_hash(std::uint32_t key, std::uint64_t hash, std::int64_t timestamp) {
+    Entry& entry = touch(key);
+    if (!entry.sketch.add_hash(hash, timestamp)) {
+        return;
+    }
+    // only a raised register can grow a sparse list or promote a bucket
+    const std::size_t bytes = footprint(entry.sketch);
+    memory_bytes_ += bytes;
+    memory_bytes_ -= entry.bytes;
+    entry.bytes = bytes;
+    if (memory_bytes_ > memory_budget_) {
+        evict_to_budget();
+    }
+}
+
+KeyedSlidingHyperLogLog::Entry& KeyedSlidingHyperLogLog::touch(std::uint32_t key) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+        return it->second;
+    }
+    recency_.push_front(key);
+    it = entries_.emplace(key, Entry{SlidingHyperLogLog(window_seconds_, bucket_seconds_, precision_, false),
+                                     recency_.begin(), 0})
+             .first;
+    it->second.bytes = footprint(it->second.sketch);
+    memory_bytes_ += it->second.bytes;
+    return it->second;
+}
+
+void KeyedSlidingHyperLogLog::evict_to_budget() {
+    // the key just updated sits at the front and is never evicted
+    while (memory_bytes_ > memory_budget_ && recency_.size() > 1) {
+        const auto it = entries_.find(recency_.back());
+        memory_bytes_ -= it->second.bytes;
+        entries_.erase(it);
+        recency_.pop_back();
+        ++evictions_;
+    }
+}
+
+bool KeyedSlidingHyperLogLog::merge_window(std::uint32_t key, std::int64_t now,
+                                           std::int64_t window_seconds, HyperLogLog& out) const {
+    if (window_seconds <= 0 || window_seconds > window_seconds_) {
+        throw std::invalid_argument("Unique-user window must be between 1 second and the tracked window");
+    }
+    const auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    it->second.sketch.merge_window(now, window_seconds, out);
+    return true;
+}
+
+std::uint64_t KeyedSlidingHyperLogLog::cardinality(std::uint32_t key, std::int64_t now,
+                                                   std::int64_t window_seconds) const {
+    HyperLogLog users(precision_);
+    if (!merge_window(key, now, window_seconds, users)) {
+        return 0;
+    }
+    return users.cardinality();
+}
+
+} // namespace engagehub
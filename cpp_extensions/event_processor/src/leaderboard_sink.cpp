@@ -0,0 +1,60 @@
+#include "leaderboard_sink.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace engagehub {
+
+LeaderboardSink::LeaderboardSink(std::vector<std::shared_ptr<leaderboard::Leaderboard>> boards,
+                                 std::unordered_map<std::string, double> points_by_event_type,
+                                 double default_points)
+    : boards_(std::move(boards)),
+      points_by_event_type_(std::move(points_by_event_type)),
+      default_points_(default_points) {
+    for (const auto& board : boards_) {
+        if (!board) {
+            throw std::invalid_argument("LeaderboardSink needs non-null leaderboards");
+        }
+    }
+}
+
+void LeaderboardSink::apply(const EventBatch& batch) {
+    // A batch carries a handful of event types, so their points are looked
+    // up once and then found by id with a short linear scan.
+    std::vector<std::pair<InternId, double>> rules;
+    std::vector<leaderboard::ScoreUpdate> updates;
+    updates.reserve(batch.size());
+    for (const auto& event : batch.events()) {
+        auto rule = rules.begin();
+        while (rule != rules.end() && rule->first != event.event_type) {
+            ++rule;
+        }
+        if (rule == rules.end()) {
+            rules.emplace_back(event.event_type, points_for(batch.event_type(event)));
+            rule = rules.end() - 1;
+        }
+        if (rule->second != 0.0) {
+            // interned strings live as long as the batch's table
+            updates.push_back(leaderboard::ScoreUpdate{batch.user_id(event), rule->second, event.timestamp});
+        }
+    }
+    if (updates.empty()) {
+        return;
+    }
+    for (const auto& board : boards_) {
+        board->update_users(updates);
+    }
+    events_scored_.fetch_add(updates.size(), std::memory_order_relaxed);
+    batches_applied_.fetch_add(1, std::memory_order_relaxed);
+}
+
+EventStreamProcessor::FlushStage LeaderboardSink::stage(std::shared_ptr<LeaderboardSink> sink) {
+    return [sink = std::move(sink)](const EventBatch& batch) { sink->apply(batch); };
+}
+
+double LeaderboardSink::points_for(const std::string& event_type) const {
+    const auto it = points_by_event_type_.find(event_type);
+    return it == points_by_event_type_.end() ? default_points_ : it->second;
+}
+
+} // namespace engagehub
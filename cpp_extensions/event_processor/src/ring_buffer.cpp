@@ -4,5 +4,5 @@
 namespace engagehub {
 // Explicit instantiation for dynamic event buffer used by EventStreamProcessor
 // (Size parameter 0 translates to runtime-sized buffer)
-template class LockFreeRingBuffer<Event, 0>;
+template class LockFreeRingBuffer<Event, 0, ring_policy::MPSC>;
 }
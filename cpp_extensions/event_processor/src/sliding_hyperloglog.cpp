@@ -0,0 +1,223 @@
+#include "sliding_hyperloglog.hpp"
+
+#include "byte_io.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace engagehub {
+
+SlidingHyperLogLog::SlidingHyperLogLog(std::int64_t window_seconds,
+                                       std::int64_t bucket_seconds,
+                                       std::uint8_t precision,
+                                       bool cache_union)
+    : window_seconds_(window_seconds),
+      bucket_seconds_(bucket_seconds),
+      union_(precision),
+      cache_union_(cache_union),
+      union_valid_(cache_union),
+      union_floor_(kEmptyBucket),
+      union_oldest_(std::numeric_limits<std::int64_t>::max()),
+      union_newest_(kEmptyBucket),
+      cached_cardinality_(0),
+      cardinality_dirty_(false) {
+    if (bucket_seconds_ <= 0 || window_seconds_ < bucket_seconds_) {
+        throw std::invalid_argument("SlidingHyperLogLog window must span at least one positive bucket");
+    }
+    // a window of W seconds can touch W / bucket + 1 bucket starts
+    const auto count = static_cast<std::size_t>(window_seconds_ / bucket_seconds_ + 1);
+    buckets_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        buckets_.push_back(Bucket{kEmptyBucket, HyperLogLog(precision)});
+    }
+}
+
+bool SlidingHyperLogLog::add(const std::string& value, std::int64_t timestamp) {
+    return add_hash(HyperLogLog::hash(value), timestamp);
+}
+
+bool SlidingHyperLogLog::add_hash(std::uint64_t hash, std::int64_t timestamp) {
+    const std::int64_t start = (timestamp / bucket_seconds_) * bucket_seconds_;
+    Bucket& bucket = buckets_[slot_for(start)];
+
+    if (bucket.start != start) {
+        if (bucket.start > start) {
+            // the slot already holds a newer bucket, so this event is older
+            // than anything the window can still report
+            return false;
+        }
+        if (bucket.start != kEmptyBucket && bucket.start >= union_floor_) {
+            union_valid_ = false;
+        }
+        bucket.sketch.clear();
+        bucket.start = start;
+    }
+
+    if (!bucket.sketch.add_hash(hash)) {
+        return false;
+    }
+    if (union_valid_ && start >= union_floor_) {
+        union_oldest_ = std::min(union_oldest_, start);
+        union_newest_ = std::max(union_newest_, start);
+        if (union_.add_hash(hash)) {
+            cardinality_dirty_ = true;
+        }
+    }
+    return true;
+}
+
+const HyperLogLog& SlidingHyperLogLog::window_union(std::int64_t now) {
+    // rebuilt once the oldest folded bucket ends before the window or an
+    // early-stamped event folded in a bucket that has not started yet
+    if (!cache_union_ || !union_valid_ || union_oldest_ <= now - window_seconds_ - bucket_seconds_ ||
+        union_newest_ > now) {
+        rebuild_union(now);
+    }
+    return union_;
+}
+
+void SlidingHyperLogLog::merge_window(std::int64_t now, std::int64_t span_seconds, HyperLogLog& out) const {
+    for (const auto& bucket : buckets_) {
+        if (in_window(bucket.start, now, span_seconds)) {
+            out.merge(bucket.sketch);
+        }
+    }
+}
+
+std::uint64_t SlidingHyperLogLog::cardinality(std::int64_t now) {
+    window_union(now);
+    if (cardinality_dirty_) {
+        cached_cardinality_ = union_.cardinality();
+        cardinality_dirty_ = false;
+    }
+    return cached_cardinality_;
+}
+
+void SlidingHyperLogLog::clear() {
+    for (auto& bucket : buckets_) {
+        bucket.start = kEmptyBucket;
+        bucket.sketch.clear();
+    }
+    union_.clear();
+    union_valid_ = cache_union_;
+    union_floor_ = kEmptyBucket;
+    union_oldest_ = std::numeric_limits<std::int64_t>::max();
+    union_newest_ = kEmptyBucket;
+    cached_cardinality_ = 0;
+    cardinality_dirty_ = false;
+}
+
+void SlidingHyperLogLog::merge(const SlidingHyperLogLog& other) {
+    if (other.window_seconds_ != window_seconds_ || other.bucket_seconds_ != bucket_seconds_ ||
+        other.precision() != precision()) {
+        throw std::invalid_argument("Cannot merge SlidingHyperLogLog with a different window or precision");
+    }
+    for (const auto& incoming : other.buckets_) {
+        if (incoming.start == kEmptyBucket) {
+            continue;
+        }
+        Bucket& bucket = buckets_[slot_for(incoming.start)];
+        if (bucket.start == incoming.start) {
+            bucket.sketch.merge(incoming.sketch);
+        } else if (bucket.start < incoming.start) {
+            // kEmptyBucket is the minimum, so empty slots land here too
+            bucket.start = incoming.start;
+            bucket.sketch = incoming.sketch;
+        }
+    }
+    union_valid_ = false;
+}
+
+void SlidingHyperLogLog::serialize(ByteWriter& out) const {
+    out.put<std::int64_t>(window_seconds_);
+    out.put<std::int64_t>(bucket_seconds_);
+    out.put<std::uint8_t>(precision());
+    const auto live = static_cast<std::uint32_t>(
+        std::count_if(buckets_.begin(), buckets_.end(),
+                      [](const Bucket& bucket) { return bucket.start != kEmptyBucket; }));
+    out.put<std::uint32_t>(live);
+    for (const auto& bucket : buckets_) {
+        if (bucket.start != kEmptyBucket) {
+            out.put<std::int64_t>(bucket.start);
+            bucket.sketch.serialize(out);
+        }
+    }
+}
+
+SlidingHyperLogLog SlidingHyperLogLog::deserialize(ByteReader& in) {
+    const auto window_seconds = in.get<std::int64_t>();
+    const auto bucket_seconds = in.get<std::int64_t>();
+    const auto precision = in.get<std::uint8_t>();
+    if (bucket_seconds <= 0 || window_seconds < bucket_seconds ||
+        window_seconds / bucket_seconds > (std::int64_t{1} << 20) || precision < 4 || precision > 18) {
+        throw std::runtime_error("serialized SlidingHyperLogLog has an invalid geometry");
+    }
+    SlidingHyperLogLog ring(window_seconds, bucket_seconds, precision);
+    const auto live = in.get<std::uint32_t>();
+    if (live > ring.buckets_.size()) {
+        throw std::runtime_error("serialized SlidingHyperLogLog has too many buckets");
+    }
+    for (std::uint32_t i = 0; i < live; ++i) {
+        const auto start = in.get<std::int64_t>();
+        auto sketch = HyperLogLog::deserialize(in);
+        if (start == kEmptyBucket || start % bucket_seconds != 0 || sketch.precision() != precision) {
+            throw std::runtime_error("serialized SlidingHyperLogLog has a malformed bucket");
+        }
+        Bucket& bucket = ring.buckets_[ring.slot_for(start)];
+        if (bucket.start != kEmptyBucket) {
+            throw std::runtime_error("serialized SlidingHyperLogLog has overlapping buckets");
+        }
+        bucket.start = start;
+        bucket.sketch = std::move(sketch);
+    }
+    ring.union_valid_ = false;
+    return ring;
+}
+
+std::size_t SlidingHyperLogLog::memory_bytes() const noexcept {
+    std::size_t bytes = buckets_.capacity() * sizeof(Bucket) + union_.memory_bytes();
+    for (const auto& bucket : buckets_) {
+        bytes += bucket.sketch.memory_bytes();
+    }
+    return bytes;
+}
+
+std::size_t SlidingHyperLogLog::slot_for(std::int64_t bucket_start) const noexcept {
+    const auto count = static_cast<std::int64_t>(buckets_.size());
+    auto slot = (bucket_start / bucket_seconds_) % count;
+    if (slot < 0) {
+        slot += count;
+    }
+    return static_cast<std::size_t>(slot);
+}
+
+bool SlidingHyperLogLog::in_window(std::int64_t bucket_start, std::int64_t now,
+                                   std::int64_t span_seconds) const noexcept {
+    // kEmptyBucket is checked first so the sum below cannot overflow
+    return bucket_start != kEmptyBucket && bucket_start <= now &&
+           bucket_start + bucket_seconds_ > now - span_seconds;
+}
+
+void SlidingHyperLogLog::rebuild_union(std::int64_t now) {
+    union_.clear();
+    union_oldest_ = std::numeric_limits<std::int64_t>::max();
+    union_newest_ = kEmptyBucket;
+    bool skipped_future = false;
+    for (const auto& bucket : buckets_) {
+        if (!in_window(bucket.start, now, window_seconds_)) {
+            skipped_future = skipped_future || (bucket.start != kEmptyBucket && bucket.start > now);
+            continue;
+        }
+        union_.merge(bucket.sketch);
+        union_oldest_ = std::min(union_oldest_, bucket.start);
+        union_newest_ = std::max(union_newest_, bucket.start);
+    }
+    // the first bucket start that still overlaps the window
+    union_floor_ = now - window_seconds_ - bucket_seconds_ + 1;
+    // a skipped future bucket joins the window later, so the next read
+    // rebuilds rather than trusting a union that lacks it
+    union_valid_ = cache_union_ && !skipped_future;
+    cardinality_dirty_ = true;
+}
+
+} // namespace engagehub
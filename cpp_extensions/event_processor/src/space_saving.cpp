@@ -0,0 +1,94 @@
+#include "space_saving.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace engagehub {
+
+SpaceSaving::SpaceSaving(std::size_t capacity)
+    : capacity_(capacity), total_(0) {
+    if (capacity_ == 0) {
+        throw std::invalid_argument("SpaceSaving capacity must be greater than zero");
+    }
+    entries_.reserve(capacity_);
+    positions_.reserve(capacity_);
+}
+
+void SpaceSaving::offer(std::uint32_t key, std::uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    total_ += count;
+
+    const auto it = positions_.find(key);
+    if (it != positions_.end()) {
+        promote(it->second, count);
+        return;
+    }
+
+    if (entries_.size() < capacity_) {
+        positions_.emplace(key, static_cast<std::uint32_t>(entries_.size()));
+        entries_.push_back(HeavyHitter{key, 0, 0});
+        promote(entries_.size() - 1, count);
+        return;
+    }
+
+    // evict the smallest counter and let the new key inherit its count as error
+    HeavyHitter& victim = entries_.back();
+    positions_.erase(victim.key);
+    victim.key = key;
+    victim.error = victim.count;
+    positions_.emplace(key, static_cast<std::uint32_t>(entries_.size() - 1));
+    promote(entries_.size() - 1, count);
+}
+
+std::vector<HeavyHitter> SpaceSaving::top_k(std::size_t k) const {
+    const auto count = std::min(k, entries_.size());
+    return std::vector<HeavyHitter>(entries_.begin(), entries_.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+void SpaceSaving::clear() {
+    entries_.clear();
+    positions_.clear();
+    total_ = 0;
+}
+
+std::uint64_t SpaceSaving::error_bound() const noexcept {
+    if (entries_.size() < capacity_) {
+        return 0;
+    }
+    return entries_.back().count;
+}
+
+void SpaceSaving::promote(std::size_t index, std::uint64_t delta) {
+    const std::uint64_t old_count = entries_[index].count;
+    const std::uint64_t new_count = old_count + delta;
+    const auto begin = entries_.begin();
+    const auto target = static_cast<std::size_t>(
+        std::partition_point(begin, begin + static_cast<std::ptrdiff_t>(index),
+                             [new_count](const HeavyHitter& entry) { return entry.count >= new_count; }) -
+        begin);
+
+    entries_[index].count = new_count;
+    if (target == index) {
+        return;
+    }
+
+    if (entries_[target].count == old_count) {
+        // everything in [target, index) ties with the old count, a swap keeps the order
+        std::swap(entries_[target], entries_[index]);
+        positions_[entries_[index].key] = static_cast<std::uint32_t>(index);
+        positions_[entries_[target].key] = static_cast<std::uint32_t>(target);
+        return;
+    }
+
+    std::rotate(begin + static_cast<std::ptrdiff_t>(target),
+                begin + static_cast<std::ptrdiff_t>(index),
+                begin + static_cast<std::ptrdiff_t>(index) + 1);
+    for (std::size_t i = target; i <= index; ++i) {
+        positions_[entries_[i].key] = static_cast<std::uint32_t>(i);
+    }
+}
+
+} // namespace engagehub
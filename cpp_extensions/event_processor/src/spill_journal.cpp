@@ -0,0 +1,430 @@
+#include "spill_journal.hpp"
+
+#include "byte_io.hpp"
+#include "hashing.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace engagehub {
+namespace {
+
+// Segment layout, all integers little-endian:
+//   "EHSJ" | u16 version | u16 reserved | u64 sequence
+//   records, each 8-byte aligned:
+//     u32 payload length (0 ends the segment) | u8 tag | u8 state | u16 reserved
+//     u64 MurmurHash3 of the payload, seeded with the tag
+//     payload
+constexpr char kSegmentMagic[4] = {'E', 'H', 'S', 'J'};
+constexpr std::uint16_t kSegmentFormatVersion = 1;
+constexpr std::size_t kSegmentHeaderSize = 16;
+constexpr std::size_t kRecordHeaderSize = 16;
+constexpr std::size_t kStateOffset = 5;
+constexpr std::uint8_t kRecordPending = 0;
+constexpr std::uint8_t kRecordAcknowledged = 1;
+
+constexpr const char* kSegmentPrefix = "segment-";
+constexpr const char* kSegmentSuffix = ".log";
+
+std::runtime_error journal_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+constexpr std::size_t align_record(std::size_t size) noexcept {
+    return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+std::uint64_t record_checksum(std::uint8_t tag, const char* payload, std::size_t size) noexcept {
+    return hashing::murmur3_64(payload, size, tag);
+}
+
+std::string segment_name(std::uint64_t sequence) {
+    char digits[24];
+    std::snprintf(digits, sizeof(digits), "%012llu", static_cast<unsigned long long>(sequence));
+    return std::string(kSegmentPrefix) + digits + kSegmentSuffix;
+}
+
+std::optional<std::uint64_t> parse_segment_name(const std::string& name) {
+    const std::string prefix(kSegmentPrefix);
+    const std::string suffix(kSegmentSuffix);
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return std::nullopt;
+    }
+    const auto digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    if (!std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return std::nullopt;
+    }
+    return std::stoull(digits);
+}
+
+struct RecordHeader {
+    std::uint32_t length = 0;
+    std::uint8_t tag = 0;
+    std::uint8_t state = 0;
+    std::uint64_t checksum = 0;
+};
+
+RecordHeader read_record_header(const char* at) {
+    ByteReader in(std::string_view(at, kRecordHeaderSize));
+    RecordHeader header;
+    header.length = in.get<std::uint32_t>();
+    header.tag = in.get<std::uint8_t>();
+    header.state = in.get<std::uint8_t>();
+    in.get<std::uint16_t>();
+    header.checksum = in.get<std::uint64_t>();
+    return header;
+}
+
+// Makes a newly created or removed directory entry durable.
+void sync_directory(const std::string& directory) {
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+// Shared read-write mapping of a whole segment file.
+class SpillJournal::Mapping {
+public:
+    // Opens `path`, creating it with `create_size` bytes when that is
+    // non-zero, and maps all of it. A file this call created is removed
+    // again if it cannot be sized or mapped, so no empty segment is left.
+    Mapping(const std::string& path, std::size_t create_size) {
+        const bool create = create_size != 0;
+        const int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0);
+        const int fd = ::open(path.c_str(), flags, 0644);
+        if (fd < 0) {
+            throw journal_error("Failed to open journal segment", path);
+        }
+        const auto fail = [&](std::runtime_error error) {
+            ::close(fd);
+            if (create) {
+                ::unlink(path.c_str());
+            }
+            throw error;
+        };
+        if (create && ::ftruncate(fd, static_cast<off_t>(create_size)) != 0) {
+            fail(journal_error("Failed to size journal segment", path));
+        }
+        const off_t size = ::lseek(fd, 0, SEEK_END);
+        if (size < 0) {
+            fail(journal_error("Failed to size journal segment", path));
+        }
+        if (size == 0) {
+            fail(std::runtime_error("Journal segment is empty '" + path + "'"));
+        }
+        size_ = static_cast<std::size_t>(size);
+        void* data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            fail(journal_error("Failed to map journal segment", path));
+        }
+        // the mapping stays valid after the descriptor is closed
+        ::close(fd);
+        data_ = static_cast<char*>(data);
+    }
+
+    ~Mapping() { ::munmap(data_, size_); }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+    // Writes [begin, end) back to the file, widened to whole pages.
+    void sync(std::size_t begin, std::size_t end) const {
+        static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        begin -= begin % page;
+        end = std::min(end, size_);
+        if (begin < end) {
+            ::msync(data_ + begin, end - begin, MS_SYNC);
+        }
+    }
+
+private:
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+SpillJournal::Segment::Segment(std::uint64_t sequence_, std::string path_)
+    : sequence(sequence_), path(std::move(path_)) {}
+SpillJournal::Segment::Segment(Segment&&) noexcept = default;
+SpillJournal::Segment::~Segment() = default;
+
+SpillJournal::SpillJournal(std::string directory,
+                           std::size_t segment_bytes,
+                           std::chrono::milliseconds sync_interval)
+    : directory_(std::move(directory)),
+      segment_bytes_(std::max(segment_bytes, kSegmentHeaderSize + kRecordHeaderSize)),
+      sync_interval_(sync_interval),
+      read_offset_(kSegmentHeaderSize),
+      last_sync_(std::chrono::steady_clock::now()) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        throw std::runtime_error("Failed to create journal directory '" + directory_ + "': " + error.message());
+    }
+    recover();
+}
+
+SpillJournal::~SpillJournal() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sync_locked();
+    // a fully delivered write segment is not worth recovering
+    if (writer_open_ && !segments_.empty() && segments_.back().pending == 0) {
+        segments_.back().mapping.reset();
+        std::remove(segments_.back().path.c_str());
+    }
+}
+
+// Scans existing segments in sequence order. Each is read up to its first
+// invalid record; segments with nothing left to deliver are deleted. A
+// crash while creating a segment leaves the file shorter than a header or
+// with its header zeroed; either way it holds no records.
+void SpillJournal::recover() {
+    std::vector<std::pair<std::uint64_t, std::string>> found;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+        if (const auto sequence = parse_segment_name(entry.path().filename().string())) {
+            found.emplace_back(*sequence, entry.path().string());
+        }
+    }
+    std::sort(found.begin(), found.end());
+
+    for (auto& [sequence, path] : found) {
+        next_sequence_ = sequence + 1;
+        std::error_code error;
+        const auto file_size = std::filesystem::file_size(path, error);
+        if (error || file_size < kSegmentHeaderSize) {
+            std::remove(path.c_str());
+            continue;
+        }
+        Segment segment(sequence, std::move(path));
+        Mapping& mapping = map(segment);
+        const char* data = mapping.data();
+        const std::size_t size = mapping.size();
+
+        ByteReader header(std::string_view(data, kSegmentHeaderSize));
+        const bool usable =
+            header.get_bytes(sizeof(kSegmentMagic)) == std::string_view(kSegmentMagic, sizeof(kSegmentMagic));
+        if (usable) {
+            const auto version = header.get<std::uint16_t>();
+            if (version != kSegmentFormatVersion) {
+                throw std::runtime_error("Unsupported journal segment version " + std::to_string(version) +
+                                         ": " + segment.path);
+            }
+        }
+
+        std::size_t offset = kSegmentHeaderSize;
+        while (usable && offset + kRecordHeaderSize <= size) {
+            const auto record = read_record_header(data + offset);
+            if (record.length == 0 || record.length > size - offset - kRecordHeaderSize ||
+                record.checksum != record_checksum(record.tag, data + offset + kRecordHeaderSize, record.length)) {
+                break;
+            }
+            if (record.state == kRecordPending) {
+                ++segment.pending;
+            }
+            offset = std::min(size, align_record(offset + kRecordHeaderSize + record.length));
+        }
+        segment.end = usable ? offset : kSegmentHeaderSize;
+        segment.capacity = size;
+        segment.mapping.reset();
+
+        if (segment.pending == 0) {
+            std::remove(segment.path.c_str());
+            continue;
+        }
+        pending_records_ += segment.pending;
+        segments_.push_back(std::move(segment));
+    }
+    recovered_records_ = pending_records_;
+}
+
+void SpillJournal::append(std::uint8_t tag, std::string_view payload) {
+    if (payload.empty() || payload.size() > UINT32_MAX) {
+        throw std::invalid_argument("journal payloads must be between 1 byte and 4 GiB");
+    }
+    const std::size_t record_bytes = align_record(kRecordHeaderSize + payload.size());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Segment& segment = writable_segment(record_bytes);
+    char* at = map(segment).data() + segment.end;
+
+    std::string header;
+    ByteWriter out(header);
+    out.put<std::uint32_t>(0);
+    out.put<std::uint8_t>(tag);
+    out.put<std::uint8_t>(kRecordPending);
+    out.put<std::uint16_t>(0);
+    out.put<std::uint64_t>(record_checksum(tag, payload.data(), payload.size()));
+    std::memcpy(at + kRecordHeaderSize, payload.data(), payload.size());
+    std::memcpy(at + sizeof(std::uint32_t), header.data() + sizeof(std::uint32_t),
+                kRecordHeaderSize - sizeof(std::uint32_t));
+    // the length goes in last: until then recovery sees the end of the segment
+    std::string length;
+    ByteWriter(length).put<std::uint32_t>(static_cast<std::uint32_t>(payload.size()));
+    std::memcpy(at, length.data(), length.size());
+
+    segment.end += record_bytes;
+    ++segment.pending;
+    ++pending_records_;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_sync_ >= sync_interval_) {
+        sync_locked();
+    }
+}
+
+std::optional<SpillJournal::Record> SpillJournal::peek() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!segments_.empty()) {
+        Segment& front = segments_.front();
+        const char* data = map(front).data();
+        while (read_offset_ < front.end) {
+            const auto header = read_record_header(data + read_offset_);
+            if (header.state == kRecordPending) {
+                Record record;
+                record.tag = header.tag;
+                record.payload.assign(data + read_offset_ + kRecordHeaderSize, header.length);
+                record.segment = front.sequence;
+                record.offset = read_offset_;
+                return record;
+            }
+            read_offset_ = align_record(read_offset_ + kRecordHeaderSize + header.length);
+        }
+        if (is_writer(front)) {
+            return std::nullopt;
+        }
+        retire_front();
+    }
+    return std::nullopt;
+}
+
+void SpillJournal::acknowledge(const Record& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = std::find_if(segments_.begin(), segments_.end(),
+                                 [&](const Segment& segment) { return segment.sequence == record.segment; });
+    if (it == segments_.end() || record.offset >= it->end) {
+        return;
+    }
+    char* state = map(*it).data() + record.offset + kStateOffset;
+    if (static_cast<std::uint8_t>(*state) != kRecordPending) {
+        return;
+    }
+    *state = static_cast<char>(kRecordAcknowledged);
+    acks_dirty_ = true;
+    --it->pending;
+    --pending_records_;
+
+    if (it == segments_.begin() && it->pending == 0 && !is_writer(*it)) {
+        retire_front();
+    }
+}
+
+void SpillJournal::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sync_locked();
+}
+
+std::size_t SpillJournal::pending_records() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_records_;
+}
+
+std::size_t SpillJournal::segment_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+}
+
+// Returns the write segment with room for `record_bytes`, rolling over to a
+// new one when the current segment is full.
+SpillJournal::Segment& SpillJournal::writable_segment(std::size_t record_bytes) {
+    if (writer_open_) {
+        Segment& current = segments_.back();
+        if (current.end + record_bytes <= current.capacity) {
+            return current;
+        }
+        sync_locked();
+        if (segments_.size() > 1) {
+            // only the front segment is read, so the old writer can go
+            current.mapping.reset();
+        }
+    }
+
+    const std::size_t capacity = std::max(segment_bytes_, kSegmentHeaderSize + record_bytes);
+    // the number is used up even if creation fails, so a leftover file
+    // under that name cannot block every later append
+    const std::uint64_t sequence = next_sequence_++;
+    Segment segment(sequence, directory_ + "/" + segment_name(sequence));
+    segment.mapping = std::make_unique<Mapping>(segment.path, capacity);
+    segment.capacity = segment.mapping->size();
+    segment.end = kSegmentHeaderSize;
+
+    std::string header;
+    ByteWriter out(header);
+    out.put_bytes(kSegmentMagic, sizeof(kSegmentMagic));
+    out.put<std::uint16_t>(kSegmentFormatVersion);
+    out.put<std::uint16_t>(0);
+    out.put<std::uint64_t>(segment.sequence);
+    std::memcpy(segment.mapping->data(), header.data(), header.size());
+    sync_directory(directory_);
+
+    if (segments_.empty()) {
+        read_offset_ = kSegmentHeaderSize;
+    }
+    segments_.push_back(std::move(segment));
+    writer_open_ = true;
+    synced_end_ = 0;
+    return segments_.back();
+}
+
+SpillJournal::Mapping& SpillJournal::map(Segment& segment) {
+    if (!segment.mapping) {
+        segment.mapping = std::make_unique<Mapping>(segment.path, 0);
+    }
+    return *segment.mapping;
+}
+
+bool SpillJournal::is_writer(const Segment& segment) const {
+    return writer_open_ && &segment == &segments_.back();
+}
+
+// Deletes the front segment; every record in it has been acknowledged.
+void SpillJournal::retire_front() {
+    segments_.front().mapping.reset();
+    std::remove(segments_.front().path.c_str());
+    segments_.pop_front();
+    read_offset_ = kSegmentHeaderSize;
+    acks_dirty_ = false;
+}
+
+void SpillJournal::sync_locked() {
+    last_sync_ = std::chrono::steady_clock::now();
+    if (acks_dirty_ && !segments_.empty() && segments_.front().mapping) {
+        const Segment& front = segments_.front();
+        front.mapping->sync(0, front.end);
+    }
+    acks_dirty_ = false;
+    if (writer_open_) {
+        const Segment& writer = segments_.back();
+        if (writer.mapping && synced_end_ < writer.end) {
+            writer.mapping->sync(synced_end_, writer.end);
+            synced_end_ = writer.end;
+        }
+    }
+}
+
+} // namespace engagehub
@@ -0,0 +1,68 @@
+#include "string_interner.hpp"
+
+#include "hashing.hpp"
+
+#include <stdexcept>
+
+namespace engagehub {
+
+StringInterner::StringInterner()
+    : chunks_(std::make_unique<std::atomic<Entry*>[]>(kMaxChunks)),
+      size_(0) {
+    for (std::size_t i = 0; i < kMaxChunks; ++i) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+StringInterner::~StringInterner() {
+    for (std::size_t i = 0; i < kMaxChunks; ++i) {
+        delete[] chunks_[i].load(std::memory_order_relaxed);
+    }
+}
+
+std::optional<InternId> StringInterner::find(std::string_view value) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto it = ids_.find(value);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+InternId StringInterner::intern(std::string_view value) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const auto it = ids_.find(value);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto it = ids_.find(value);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    const std::size_t next = size_.load(std::memory_order_relaxed);
+    if (next >= kChunkSize * kMaxChunks) {
+        throw std::length_error("StringInterner capacity exhausted");
+    }
+    const std::size_t chunk_index = next >> kChunkBits;
+    Entry* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new Entry[kChunkSize];
+        chunks_[chunk_index].store(chunk, std::memory_order_release);
+    }
+
+    Entry& slot = chunk[next & (kChunkSize - 1)];
+    slot.value.assign(value.data(), value.size());
+    slot.hash = hashing::hash64(slot.value);
+
+    const auto id = static_cast<InternId>(next);
+    ids_.emplace(std::string_view(slot.value), id);
+    size_.store(next + 1, std::memory_order_release);
+    return id;
+}
+
+} // namespace engagehub
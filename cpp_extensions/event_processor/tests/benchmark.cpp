@@ -10,7 +10,7 @@ using engagehub::EventStreamProcessor;
 TEST_CASE("Event processor benchmark", "[benchmark]") {
     EventStreamProcessor processor(4096, 4, 256, 100);
     std::atomic<int> flushed{0};
-    processor.set_flush_callback([&flushed](std::vector<engagehub::Event> events) {
+    processor.set_flush_callback([&flushed](engagehub::EventBatch events) {
         flushed.fetch_add(static_cast<int>(events.size()), std::memory_order_relaxed);
     });
 
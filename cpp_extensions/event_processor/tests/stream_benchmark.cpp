@@ -0,0 +1,254 @@
+// Multi-producer throughput and latency benchmark for EventStreamProcessor.
+//
+// Every run pushes Zipf-distributed (user, channel) events from 1..N producer
+// threads while optional query threads hammer get_top_channels and
+// get_unique_users_last_hour, then drains with flush_now. One JSON object per
+// producer count is written to stdout (or --output), so runs can be diffed.
+//
+//   event_processor_benchmark --producers=1,2,4,8 --events=1000000
+//       --ring=65536 --batch=512 --shards=4 --query-threads=2 --zipf=1.1
+
+#include "benchmark_support.hpp"
+#include "event_processor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using engagehub::EventBatch;
+using engagehub::EventStreamProcessor;
+using engagehub::LatencyHistogram;
+using engagehub::OverflowPolicy;
+using engagehub::bench::JsonWriter;
+using engagehub::bench::Options;
+using engagehub::bench::ZipfGenerator;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Config {
+    std::size_t events = 0;
+    std::size_t ring = 0;
+    std::size_t batch = 0;
+    std::size_t shards = 0;
+    std::size_t pool_threads = 0;
+    std::size_t flush_interval_ms = 0;
+    std::size_t users = 0;
+    std::size_t channels = 0;
+    double zipf = 0.0;
+    std::size_t query_threads = 0;
+    std::size_t callback_work_us = 0;
+    // time one push in this many
+    std::size_t latency_sample = 0;
+    OverflowPolicy overflow = OverflowPolicy::Drop;
+};
+
+struct Workload {
+    std::vector<std::string> users;
+    std::vector<std::string> channels;
+    // per producer: pairs of (user index, channel index)
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> streams;
+};
+
+std::uint64_t nanos_since(Clock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+Workload make_workload(const Config& config, std::size_t producers) {
+    Workload workload;
+    for (std::size_t i = 0; i < config.users; ++i) {
+        workload.users.push_back("user-" + std::to_string(i));
+    }
+    for (std::size_t i = 0; i < config.channels; ++i) {
+        workload.channels.push_back("channel-" + std::to_string(i));
+    }
+    // generated up front so the producers measure ingest, not sampling
+    const std::size_t per_producer = config.events / producers;
+    for (std::size_t p = 0; p < producers; ++p) {
+        ZipfGenerator user_rank(config.users, config.zipf, 0x5eed + p);
+        ZipfGenerator channel_rank(config.channels, config.zipf, 0xc0ffee + p);
+        auto& stream = workload.streams.emplace_back();
+        stream.reserve(per_producer);
+        for (std::size_t i = 0; i < per_producer; ++i) {
+            stream.emplace_back(static_cast<std::uint32_t>(user_rank()),
+                                static_cast<std::uint32_t>(channel_rank()));
+        }
+    }
+    return workload;
+}
+
+void busy_wait(std::chrono::microseconds duration) {
+    const auto until = Clock::now() + duration;
+    while (Clock::now() < until) {
+    }
+}
+
+void run(const Config& config, std::size_t producers, JsonWriter& json) {
+    const auto workload = make_workload(config, producers);
+    EventStreamProcessor processor(config.ring, config.pool_threads, config.batch, config.flush_interval_ms,
+                                   config.shards, 1024, config.overflow);
+
+    std::atomic<std::uint64_t> delivered{0};
+    const auto callback_work = std::chrono::microseconds(config.callback_work_us);
+    processor.set_flush_callback([&delivered, callback_work](EventBatch batch) {
+        if (callback_work.count() != 0) {
+            busy_wait(callback_work);
+        }
+        delivered.fetch_add(batch.size(), std::memory_order_relaxed);
+    });
+
+    const auto now = static_cast<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count());
+
+    LatencyHistogram push_latency;
+    LatencyHistogram top_channels_latency;
+    LatencyHistogram unique_users_latency;
+    std::atomic<bool> producing{true};
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> queries;
+    for (std::size_t q = 0; q < config.query_threads; ++q) {
+        queries.emplace_back([&]() {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            while (producing.load(std::memory_order_acquire)) {
+                auto start = Clock::now();
+                processor.get_top_channels(10);
+                top_channels_latency.record(nanos_since(start));
+                start = Clock::now();
+                processor.get_unique_users_last_hour();
+                unique_users_latency.record(nanos_since(start));
+            }
+        });
+    }
+
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            const auto& stream = workload.streams[p];
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < stream.size(); ++i) {
+                const auto& [user, channel] = stream[i];
+                if (i % config.latency_sample == 0) {
+                    const auto start = Clock::now();
+                    processor.push_event("message", workload.users[user], workload.channels[channel], now);
+                    push_latency.record(nanos_since(start));
+                } else {
+                    processor.push_event("message", workload.users[user], workload.channels[channel], now);
+                }
+            }
+        });
+    }
+
+    while (ready.load() != producers) {
+        std::this_thread::yield();
+    }
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto ingest_ns = nanos_since(start);
+    producing.store(false, std::memory_order_release);
+    processor.flush_now();
+    const auto total_ns = nanos_since(start);
+    for (auto& thread : queries) {
+        thread.join();
+    }
+
+    const auto pushed = workload.streams.size() * workload.streams.front().size();
+    const auto dropped = processor.events_dropped();
+    const auto metrics = processor.get_metrics();
+    const auto per_second = [](std::uint64_t count, std::uint64_t ns) {
+        return ns == 0 ? 0.0 : static_cast<double>(count) * 1e9 / static_cast<double>(ns);
+    };
+
+    json.begin_object();
+    json.field("producers", producers);
+    json.field("events", pushed);
+    json.field("ring", config.ring);
+    json.field("batch", config.batch);
+    json.field("shards", config.shards);
+    json.field("zipf", config.zipf);
+    json.field("query_threads", config.query_threads);
+    json.field("callback_work_us", config.callback_work_us);
+    json.field("processed", processor.total_events_processed());
+    json.field("delivered", delivered.load());
+    json.field("dropped", dropped);
+    json.field("drop_rate", pushed == 0 ? 0.0 : static_cast<double>(dropped) / static_cast<double>(pushed));
+    json.field("ingest_events_per_sec", per_second(pushed, ingest_ns));
+    json.field("end_to_end_events_per_sec", per_second(delivered.load(), total_ns));
+    json.latency("push_ns", push_latency.summary());
+    json.latency("top_channels_ns", top_channels_latency.summary());
+    json.latency("unique_users_ns", unique_users_latency.summary());
+    json.latency("enqueue_to_flush_us", metrics.enqueue_to_flush_us);
+    json.latency("callback_us", metrics.callback_us);
+    json.field("consumer_busy_ratio", metrics.consumer_busy_ratio);
+    json.end_object();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options(argc, argv);
+        Config config;
+        config.events = options.get_size("events", 1'000'000);
+        config.ring = options.get_size("ring", 1 << 16);
+        config.batch = options.get_size("batch", 512);
+        config.shards = options.get_size("shards", 4);
+        config.pool_threads = options.get_size("pool-threads", 2);
+        config.flush_interval_ms = options.get_size("flush-interval-ms", 50);
+        config.users = options.get_size("users", 100'000);
+        config.channels = options.get_size("channels", 1'000);
+        config.zipf = options.get_double("zipf", 1.1);
+        config.query_threads = options.get_size("query-threads", 1);
+        config.callback_work_us = options.get_size("callback-work-us", 0);
+        config.latency_sample = std::max<std::size_t>(1, options.get_size("latency-sample", 16));
+        const auto overflow = options.get("overflow", "drop");
+        if (overflow == "block") {
+            config.overflow = OverflowPolicy::Block;
+        } else if (overflow == "overwrite") {
+            config.overflow = OverflowPolicy::OverwriteOldest;
+        } else if (overflow != "drop") {
+            throw std::invalid_argument("--overflow must be drop, block or overwrite");
+        }
+        const auto producer_counts = options.get_sizes("producers", "1,2,4");
+        if (config.events == 0 || config.users == 0 || config.channels == 0 || producer_counts.empty()) {
+            throw std::invalid_argument("--events, --users, --channels and --producers must be positive");
+        }
+
+        std::ofstream file;
+        const auto output = options.get("output", "");
+        if (!output.empty()) {
+            file.open(output);
+            if (!file) {
+                throw std::runtime_error("Failed to open file for writing: " + output);
+            }
+        }
+        JsonWriter json(output.empty() ? std::cout : file);
+        json.begin_object();
+        json.field("benchmark", "event_processor");
+        json.begin_array("runs");
+        for (const auto producers : producer_counts) {
+            run(config, std::max<std::size_t>(1, producers), json);
+        }
+        json.end_array();
+        json.end_object();
+    } catch (const std::exception& error) {
+        std::cerr << "event_processor_benchmark: " << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
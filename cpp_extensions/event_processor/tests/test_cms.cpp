@@ -1,10 +1,21 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include "byte_io.hpp"
 #include "count_min_sketch.hpp"
+#include "hashing.hpp"
+#include "hll_kernels.hpp"
 #include "hyperloglog.hpp"
+#include "keyed_hyperloglog.hpp"
+#include "sliding_hyperloglog.hpp"
+#include "space_saving.hpp"
+#include "string_interner.hpp"
 
 #include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 using engagehub::CountMinSketch;
 using engagehub::HyperLogLog;
@@ -30,6 +41,33 @@ TEST_CASE("CountMinSketch approximates frequencies") {
     REQUIRE(alpha_over <= 50);
 }
 
+TEST_CASE("Shared hashing core matches MurmurHash3 and feeds every sketch") {
+    using engagehub::hashing::murmur3_64;
+    // reference values for MurmurHash3_x64_128 (first half), seed 0
+    REQUIRE(murmur3_64("hello", 5, 0) == 0xcbd8a7b341bd9b02ULL);
+    REQUIRE(murmur3_64("The quick brown fox jumps over the lazy dog", 43, 0) == 0xe34bbc7bbc071b6cULL);
+    // unaligned input hashes the same as aligned input
+    const std::string padded = "xThe quick brown fox jumps over the lazy dog";
+    REQUIRE(murmur3_64(padded.data() + 1, 43, 0) == 0xe34bbc7bbc071b6cULL);
+
+    REQUIRE(HyperLogLog::hash("general") == engagehub::hashing::hash64("general"));
+
+    CountMinSketch<> runtime(2048, 4, 99);
+    CountMinSketch<2048, 4> fixed(99);
+    for (int i = 0; i < 200; ++i) {
+        const auto key = "channel-" + std::to_string(i % 20);
+        runtime.increment(key);
+        fixed.increment_hash(engagehub::hashing::hash64(key));
+    }
+    for (int i = 0; i < 20; ++i) {
+        const auto key = "channel-" + std::to_string(i);
+        REQUIRE(runtime.estimate(key) == fixed.estimate(key));
+        REQUIRE(fixed.estimate_hash(engagehub::hashing::hash64(key)) >= 10);
+    }
+    REQUIRE(fixed.width() == 2048);
+    REQUIRE(fixed.depth() == 4);
+}
+
 TEST_CASE("HyperLogLog estimates unique counts") {
     HyperLogLog hll(14);
 
@@ -41,3 +79,331 @@ TEST_CASE("HyperLogLog estimates unique counts") {
     REQUIRE(estimate > 7600);
     REQUIRE(estimate < 8400);
 }
+
+TEST_CASE("HyperLogLog promotes from sparse to dense without changing the estimate") {
+    HyperLogLog sparse(14);
+    HyperLogLog reference(14);
+    for (int i = 0; i < 20000; ++i) {
+        reference.add("user-" + std::to_string(i));
+    }
+    REQUIRE_FALSE(reference.is_sparse());
+
+    for (int i = 0; i < 300; ++i) {
+        sparse.add("user-" + std::to_string(i));
+    }
+    REQUIRE(sparse.is_sparse());
+    REQUIRE(sparse.memory_bytes() < 16384 / 4);
+    REQUIRE(sparse.cardinality() > 280);
+    REQUIRE(sparse.cardinality() < 320);
+
+    // the sparse users are a subset, so the union must equal the reference
+    HyperLogLog left = sparse;
+    left.merge(reference);
+    HyperLogLog right = reference;
+    right.merge(sparse);
+    REQUIRE_FALSE(left.is_sparse());
+    REQUIRE(left.cardinality() == right.cardinality());
+    REQUIRE(left.cardinality() == reference.cardinality());
+
+    for (int i = 300; i < 5000; ++i) {
+        sparse.add("user-" + std::to_string(i));
+    }
+    REQUIRE_FALSE(sparse.is_sparse());
+    REQUIRE(sparse.cardinality() > 4750);
+    REQUIRE(sparse.cardinality() < 5250);
+
+    sparse.clear();
+    REQUIRE(sparse.is_sparse());
+    REQUIRE(sparse.cardinality() == 0);
+}
+
+TEST_CASE("HyperLogLog register kernels match the scalar reference") {
+    namespace kernels = engagehub::hll_kernels;
+    std::mt19937 rng(7);
+    std::geometric_distribution<int> rank(0.5);
+
+    for (std::size_t count : {16U, 100U, 1024U, 16384U}) {
+        std::vector<std::uint8_t> lhs(count);
+        std::vector<std::uint8_t> rhs(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            lhs[i] = static_cast<std::uint8_t>(std::min(rank(rng), 50));
+            rhs[i] = static_cast<std::uint8_t>(std::min(rank(rng), 50));
+        }
+
+        const auto fast = kernels::sum_registers(lhs.data(), count);
+        const auto slow = kernels::sum_registers_scalar(lhs.data(), count);
+        REQUIRE(fast.zeros == slow.zeros);
+        REQUIRE(fast.inverse_sum == slow.inverse_sum);
+
+        auto fast_max = lhs;
+        auto slow_max = lhs;
+        kernels::max_registers(fast_max.data(), rhs.data(), count);
+        kernels::max_registers_scalar(slow_max.data(), rhs.data(), count);
+        REQUIRE(fast_max == slow_max);
+    }
+}
+
+TEST_CASE("SlidingHyperLogLog keeps quiet buckets sparse") {
+    engagehub::SlidingHyperLogLog window(3600, 60);
+    const std::int64_t start = 1696284000;
+    for (int minute = 0; minute < 60; ++minute) {
+        for (int i = 0; i < 20; ++i) {
+            window.add("user-" + std::to_string(minute * 7 + i), start + minute * 60);
+        }
+    }
+    REQUIRE(window.cardinality(start + 3599) > 400);
+    REQUIRE(window.cardinality(start + 3599) < 460);
+    // 61 dense buckets would hold about 1 MB of registers
+    REQUIRE(window.memory_bytes() < 64 * 1024);
+}
+
+TEST_CASE("SlidingHyperLogLog expires buckets outside the window") {
+    using engagehub::SlidingHyperLogLog;
+    SlidingHyperLogLog window(3600, 60);
+    REQUIRE(window.bucket_count() == 61);
+
+    const std::int64_t start = 1696284000;
+    for (int i = 0; i < 1000; ++i) {
+        window.add("early-" + std::to_string(i), start);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        window.add("late-" + std::to_string(i), start + 1800);
+    }
+
+    const auto both = window.cardinality(start + 1800);
+    REQUIRE(both > 1900);
+    REQUIRE(both < 2100);
+    // cached read returns the same value without rebuilding
+    REQUIRE(window.cardinality(start + 1800) == both);
+
+    // only the late bucket survives once the early one is more than an hour old
+    const auto late_only = window.cardinality(start + 3700);
+    REQUIRE(late_only > 950);
+    REQUIRE(late_only < 1050);
+
+    // a bucket reusing an expired slot starts from scratch
+    window.add("fresh", start + 3660);
+    const auto after_wrap = window.cardinality(start + 3660);
+    REQUIRE(after_wrap > 950);
+    REQUIRE(after_wrap < 1060);
+
+    REQUIRE(window.cardinality(start + 3 * 3600) == 0);
+
+    // an event stamped ahead of the clock stays out of both read paths
+    // until its bucket starts
+    window.add("ahead", start + 3 * 3600 + 120);
+    engagehub::HyperLogLog merged(window.precision());
+    window.merge_window(start + 3 * 3600, 3600, merged);
+    REQUIRE(merged.cardinality() == 0);
+    REQUIRE(window.cardinality(start + 3 * 3600) == 0);
+    REQUIRE(window.cardinality(start + 3 * 3600 + 120) == 1);
+}
+
+TEST_CASE("Sketches round-trip through their binary form") {
+    using engagehub::ByteReader;
+    using engagehub::ByteWriter;
+    using engagehub::SlidingHyperLogLog;
+
+    CountMinSketch<256, 4> channels;
+    channels.increment("alpha", 40);
+    channels.increment("beta", 3);
+    std::string bytes;
+    ByteWriter writer(bytes);
+    channels.serialize(writer);
+    // idle counters are one varint byte each
+    REQUIRE(bytes.size() < 256 * 4 + 64);
+
+    CountMinSketch<> restored(256, 4);
+    ByteReader reader(bytes);
+    restored.merge_serialized(reader);
+    REQUIRE(reader.remaining() == 0);
+    REQUIRE(restored.estimate("alpha") == channels.estimate("alpha"));
+    restored.merge(channels);
+    REQUIRE(restored.estimate("beta") == 2 * channels.estimate("beta"));
+
+    CountMinSketch<> other_shape(512, 4);
+    ByteReader mismatched(bytes);
+    REQUIRE_THROWS_AS(other_shape.merge_serialized(mismatched), std::invalid_argument);
+
+    HyperLogLog sparse;
+    HyperLogLog dense;
+    for (int i = 0; i < 20000; ++i) {
+        dense.add("user-" + std::to_string(i));
+        if (i < 50) {
+            sparse.add("user-" + std::to_string(i));
+        }
+    }
+    for (const auto* sketch : {&sparse, &dense}) {
+        std::string encoded;
+        ByteWriter out(encoded);
+        sketch->serialize(out);
+        ByteReader in(encoded);
+        const auto copy = HyperLogLog::deserialize(in);
+        REQUIRE(copy.is_sparse() == sketch->is_sparse());
+        REQUIRE(copy.cardinality() == sketch->cardinality());
+
+        // dropping the last byte must fail cleanly rather than read past the end
+        ByteReader truncated(std::string_view(encoded).substr(0, encoded.size() - 1));
+        REQUIRE_THROWS_AS(HyperLogLog::deserialize(truncated), std::runtime_error);
+    }
+
+    const std::int64_t start = 1696284000;
+    SlidingHyperLogLog window(3600, 60);
+    for (int i = 0; i < 500; ++i) {
+        window.add("user-" + std::to_string(i), start + (i % 30) * 60);
+    }
+    std::string ring;
+    ByteWriter ring_out(ring);
+    window.serialize(ring_out);
+    ByteReader ring_in(ring);
+    auto copy = SlidingHyperLogLog::deserialize(ring_in);
+    REQUIRE(copy.cardinality(start + 1800) == window.cardinality(start + 1800));
+}
+
+TEST_CASE("SlidingHyperLogLog merge unions matching buckets and keeps newer ones") {
+    using engagehub::SlidingHyperLogLog;
+    const std::int64_t start = 1696284000;
+    SlidingHyperLogLog lhs(3600, 60);
+    SlidingHyperLogLog rhs(3600, 60);
+    for (int i = 0; i < 1000; ++i) {
+        lhs.add("shared-" + std::to_string(i), start);
+        rhs.add("shared-" + std::to_string(i), start);
+        rhs.add("other-" + std::to_string(i), start + 600);
+    }
+    lhs.merge(rhs);
+    const auto merged = lhs.cardinality(start + 600);
+    REQUIRE(merged > 1900);
+    REQUIRE(merged < 2100);
+
+    // merging is idempotent
+    lhs.merge(rhs);
+    REQUIRE(lhs.cardinality(start + 600) == merged);
+
+    // a slot already holding a newer bucket ignores the expired one
+    SlidingHyperLogLog newer(3600, 60);
+    newer.add("fresh", start + 3660);
+    newer.merge(rhs);
+    REQUIRE(newer.cardinality(start + 3660) < 1100);
+
+    SlidingHyperLogLog coarse(3600, 300);
+    REQUIRE_THROWS_AS(lhs.merge(coarse), std::invalid_argument);
+}
+
+TEST_CASE("KeyedSlidingHyperLogLog counts per key and evicts the stalest keys") {
+    using engagehub::KeyedSlidingHyperLogLog;
+    const std::int64_t start = 1696284000;
+
+    KeyedSlidingHyperLogLog family(1024 * 1024);
+    for (int i = 0; i < 3000; ++i) {
+        const auto hash = HyperLogLog::hash("user-" + std::to_string(i));
+        family.add_hash(1, hash, start);
+        if (i < 100) {
+            family.add_hash(2, hash, start + 1800);
+        }
+    }
+    REQUIRE(family.key_count() == 2);
+    const auto busy = family.cardinality(1, start + 1800, 3600);
+    REQUIRE(busy > 2850);
+    REQUIRE(busy < 3150);
+    const auto quiet = family.cardinality(2, start + 1800, 3600);
+    REQUIRE(quiet > 95);
+    REQUIRE(quiet < 105);
+    // the shorter window only reaches key 2's recent bucket
+    REQUIRE(family.cardinality(1, start + 1800, 600) == 0);
+    REQUIRE(family.cardinality(2, start + 1800, 600) == quiet);
+    REQUIRE(family.cardinality(3, start + 1800, 3600) == 0);
+    REQUIRE_THROWS_AS(family.cardinality(1, start, 7200), std::invalid_argument);
+
+    // windows shorter than the five-minute bucket still read the bucket in
+    // progress, and a longer one reads the oldest bucket it partly covers
+    KeyedSlidingHyperLogLog recent(1024 * 1024);
+    for (int i = 0; i < 100; ++i) {
+        recent.add_hash(7, HyperLogLog::hash("user-" + std::to_string(i)), start + 200);
+    }
+    for (const std::int64_t window : {1, 60, 120, 250, 300}) {
+        REQUIRE(recent.cardinality(7, start + 200, window) > 95);
+        REQUIRE(recent.cardinality(7, start + 200, window) < 105);
+    }
+    REQUIRE(recent.cardinality(7, start + 590, 300) > 95);
+    REQUIRE(recent.cardinality(7, start + 600, 300) == 0);
+
+    // keys are built without the cached union, which would add a second
+    // dense array to a busy key
+    engagehub::SlidingHyperLogLog cached(3600, 300, 12);
+    engagehub::SlidingHyperLogLog uncached(3600, 300, 12, false);
+    for (int i = 0; i < 3000; ++i) {
+        const auto hash = HyperLogLog::hash("user-" + std::to_string(i));
+        cached.add_hash(hash, start);
+        uncached.add_hash(hash, start);
+    }
+    REQUIRE(cached.memory_bytes() - uncached.memory_bytes() >= 4096);
+    HyperLogLog merged(12);
+    uncached.merge_window(start + 1800, 3600, merged);
+    REQUIRE(merged.cardinality() == cached.cardinality(start + 1800));
+    REQUIRE(uncached.cardinality(start + 1800) == cached.cardinality(start + 1800));
+
+    // a budget of a few quiet keys keeps only the most recently updated ones
+    KeyedSlidingHyperLogLog small(8 * 1024);
+    for (std::uint32_t key = 0; key < 64; ++key) {
+        small.add_hash(key, HyperLogLog::hash("user-" + std::to_string(key)), start);
+    }
+    REQUIRE(small.memory_bytes() <= small.memory_budget());
+    REQUIRE(small.evictions() == 64 - small.key_count());
+    REQUIRE(small.contains(63));
+    REQUIRE_FALSE(small.contains(0));
+}
+
+TEST_CASE("StringInterner hands out stable dense ids") {
+    engagehub::StringInterner strings;
+    const auto general = strings.intern("general");
+    const auto random = strings.intern("random");
+
+    REQUIRE(general != random);
+    REQUIRE(strings.intern("general") == general);
+    REQUIRE(strings.resolve(random) == "random");
+    REQUIRE(strings.hash_of(general) == HyperLogLog::hash("general"));
+    REQUIRE(strings.size() == 2);
+
+    for (int i = 0; i < 10000; ++i) {
+        strings.intern("user-" + std::to_string(i));
+    }
+    REQUIRE(strings.resolve(general) == "general");
+    REQUIRE(strings.resolve(strings.intern("user-9999")) == "user-9999");
+}
+
+TEST_CASE("SpaceSaving keeps heavy hitters in bounded memory") {
+    engagehub::SpaceSaving summary(64);
+
+    // three hot keys hidden in a long tail of one-off keys
+    for (std::uint32_t i = 0; i < 5000; ++i) {
+        summary.offer(1000 + i);
+        if (i % 5 == 0) {
+            summary.offer(1);
+        }
+        if (i % 10 == 0) {
+            summary.offer(2);
+        }
+        if (i % 25 == 0) {
+            summary.offer(3);
+        }
+    }
+
+    REQUIRE(summary.size() == 64);
+    REQUIRE(summary.total() == 5000 + 1000 + 500 + 200);
+
+    const auto top = summary.top_k(3);
+    REQUIRE(top.size() == 3);
+    REQUIRE(top[0].key == 1);
+    REQUIRE(top[1].key == 2);
+    REQUIRE(top[2].key == 3);
+    for (const auto& entry : top) {
+        REQUIRE(entry.error <= summary.error_bound());
+    }
+    REQUIRE(top[0].count >= 1000);
+    REQUIRE(top[0].count - top[0].error <= 1000);
+    REQUIRE(summary.error_bound() <= summary.total() / summary.capacity());
+
+    // ordering holds for weighted offers too
+    summary.offer(3, 10000);
+    REQUIRE(summary.top_k(1).front().key == 3);
+}
@@ -0,0 +1,624 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "batch_queue.hpp"
+#include "event_processor.hpp"
+#include "leaderboard_sink.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <poll.h>
+
+using engagehub::BatchQueue;
+using engagehub::Event;
+using engagehub::EventBatch;
+using engagehub::EventStreamProcessor;
+using engagehub::LeaderboardSink;
+using engagehub::MetricsMode;
+using engagehub::OverflowPolicy;
+
+namespace {
+bool readable(int fd) {
+    pollfd entry{fd, POLLIN, 0};
+    return ::poll(&entry, 1, 0) == 1;
+}
+
+std::int64_t now_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
+TEST_CASE("Sharded EventStreamProcessor merges shard statistics") {
+    EventStreamProcessor processor(4096, 2, 64, 50, 4);
+    REQUIRE(processor.shard_count() == 4);
+
+    std::atomic<int> flushed{0};
+    processor.set_flush_callback([&flushed](EventBatch events) {
+        flushed.fetch_add(static_cast<int>(events.size()), std::memory_order_relaxed);
+    });
+
+    const auto now = now_seconds();
+    for (int i = 0; i < 1000; ++i) {
+        const std::string channel = "channel-" + std::to_string(i % 8);
+        const std::string user = "user-" + std::to_string(i % 100);
+        REQUIRE(processor.push_event("message", user, channel, now));
+    }
+    // one channel is clearly hotter than the rest
+    for (int i = 0; i < 200; ++i) {
+        REQUIRE(processor.push_event("reaction", "user-0", "channel-hot", now));
+    }
+
+    processor.flush_now();
+
+    REQUIRE(flushed.load() == 1200);
+    REQUIRE(processor.total_events_processed() == 1200);
+    REQUIRE(processor.events_dropped() == 0);
+
+    const auto top = processor.get_top_channels(3);
+    REQUIRE(top.size() == 3);
+    REQUIRE(top[0].first == "channel-hot");
+    REQUIRE(top[0].second == 200);
+    REQUIRE(top[1].second == 125);
+
+    REQUIRE(processor.top_channels_error_bound() == 0);
+    REQUIRE(processor.estimate_channel_count("channel-hot") >= 200);
+    REQUIRE(processor.estimate_channel_count("never-seen") == 0);
+
+    const auto unique = processor.get_unique_users_last_hour();
+    REQUIRE(unique >= 95);
+    REQUIRE(unique <= 105);
+}
+
+TEST_CASE("push_events enqueues a batch and reports partial drops") {
+    EventStreamProcessor processor(16, 1, 1024, 10000);
+
+    std::vector<Event> events;
+    const auto now = now_seconds();
+    for (int i = 0; i < 40; ++i) {
+        events.push_back(processor.make_event("message", "user-" + std::to_string(i), "general", now));
+    }
+
+    // the consumer can drain concurrently, but never more than the whole batch fits
+    const auto accepted = processor.push_events(std::move(events));
+    REQUIRE(accepted >= 16);
+    REQUIRE(accepted <= 40);
+    REQUIRE(processor.events_dropped() == 40 - accepted);
+
+    EventStreamProcessor multi(1024, 1, 8, 10, 4);
+    std::vector<Event> sharded;
+    for (int i = 0; i < 32; ++i) {
+        sharded.push_back(multi.make_event("message", "user", "channel-" + std::to_string(i % 4), now));
+    }
+    std::atomic<int> flushed{0};
+    multi.set_flush_callback([&flushed](EventBatch batch) {
+        flushed.fetch_add(static_cast<int>(batch.size()), std::memory_order_relaxed);
+    });
+    REQUIRE(multi.push_events(std::move(sharded)) == 32);
+    multi.flush_now();
+    REQUIRE(flushed.load() == 32);
+    REQUIRE(multi.get_top_channels(4).size() == 4);
+}
+
+TEST_CASE("Block overflow policy waits for the consumer instead of dropping") {
+    EventStreamProcessor processor(8, 1, 16, 10, 1, 1024, OverflowPolicy::Block, 5000);
+    std::atomic<int> flushed{0};
+    processor.set_flush_callback([&flushed](EventBatch batch) {
+        flushed.fetch_add(static_cast<int>(batch.size()), std::memory_order_relaxed);
+    });
+
+    const auto now = now_seconds();
+    std::vector<Event> events;
+    for (int i = 0; i < 500; ++i) {
+        events.push_back(processor.make_event("message", "user-" + std::to_string(i), "general", now));
+    }
+    REQUIRE(processor.push_events(std::move(events)) == 500);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&processor, p, now]() {
+            for (int i = 0; i < 250; ++i) {
+                processor.push_event("reaction", std::to_string(p * 1000 + i), "random", now);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    processor.flush_now();
+
+    REQUIRE(processor.events_dropped() == 0);
+    REQUIRE(processor.total_events_processed() == 1500);
+    REQUIRE(flushed.load() == 1500);
+}
+
+TEST_CASE("OverwriteOldest overflow policy evicts one queued event per overflow") {
+    EventStreamProcessor processor(8, 1, 1024, 10000, 1, 1024, OverflowPolicy::OverwriteOldest, 5000);
+    std::mutex mutex;
+    std::vector<std::string> users;
+    processor.set_flush_callback([&](EventBatch batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& event : batch.events()) {
+            users.push_back(batch.user_id(event));
+        }
+    });
+
+    const auto now = now_seconds();
+    std::vector<Event> events;
+    for (int i = 0; i < 64; ++i) {
+        events.push_back(processor.make_event("message", std::to_string(i), "general", now));
+    }
+    REQUIRE(processor.push_events(std::move(events)) == 64);
+    processor.flush_now();
+
+    // the first reservation fits at most the 8 ring slots; every event past
+    // that evicts one queued event
+    REQUIRE(processor.events_dropped() == 0);
+    REQUIRE(processor.events_overwritten() == 56);
+    REQUIRE(processor.total_events_processed() == 8);
+    REQUIRE(users.size() == 8);
+}
+
+TEST_CASE("OverwriteOldest loses one event per overflow when pushes time out") {
+    EventStreamProcessor processor(8, 1, 1024, 10000, 1, 1024, OverflowPolicy::OverwriteOldest, 0);
+    processor.set_flush_callback([](EventBatch) {});
+
+    const auto now = now_seconds();
+    std::vector<Event> events;
+    for (int i = 0; i < 4096; ++i) {
+        events.push_back(processor.make_event("message", std::to_string(i), "general", now));
+    }
+    const auto accepted = processor.push_events(std::move(events));
+    processor.flush_now();
+
+    // an overflow either evicts a queued event or is dropped itself, never both
+    const auto overwritten = processor.events_overwritten();
+    REQUIRE(accepted + processor.events_dropped() == 4096);
+    REQUIRE(overwritten + processor.events_dropped() <= 4096 - 8);
+    REQUIRE(processor.total_events_processed() + overwritten == accepted);
+}
+
+TEST_CASE("Flushed batches resolve interned ids back to strings") {
+    EventStreamProcessor processor(256, 1, 4, 10);
+
+    std::mutex mutex;
+    std::vector<std::string> seen;
+    bool copies_share = true;
+    processor.set_flush_callback([&](EventBatch batch) {
+        const EventBatch copy = batch;
+        std::lock_guard<std::mutex> lock(mutex);
+        copies_share = copies_share && copy.events().data() == batch.events().data();
+        for (const auto& event : batch.events()) {
+            seen.push_back(batch.event_type(event) + ":" + batch.user_id(event) + "@" + batch.channel_id(event));
+        }
+    });
+
+    const auto now = now_seconds();
+    REQUIRE(processor.push_event("message", "42", "general", now));
+    REQUIRE(processor.push_event("reaction", "42", "random", now));
+    REQUIRE(processor.push_event("message", "7", "general", now));
+    processor.flush_now();
+
+    std::sort(seen.begin(), seen.end());
+    REQUIRE(seen == std::vector<std::string>{"message:42@general", "message:7@general", "reaction:42@random"});
+    REQUIRE(copies_share);
+    REQUIRE(EventBatch().empty());
+}
+
+TEST_CASE("Queries read published snapshots while ingest runs") {
+    EventStreamProcessor processor(8192, 2, 128, 20, 2);
+    std::atomic<int> flushed{0};
+    processor.set_flush_callback([&flushed](EventBatch batch) {
+        flushed.fetch_add(static_cast<int>(batch.size()), std::memory_order_relaxed);
+    });
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> oversized{false};
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_acquire)) {
+            if (processor.get_top_channels(4).size() > 4) {
+                oversized.store(true);
+            }
+            processor.get_unique_users_last_hour();
+        }
+    });
+
+    const auto now = now_seconds();
+    int pushed = 0;
+    for (int i = 0; i < 20000; ++i) {
+        const std::string channel = "channel-" + std::to_string(i % 4);
+        if (processor.push_event("message", "user-" + std::to_string(i % 500), channel, now)) {
+            ++pushed;
+        }
+    }
+    processor.flush_now();
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    REQUIRE_FALSE(oversized.load());
+    REQUIRE(flushed.load() == pushed);
+    std::uint64_t counted = 0;
+    for (const auto& entry : processor.get_top_channels(4)) {
+        counted += entry.second;
+    }
+    REQUIRE(counted == static_cast<std::uint64_t>(pushed));
+    const auto unique = processor.get_unique_users_last_hour();
+    REQUIRE(unique > 475);
+    REQUIRE(unique < 525);
+}
+
+TEST_CASE("Throwing flush callbacks are counted and do not stall flush_now") {
+    EventStreamProcessor processor(256, 2, 2, 10);
+    std::atomic<int> delivered{0};
+    processor.set_flush_callback([&delivered](EventBatch batch) {
+        delivered.fetch_add(static_cast<int>(batch.size()));
+        throw std::runtime_error("sink unavailable");
+    });
+
+    const auto now = now_seconds();
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(processor.push_event("message", std::to_string(i), "general", now));
+    }
+    processor.flush_now();
+
+    REQUIRE(delivered.load() == 4);
+    // The pool records the failure just after the task's own bookkeeping.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (processor.flush_callback_failures() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    REQUIRE(processor.flush_callback_failures() >= 1);
+}
+
+TEST_CASE("Sketch snapshots restore and merge across processors") {
+    const auto now = now_seconds();
+    EventStreamProcessor first(4096, 1, 64, 10, 2);
+    EventStreamProcessor second(4096, 1, 64, 10, 1);
+    // flush_now waits for pending batches to be delivered
+    first.set_flush_callback([](EventBatch) {});
+    second.set_flush_callback([](EventBatch) {});
+    for (int i = 0; i < 600; ++i) {
+        REQUIRE(first.push_event("message", "user-" + std::to_string(i), "general", now));
+        REQUIRE(second.push_event("message", "user-" + std::to_string(i + 300), "random", now));
+    }
+    first.flush_now();
+    second.flush_now();
+
+    const auto snapshot = first.serialize_sketches();
+
+    // warm restart: a fresh processor picks up where the old one stopped
+    EventStreamProcessor restarted(4096, 1, 64, 10, 4);
+    restarted.merge_from(snapshot);
+    REQUIRE(restarted.get_unique_users_last_hour() == first.get_unique_users_last_hour());
+    REQUIRE(restarted.estimate_channel_count("general") == first.estimate_channel_count("general"));
+
+    // a central aggregator unions users and adds channel counts
+    second.merge_from(snapshot);
+    const auto unique = second.get_unique_users_last_hour();
+    REQUIRE(unique > 855);
+    REQUIRE(unique < 945);
+    REQUIRE(second.estimate_channel_count("general") >= 600);
+    REQUIRE(second.estimate_channel_count("random") >= 600);
+
+    const std::string path = "engagehub_test_sketches.bin";
+    second.save_sketches(path);
+    EventStreamProcessor loaded(4096, 1, 64, 10);
+    loaded.load_sketches(path);
+    std::remove(path.c_str());
+    REQUIRE(loaded.get_unique_users_last_hour() == unique);
+    REQUIRE(loaded.estimate_channel_count("random") == second.estimate_channel_count("random"));
+}
+
+TEST_CASE("Corrupt sketch snapshots are rejected without side effects") {
+    const auto now = now_seconds();
+    EventStreamProcessor source(1024, 1, 8, 10);
+    source.set_flush_callback([](EventBatch) {});
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE(source.push_event("message", std::to_string(i), "general", now));
+    }
+    source.flush_now();
+    const auto snapshot = source.serialize_sketches();
+
+    EventStreamProcessor target(1024, 1, 8, 10);
+    REQUIRE_THROWS_AS(target.merge_from(snapshot.substr(0, snapshot.size() / 2)), std::runtime_error);
+    auto flipped = snapshot;
+    flipped[flipped.size() / 2] ^= 0x01;
+    REQUIRE_THROWS_AS(target.merge_from(flipped), std::runtime_error);
+    auto future_version = snapshot;
+    future_version[4] = 2;
+    REQUIRE_THROWS_AS(target.merge_from(future_version), std::runtime_error);
+    REQUIRE_THROWS_AS(target.load_sketches("does-not-exist.bin"), std::runtime_error);
+
+    REQUIRE(target.get_unique_users_last_hour() == 0);
+    REQUIRE(target.estimate_channel_count("general") == 0);
+}
+
+TEST_CASE("Unique users are counted per channel and per event type") {
+    EventStreamProcessor processor(4096, 1, 64, 10, 2);
+    processor.set_flush_callback([](EventBatch) {});
+    const auto now = now_seconds();
+    for (int i = 0; i < 400; ++i) {
+        const auto user = "user-" + std::to_string(i);
+        REQUIRE(processor.push_event("message", user, "general", now));
+        if (i % 4 == 0) {
+            REQUIRE(processor.push_event("reaction", user, "random", now));
+        }
+    }
+    processor.flush_now();
+
+    REQUIRE(processor.get_unique_users("general") > 380);
+    REQUIRE(processor.get_unique_users("general") < 420);
+    const auto random = processor.get_unique_users("random", 300);
+    REQUIRE(random > 95);
+    REQUIRE(random < 105);
+    REQUIRE(processor.get_unique_users("never-seen") == 0);
+    // "message" events landed on whichever shards own their channels
+    REQUIRE(processor.get_unique_users_by_event_type("message") > 380);
+    REQUIRE(processor.get_unique_users_by_event_type("reaction") == random);
+    REQUIRE_THROWS_AS(processor.get_unique_users("general", 0), std::invalid_argument);
+    REQUIRE(processor.dimension_memory_bytes() > 0);
+    REQUIRE(processor.dimension_evictions() == 0);
+
+    EventStreamProcessor disabled(1024, 1, 64, 10, 1, 1024, OverflowPolicy::Drop, 100, 0);
+    disabled.set_flush_callback([](EventBatch) {});
+    REQUIRE(disabled.push_event("message", "user", "general", now));
+    disabled.flush_now();
+    REQUIRE(disabled.get_unique_users("general") == 0);
+    REQUIRE(disabled.get_unique_users_last_hour() == 1);
+}
+
+TEST_CASE("Pipeline metrics report counters, gauges and stage latencies") {
+    EventStreamProcessor processor(4096, 1, 16, 10, 2);
+    REQUIRE(processor.metrics_mode() == MetricsMode::Sampled);
+    processor.set_metrics_mode(MetricsMode::Full);
+    processor.set_flush_callback([](EventBatch) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    const auto now = now_seconds();
+    for (int i = 0; i < 320; ++i) {
+        REQUIRE(processor.push_event("message", std::to_string(i), "channel-" + std::to_string(i % 2), now));
+    }
+    processor.flush_now();
+
+    const auto metrics = processor.get_metrics();
+    REQUIRE(metrics.events_processed == 320);
+    REQUIRE(metrics.batches_flushed >= 20);
+    REQUIRE(metrics.pending_flush_tasks == 0);
+    REQUIRE(metrics.enqueue_to_flush_us.count == 320);
+    REQUIRE(metrics.callback_us.count == metrics.batches_flushed);
+    REQUIRE(metrics.callback_us.p50 >= 1000);
+    REQUIRE(metrics.flush_queue_us.count == metrics.batches_flushed);
+    REQUIRE(metrics.shards.size() == 2);
+    for (const auto& shard : metrics.shards) {
+        REQUIRE(shard.ring_occupancy == 0);
+        REQUIRE(shard.ring_capacity >= 2048);
+        REQUIRE(shard.pending_batch == 0);
+    }
+    REQUIRE(metrics.consumer_busy_ratio >= 0.0);
+    REQUIRE(metrics.consumer_busy_ratio <= 1.0);
+
+    // sampled mode stamps one push in kMetricsSampleInterval per thread
+    processor.reset_latency_metrics();
+    processor.set_metrics_mode(MetricsMode::Sampled);
+    for (int i = 0; i < 640; ++i) {
+        REQUIRE(processor.push_event("message", std::to_string(i), "general", now));
+    }
+    processor.flush_now();
+    REQUIRE(processor.get_metrics().enqueue_to_flush_us.count ==
+            640 / EventStreamProcessor::kMetricsSampleInterval);
+
+    processor.reset_latency_metrics();
+    processor.set_metrics_mode(MetricsMode::Off);
+    REQUIRE(processor.push_event("message", "late", "general", now));
+    processor.flush_now();
+    const auto quiet = processor.get_metrics();
+    REQUIRE(quiet.enqueue_to_flush_us.count == 0);
+    REQUIRE(quiet.callback_us.count == 0);
+    REQUIRE(quiet.events_processed == 961);
+}
+
+TEST_CASE("Spill journal makes overflow and failing callbacks lossless") {
+    const auto directory = (std::filesystem::temp_directory_path() / "engagehub_test_spill_overflow").string();
+    std::filesystem::remove_all(directory);
+
+    EventStreamProcessor processor(16, 2, 8, 10);
+    processor.enable_spill_journal(directory, 4096, 0);
+    REQUIRE(processor.spill_journal_enabled());
+    REQUIRE_THROWS_AS(processor.enable_spill_journal(directory), std::runtime_error);
+
+    std::atomic<bool> failing{true};
+    std::mutex delivered_mutex;
+    std::vector<std::string> delivered;
+    processor.set_flush_callback([&](EventBatch batch) {
+        if (failing.load()) {
+            throw std::runtime_error("sink unavailable");
+        }
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        for (const auto& event : batch.events()) {
+            delivered.push_back(batch.user_id(event));
+        }
+    });
+
+    const auto now = now_seconds();
+    std::vector<Event> events;
+    for (int i = 0; i < 200; ++i) {
+        events.push_back(processor.make_event("message", "user-" + std::to_string(i), "general", now));
+    }
+    // everything the 16-slot ring cannot take goes to the journal
+    REQUIRE(processor.push_events(std::move(events)) == 200);
+    REQUIRE(processor.events_dropped() == 0);
+    REQUIRE(processor.events_spilled() > 0);
+    processor.flush_now();
+
+    failing.store(false);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    do {
+        processor.flush_now();
+    } while (processor.spilled_pending() != 0 && std::chrono::steady_clock::now() < deadline);
+
+    REQUIRE(processor.spilled_pending() == 0);
+    REQUIRE(processor.events_dropped() == 0);
+    REQUIRE(processor.total_events_processed() == 200);
+    std::lock_guard<std::mutex> lock(delivered_mutex);
+    std::sort(delivered.begin(), delivered.end());
+    REQUIRE(delivered.size() == 200);
+    REQUIRE(std::adjacent_find(delivered.begin(), delivered.end()) == delivered.end());
+
+    const auto metrics = processor.get_metrics();
+    REQUIRE(metrics.events_spilled == processor.events_spilled());
+    REQUIRE(metrics.events_replayed == metrics.events_spilled);
+    REQUIRE(metrics.spill_pending_records == 0);
+}
+
+TEST_CASE("Spill journal holds batches without a callback across a restart") {
+    const auto directory = (std::filesystem::temp_directory_path() / "engagehub_test_spill_restart").string();
+    std::filesystem::remove_all(directory);
+    const auto now = now_seconds();
+    {
+        // without a journal these batches would pile up in memory
+        EventStreamProcessor processor(1024, 1, 8, 10);
+        processor.enable_spill_journal(directory);
+        for (int i = 0; i < 50; ++i) {
+            REQUIRE(processor.push_event("message", "user-" + std::to_string(i), "general", now));
+        }
+        processor.flush_now();
+        REQUIRE(processor.events_spilled() == 50);
+        REQUIRE(processor.spilled_pending() > 0);
+        REQUIRE(processor.get_metrics().shards.front().pending_batch == 0);
+    }
+
+    EventStreamProcessor restarted(1024, 1, 8, 10);
+    std::mutex delivered_mutex;
+    std::vector<std::string> delivered;
+    restarted.set_flush_callback([&](EventBatch batch) {
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        for (const auto& event : batch.events()) {
+            delivered.push_back(batch.user_id(event) + "@" + batch.channel_id(event) + "@" +
+                                std::to_string(event.timestamp));
+        }
+    });
+    restarted.enable_spill_journal(directory);
+    restarted.flush_now();
+
+    REQUIRE(restarted.spilled_pending() == 0);
+    REQUIRE(restarted.events_replayed() == 50);
+    {
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        REQUIRE(delivered.size() == 50);
+        const auto suffix = "@general@" + std::to_string(now);
+        REQUIRE(delivered.front() == "user-0" + suffix);
+        REQUIRE(delivered.back() == "user-49" + suffix);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("BatchQueue hands batches to an event loop through a readable descriptor") {
+    auto queue = std::make_shared<BatchQueue>(2);
+    REQUIRE_FALSE(readable(queue->fd()));
+    REQUIRE_FALSE(queue->try_pop());
+
+    EventStreamProcessor processor(1024, 1, 8, 10);
+    processor.set_flush_callback(BatchQueue::sink(queue));
+    const auto now = now_seconds();
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(processor.push_event("message", "user-" + std::to_string(i), "general", now));
+    }
+    processor.flush_now();
+
+    REQUIRE(queue->size() == 2);
+    REQUIRE(readable(queue->fd()));
+    const auto first = queue->try_pop();
+    REQUIRE(first);
+    REQUIRE(first->size() == 8);
+    REQUIRE(first->user_id((*first)[0]).rfind("user-", 0) == 0);
+    // still readable while a batch is queued, quiet once drained
+    REQUIRE(readable(queue->fd()));
+    REQUIRE(queue->try_pop()->size() == 8);
+    REQUIRE_FALSE(readable(queue->fd()));
+
+    // a full queue fails the delivery instead of blocking the worker
+    for (int i = 0; i < 24; ++i) {
+        REQUIRE(processor.push_event("message", "late-" + std::to_string(i), "general", now));
+    }
+    processor.flush_now();
+    REQUIRE(queue->size() == 2);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (processor.flush_callback_failures() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    REQUIRE(processor.flush_callback_failures() == 1);
+
+    // closing wakes the reader; queued batches still drain
+    queue->close();
+    REQUIRE(queue->closed());
+    REQUIRE(readable(queue->fd()));
+    REQUIRE(queue->try_pop());
+    REQUIRE(queue->try_pop());
+    REQUIRE_FALSE(queue->try_pop());
+    REQUIRE(readable(queue->fd()));
+    EventBatch rejected;
+    REQUIRE_FALSE(queue->push(rejected));
+}
+
+TEST_CASE("LeaderboardSink scores flushed batches into every board natively") {
+    using engagehub::leaderboard::Leaderboard;
+    const auto now = now_seconds();
+    auto weekly = std::make_shared<Leaderboard>(0.95, 100);
+    auto all_time = std::make_shared<Leaderboard>(0.95, 100);
+    for (const auto& board : {weekly, all_time}) {
+        board->set_time_source([now]() { return now; });
+    }
+    auto sink = std::make_shared<LeaderboardSink>(std::vector<std::shared_ptr<Leaderboard>>{weekly, all_time},
+                                                  std::unordered_map<std::string, double>{{"message", 1.0},
+                                                                                          {"reaction", 2.5}});
+
+    EventStreamProcessor processor(1024, 2, 8, 10, 2);
+    // the stage alone is enough for batches to flush
+    processor.add_flush_stage(LeaderboardSink::stage(sink));
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(processor.push_event("message", "alice", "general", now));
+    }
+    for (int i = 0; i < 2; ++i) {
+        REQUIRE(processor.push_event("reaction", "bob", "random", now));
+    }
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(processor.push_event("join", "carol", "general", now));
+    }
+    processor.flush_now();
+
+    REQUIRE(sink->events_scored() == 5);
+    for (const auto& board : {weekly, all_time}) {
+        const auto top = board->get_top_users(5);
+        REQUIRE(top.size() == 2);
+        REQUIRE(top[0].user_id == "bob");
+        REQUIRE(top[0].score == 5.0);
+        REQUIRE(top[1].user_id == "alice");
+        REQUIRE(top[1].score == 3.0);
+    }
+
+    // stages run ahead of the callback, and the callback still sees every batch
+    std::atomic<std::size_t> delivered{0};
+    processor.set_flush_callback([&](EventBatch batch) { delivered.fetch_add(batch.size()); });
+    REQUIRE(processor.push_event("message", "carol", "general", now));
+    processor.flush_now();
+    REQUIRE(delivered.load() == 1);
+    REQUIRE(weekly->get_user_rank("carol")->score == 1.0);
+
+    processor.clear_flush_stages();
+    REQUIRE(processor.push_event("message", "carol", "general", now));
+    processor.flush_now();
+    REQUIRE(delivered.load() == 2);
+    REQUIRE(sink->events_scored() == 6);
+}
@@ -2,6 +2,7 @@
 
 #include "ring_buffer.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <vector>
@@ -71,3 +72,139 @@ TEST_CASE("LockFreeRingBuffer multi producer multi consumer") {
     REQUIRE(produced.load() == producer_count * values_per_producer);
     REQUIRE(consumed.load() == producer_count * values_per_producer);
 }
+
+TEST_CASE("LockFreeRingBuffer try_push_bulk reserves what fits") {
+    LockFreeRingBuffer<int, 0> buffer(8);
+    std::vector<int> values{0, 1, 2, 3, 4, 5};
+
+    REQUIRE(buffer.try_push_bulk(values.begin(), values.size()) == 6);
+    REQUIRE(buffer.try_push_bulk(values.begin(), values.size()) == 2);
+    REQUIRE(buffer.try_push_bulk(values.begin(), values.size()) == 0);
+
+    int value = -1;
+    for (int expected : {0, 1, 2, 3, 4, 5, 0, 1}) {
+        REQUIRE(buffer.pop(value));
+        REQUIRE(value == expected);
+    }
+    REQUIRE_FALSE(buffer.pop(value));
+
+    LockFreeRingBuffer<int, 4> fixed;
+    REQUIRE(fixed.try_push_bulk(values.begin(), values.size()) == 4);
+    REQUIRE(fixed.pop(value));
+    REQUIRE(value == 0);
+}
+
+TEST_CASE("LockFreeRingBuffer try_push_bulk with concurrent consumer") {
+    constexpr int total = 20000;
+    LockFreeRingBuffer<int, 0> buffer(256);
+
+    std::thread producer([&buffer]() {
+        std::vector<int> chunk(64);
+        int next = 0;
+        while (next < total) {
+            const int count = std::min<int>(64, total - next);
+            for (int i = 0; i < count; ++i) {
+                chunk[static_cast<std::size_t>(i)] = next + i;
+            }
+            std::size_t offset = 0;
+            while (offset < static_cast<std::size_t>(count)) {
+                offset += buffer.try_push_bulk(chunk.begin() + static_cast<std::ptrdiff_t>(offset),
+                                           static_cast<std::size_t>(count) - offset);
+                std::this_thread::yield();
+            }
+            next += count;
+        }
+    });
+
+    int expected = 0;
+    int value = 0;
+    bool in_order = true;
+    while (expected < total) {
+        if (buffer.pop(value)) {
+            in_order = in_order && value == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+    REQUIRE(in_order);
+    REQUIRE(buffer.empty());
+}
+
+namespace {
+template <typename Buffer>
+void check_bulk_round_trip(Buffer& buffer) {
+    std::vector<int> values{0, 1, 2, 3, 4, 5};
+    REQUIRE(buffer.try_push_bulk(values.begin(), values.size()) == 6);
+    REQUIRE(buffer.try_push_bulk(values.begin(), values.size()) == 2);
+
+    std::vector<int> out(16, -1);
+    REQUIRE(buffer.try_pop_bulk(out.begin(), 5) == 5);
+    REQUIRE(std::vector<int>(out.begin(), out.begin() + 5) == std::vector<int>{0, 1, 2, 3, 4});
+    REQUIRE(buffer.try_push_bulk(values.begin(), values.size()) == 5);
+    REQUIRE(buffer.try_pop_bulk(out.begin(), out.size()) == 8);
+    REQUIRE(std::vector<int>(out.begin(), out.begin() + 8) == std::vector<int>{5, 0, 1, 0, 1, 2, 3, 4});
+    REQUIRE(buffer.try_pop_bulk(out.begin(), out.size()) == 0);
+    REQUIRE(buffer.empty());
+
+    int value = -1;
+    REQUIRE(buffer.push(7));
+    REQUIRE(buffer.pop(value));
+    REQUIRE(value == 7);
+    REQUIRE_FALSE(buffer.pop(value));
+}
+
+template <typename Buffer>
+bool drain_in_order(Buffer& buffer, int producers, int per_producer) {
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&buffer, p, per_producer]() {
+            for (int i = 0; i < per_producer; ++i) {
+                const int value = p * per_producer + i;
+                while (!buffer.push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // values from one producer must come out in the order it pushed them
+    std::vector<int> next(static_cast<std::size_t>(producers), 0);
+    std::vector<int> chunk(32);
+    int received = 0;
+    bool in_order = true;
+    while (received < producers * per_producer) {
+        const std::size_t count = buffer.try_pop_bulk(chunk.begin(), chunk.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            const int producer = chunk[i] / per_producer;
+            in_order = in_order && chunk[i] % per_producer == next[static_cast<std::size_t>(producer)]++;
+        }
+        received += static_cast<int>(count);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return in_order && buffer.empty();
+}
+} // namespace
+
+TEST_CASE("LockFreeRingBuffer try_pop_bulk under every policy") {
+    LockFreeRingBuffer<int, 0> mpmc(8);
+    check_bulk_round_trip(mpmc);
+
+    LockFreeRingBuffer<int, 0, engagehub::ring_policy::MPSC> mpsc(8);
+    check_bulk_round_trip(mpsc);
+
+    LockFreeRingBuffer<int, 8, engagehub::ring_policy::SPSC> spsc;
+    check_bulk_round_trip(spsc);
+}
+
+TEST_CASE("LockFreeRingBuffer single-consumer policies drain concurrently") {
+    LockFreeRingBuffer<int, 0, engagehub::ring_policy::SPSC> spsc(64);
+    REQUIRE(drain_in_order(spsc, 1, 50000));
+
+    LockFreeRingBuffer<int, 0, engagehub::ring_policy::MPSC> mpsc(64);
+    REQUIRE(drain_in_order(mpsc, 4, 10000));
+
+    LockFreeRingBuffer<int, 0> mpmc(64);
+    REQUIRE(drain_in_order(mpmc, 4, 10000));
+}
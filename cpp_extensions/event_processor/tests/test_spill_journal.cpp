@@ -0,0 +1,140 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "spill_journal.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using engagehub::SpillJournal;
+
+namespace {
+std::string fresh_directory(const std::string& name) {
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(path);
+    return path.string();
+}
+
+std::size_t files_in(const std::string& directory) {
+    std::size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        (void)entry;
+        ++count;
+    }
+    return count;
+}
+} // namespace
+
+TEST_CASE("SpillJournal reads records back in order and deletes delivered segments") {
+    const auto directory = fresh_directory("engagehub_test_journal_order");
+    {
+        // small segments so the records span several files
+        SpillJournal journal(directory, 256, std::chrono::milliseconds(0));
+        for (int i = 0; i < 20; ++i) {
+            journal.append(static_cast<std::uint8_t>(i % 3), "record-" + std::to_string(i));
+        }
+        REQUIRE(journal.pending_records() == 20);
+        REQUIRE(journal.segment_count() > 1);
+
+        for (int i = 0; i < 20; ++i) {
+            const auto record = journal.peek();
+            REQUIRE(record);
+            REQUIRE(record->tag == i % 3);
+            REQUIRE(record->payload == "record-" + std::to_string(i));
+            // unacknowledged records stay at the head
+            REQUIRE(journal.peek()->offset == record->offset);
+            journal.acknowledge(*record);
+            journal.acknowledge(*record);
+        }
+        REQUIRE_FALSE(journal.peek());
+        REQUIRE(journal.pending_records() == 0);
+        REQUIRE(journal.segment_count() == 1);
+
+        // a payload larger than a segment gets one of its own
+        journal.append(7, std::string(1000, 'x'));
+        REQUIRE(journal.peek()->payload.size() == 1000);
+        journal.acknowledge(*journal.peek());
+    }
+    REQUIRE(files_in(directory) == 0);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("SpillJournal recovers pending records and stops at a torn tail") {
+    const auto directory = fresh_directory("engagehub_test_journal_recovery");
+    {
+        SpillJournal journal(directory, 4096, std::chrono::milliseconds(1000));
+        for (int i = 0; i < 5; ++i) {
+            journal.append(1, "event-" + std::to_string(i));
+        }
+        journal.acknowledge(*journal.peek());
+    }
+    {
+        SpillJournal journal(directory);
+        REQUIRE(journal.recovered_records() == 4);
+        REQUIRE(journal.peek()->payload == "event-1");
+        journal.acknowledge(*journal.peek());
+        journal.append(1, "event-5");
+        REQUIRE(journal.pending_records() == 4);
+    }
+
+    // corrupt the payload of the last record in the older segment
+    std::filesystem::path oldest;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (oldest.empty() || entry.path() < oldest) {
+            oldest = entry.path();
+        }
+    }
+    const auto size = std::filesystem::file_size(oldest);
+    std::string bytes(size, '\0');
+    {
+        std::ifstream in(oldest, std::ios::binary);
+        in.read(bytes.data(), static_cast<std::streamsize>(size));
+    }
+    const auto last = bytes.rfind("event-4");
+    REQUIRE(last != std::string::npos);
+    bytes[last] = 'E';
+    {
+        std::ofstream out(oldest, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(size));
+    }
+
+    SpillJournal journal(directory);
+    REQUIRE(journal.recovered_records() == 3);
+    std::string replayed;
+    while (const auto record = journal.peek()) {
+        replayed += record->payload + ",";
+        journal.acknowledge(*record);
+    }
+    REQUIRE(replayed == "event-2,event-3,event-5,");
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("SpillJournal survives segments left empty by a failed creation") {
+    const auto directory = fresh_directory("engagehub_test_journal_empty_segment");
+    {
+        SpillJournal journal(directory, 4096, std::chrono::milliseconds(0));
+        journal.append(1, "kept");
+    }
+    // a crash between creating a file and sizing it leaves these behind
+    std::ofstream(directory + "/segment-000000000009.log");
+    std::ofstream(directory + "/segment-000000000010.log") << "EHSJ";
+
+    SpillJournal journal(directory, 4096, std::chrono::milliseconds(0));
+    REQUIRE(journal.recovered_records() == 1);
+    REQUIRE(files_in(directory) == 1);
+
+    // a name already taken fails one append, not every later one
+    std::ofstream(directory + "/segment-000000000011.log");
+    REQUIRE_THROWS_AS(journal.append(1, "lost"), std::runtime_error);
+    journal.append(1, "next");
+    std::string replayed;
+    while (const auto record = journal.peek()) {
+        replayed += record->payload + ",";
+        journal.acknowledge(*record);
+    }
+    REQUIRE(replayed == "kept,next,");
+    std::filesystem::remove_all(directory);
+}
@@ -3,12 +3,16 @@
 #include "skip_list.hpp"
 #include "time_decay.hpp"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace engagehub::leaderboard {
@@ -22,33 +26,131 @@ struct RankEntry {
 
 using RankInfo = RankEntry;
 
+// One score change for update_users. The id only has to stay valid for the
+// duration of the call.
+struct ScoreUpdate {
+    std::string_view user_id;
+    double points;
+    std::int64_t timestamp;
+};
+
+// One bar of get_histogram: entries scoring in [lower, upper), the last
+// bar also holding `upper`.
+struct HistogramBin {
+    double lower;
+    double upper;
+    std::size_t count;
+};
+
+// Published view of the board's first top_cache_size() entries as of one
+// second. A new one is built only after a write reaches that region or the
+// clock moves on, so repeated reads share it without taking the board lock.
+struct TopSnapshot {
+    std::uint64_t version;
+    std::int64_t as_of;
+    std::vector<RankEntry> entries;
+    // `entries` as a JSON array; entry i's object ends at json_ends[i]
+    std::string json;
+    std::vector<std::size_t> json_ends;
+};
+
 class Leaderboard {
 public:
-    explicit Leaderboard(double decay_factor = 0.95, std::size_t max_users = 100000);
+    // `top_cache_size` is the K of the cached top-K view; 0 disables it.
+    explicit Leaderboard(double decay_factor = 0.95, std::size_t max_users = 100000,
+                         std::size_t top_cache_size = 100);
 
     void update_user(const std::string& user_id, double points, std::int64_t timestamp);
-
-    std::vector<RankEntry> get_top_users(std::size_t k);
-    std::optional<RankInfo> get_user_rank(const std::string& user_id);
-
-    void save_to_json(const std::string& filepath);
+    // Applies a batch under a single lock acquisition. Updates for the same
+    // user are coalesced first, so each user is repositioned once.
+    void update_users(const std::vector<ScoreUpdate>& updates);
+
+    // Queries report scores decayed to the current time without touching
+    // the list, so they cost O(log n + k).
+    std::vector<RankEntry> get_top_users(std::size_t k) const;
+    std::optional<RankInfo> get_user_rank(const std::string& user_id) const;
+    // Users ranked start..end inclusive (1-based), clipped to the board.
+    // Throws std::invalid_argument if start is 0 or after end.
+    std::vector<RankEntry> get_users_in_rank_range(std::size_t start, std::size_t end) const;
+    // Up to `radius` users on either side of `user_id`, plus the user;
+    // empty if the user is not on the board.
+    std::vector<RankEntry> get_users_around(const std::string& user_id, std::size_t radius) const;
+
+    // Distribution queries are exact and read the rank spans instead of
+    // scanning the board. A user's percentile is the share of the board, in
+    // percent, scoring strictly below them, so "top X%" is 100 minus it;
+    // empty if the user is not on the board.
+    std::optional<double> get_percentile(const std::string& user_id) const;
+    // Nearest-rank score at each quantile in [0, 1], where 0 is the lowest
+    // score; empty on an empty board. Throws std::invalid_argument for a
+    // quantile outside [0, 1].
+    std::vector<double> get_score_quantiles(const std::vector<double>& quantiles) const;
+    // `bins` equal-width bins from the lowest to the highest current score,
+    // one O(log n) descent per inner edge. A board whose scores are all
+    // equal gives one bin. Throws std::invalid_argument if bins is 0.
+    std::vector<HistogramBin> get_histogram(std::size_t bins) const;
+
+    // Current top-K view, rebuilt on demand. Null when the cache is disabled.
+    std::shared_ptr<const TopSnapshot> get_top_snapshot() const;
+    // The first k entries as a JSON array of {user_id, score, rank,
+    // last_update}; a prefix of the cached payload when k <= top_cache_size().
+    std::string get_top_users_json(std::size_t k) const;
+    // Bumped by every write that may change the top-K view.
+    std::uint64_t top_version() const noexcept { return top_version_.load(std::memory_order_acquire); }
+    std::size_t top_cache_size() const noexcept { return top_cache_size_; }
+
+    void save_to_json(const std::string& filepath) const;
     void load_from_json(const std::string& filepath);
+    // Versioned binary snapshot: settings, then every entry in rank order
+    // with its length-prefixed id, normalised key and last update, then a
+    // checksum. Saving replaces `filepath` atomically.
+    void save_snapshot(const std::string& filepath) const;
+    // Maps the file and bulk-builds the list in O(n). Throws
+    // std::runtime_error on a malformed snapshot, leaving the board as it was.
+    void load_snapshot(const std::string& filepath);
 
     std::size_t size() const;
+    // Bytes held by the list and its index, for capacity planning.
+    std::size_t memory_bytes() const;
 
     double get_current_time() const;
 
     void set_time_source(std::function<std::int64_t()> clock_fn);
 
 private:
-    void refresh_scores_locked(std::int64_t now);
-
+    void update_user_locked(const std::string& user_id, double points, std::int64_t timestamp);
+    // Starts the epoch on an empty board, or rebases before `now` outgrows it.
+    void advance_epoch_locked(std::int64_t now);
+    // Adds `key_delta` to the user's key; `scored` says whether any points
+    // were awarded, since a zero-point update never adds a user.
+    void apply_locked(std::string_view user_id, double key_delta, std::int64_t timestamp, bool scored);
+    // Re-normalises every key against `epoch` once growth since epoch_
+    // would risk overflow; the order of the list is unchanged.
+    void rebase_locked(std::int64_t epoch);
+    double score_at_locked(const SkipList::Node& node, std::int64_t now) const;
+    std::vector<RankEntry> to_entries_locked(const std::vector<const SkipList::Node*>& nodes,
+                                             std::size_t first_rank, std::int64_t now) const;
+    // Key of the K-th entry; keys at or above it are in the top-K view.
+    double top_threshold_locked() const;
+    void invalidate_top() noexcept { top_version_.fetch_add(1, std::memory_order_acq_rel); }
+    std::int64_t now() const { return (*std::atomic_load(&clock_fn_))(); }
+
+    // Node scores are keys normalised to epoch_: score * decay^-(t - epoch_).
+    // Exponential decay scales every score by the same factor, so ordering
+    // by key is ordering by decayed score at any instant.
     SkipList skip_list_;
     TimeDecay decay_;
     std::size_t max_users_;
+    std::int64_t epoch_ = 0;
+
+    // swapped atomically so the cached read path needs no lock
+    std::shared_ptr<const std::function<std::int64_t()>> clock_fn_;
+    // readers share the lock; updates and loads take it exclusively
+    mutable std::shared_mutex mutex_;
 
-    std::function<std::int64_t()> clock_fn_;
-    mutable std::mutex mutex_;
+    std::size_t top_cache_size_;
+    std::atomic<std::uint64_t> top_version_{0};
+    mutable std::shared_ptr<const TopSnapshot> top_snapshot_;
 };
 
 } // namespace engagehub::leaderboard
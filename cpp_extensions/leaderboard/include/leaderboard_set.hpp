@@ -0,0 +1,133 @@
+#pragma once
+
+#include "leaderboard.hpp"
+#include "skip_list.hpp"
+#include "time_decay.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace engagehub::leaderboard {
+
+struct BoardSpec {
+    std::string name;
+    // Tumbling window length in seconds; 0 keeps the board all-time.
+    std::int64_t window_seconds = 0;
+    // Windows tile time from this instant, e.g. a Monday 00:00 for weeks.
+    std::int64_t window_origin = 0;
+    double decay_factor = 1.0;
+    // Lowest entries are evicted past this size; 0 means unbounded.
+    std::size_t max_users = 0;
+    // Whether update_user() reaches the board without naming it; per-track
+    // and per-category boards leave this off and are named per update.
+    bool receives_all = true;
+};
+
+// Several boards over one user population, e.g. daily, weekly and all-time
+// plus one per track. Ids are interned once for the whole set and every
+// board's nodes borrow them, and one update reaches all of its boards under
+// a single lock. Windowed boards keep the window in progress and the last
+// closed one; crossing a boundary swaps the two and clears the older, so
+// rotation never rebuilds a list.
+class LeaderboardSet {
+public:
+    LeaderboardSet();
+
+    // Returns the board's index. Throws std::invalid_argument on an empty
+    // or duplicate name, a negative window or an invalid decay factor.
+    std::size_t add_board(BoardSpec spec);
+    std::vector<std::string> board_names() const;
+
+    // Adds `points` on every receives_all board plus the named ones. A
+    // windowed board rotates first if `timestamp` lies past its window, and
+    // ignores updates for windows it has already closed. Throws
+    // std::invalid_argument for an unknown board name.
+    void update_user(const std::string& user_id, double points, std::int64_t timestamp,
+                     const std::vector<std::string>& boards = {});
+    // Closes every window the clock has moved past. Writes rotate on their
+    // own; this only releases old entries sooner.
+    void rotate_windows();
+
+    // `previous_window` reads the last closed window of a windowed board.
+    // Windows the clock has left behind read as rotated even before a
+    // write rotates them. Unknown boards throw std::invalid_argument.
+    std::vector<RankEntry> get_top_users(const std::string& board, std::size_t k,
+                                         bool previous_window = false) const;
+    std::optional<RankInfo> get_user_rank(const std::string& board, const std::string& user_id,
+                                          bool previous_window = false) const;
+    // The user's entry on every board's current window, in board order.
+    std::vector<std::optional<RankInfo>> get_user_ranks(const std::string& user_id) const;
+
+    std::size_t size(const std::string& board) const;
+    // Distinct ids held by any board.
+    std::size_t interned_users() const;
+
+    void set_time_source(std::function<std::int64_t()> clock_fn);
+
+private:
+    // One list with its own decay epoch. nodes[slot] is the user's node.
+    struct Window {
+        SkipList list{16, 0.5, true};
+        std::int64_t epoch = 0;
+        std::vector<SkipList::Node*> nodes;
+
+        SkipList::Node* node(std::uint32_t slot) const {
+            return slot < nodes.size() ? nodes[slot] : nullptr;
+        }
+    };
+
+    struct Board {
+        BoardSpec spec;
+        TimeDecay decay;
+        std::unique_ptr<Window> current;
+        std::unique_ptr<Window> previous;
+        // start of the current window; unset until the first write
+        std::optional<std::int64_t> window_start;
+    };
+
+    const Board& board_locked(const std::string& name) const;
+    // Window that an update at `timestamp` lands in, rotating as needed;
+    // null for a window the board has already closed.
+    Window* writable_window_locked(Board& board, std::int64_t timestamp);
+    void rotate_locked(Board& board, std::int64_t now);
+    const Window* visible_window_locked(const Board& board, std::int64_t now, bool previous) const;
+    void apply_locked(Board& board, Window& window, std::uint32_t slot, double points, std::int64_t timestamp);
+    // Rebuilds the list against `epoch`; ranks and intern slots are kept.
+    void rebase_locked(const Board& board, Window& window, std::int64_t epoch);
+    // Drops every entry, releasing the slots no other board holds.
+    void clear_window_locked(Window& window);
+
+    std::optional<std::uint32_t> find_slot_locked(std::string_view user_id) const;
+    std::uint32_t intern_locked(std::string_view user_id);
+    void release_slot_locked(std::uint32_t slot);
+
+    double score_at_locked(const Board& board, const Window& window, const SkipList::Node& node,
+                           std::int64_t now) const;
+    std::int64_t now() const { return (*std::atomic_load(&clock_fn_))(); }
+
+    std::vector<Board> boards_;
+    std::unordered_map<std::string, std::size_t> board_index_;
+
+    // Interned ids: ids_[slot] holds the characters every node borrows and
+    // refs_[slot] counts the windows holding the user. Slots whose count
+    // returns to zero are recycled; the deque keeps the other ids in place.
+    std::deque<std::string> ids_;
+    std::vector<std::uint32_t> refs_;
+    std::vector<std::uint32_t> free_slots_;
+    std::unordered_map<std::string_view, std::uint32_t> slots_;
+
+    std::shared_ptr<const std::function<std::int64_t()>> clock_fn_;
+    // readers share the lock; updates, rotation and new boards take it exclusively
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace engagehub::leaderboard
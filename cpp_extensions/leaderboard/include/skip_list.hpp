@@ -1,59 +1,164 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <random>
-#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 namespace engagehub::leaderboard {
 
+// Ordered by descending score, ties broken by user id. Every forward link
+// also records its span, the number of level-0 steps it skips, so ranks
+// and rank ranges are found in O(log n) like in Redis sorted sets. A
+// backward link on level 0 and a tail pointer give O(1) access to the
+// lowest entry.
+//
+// Each node is a single arena block: the fixed fields, then its tower of
+// levels, then the user id's characters. The index is keyed by views of
+// those characters, so every id is stored exactly once. A list built with
+// borrowed ids instead keeps the caller's views and no index; its owner
+// finds nodes itself and addresses them through the Node* API.
 class SkipList {
 public:
     struct Node {
-        std::string user_id;
+        struct Level {
+            Node* forward = nullptr;
+            std::size_t span = 0;
+        };
+
+        std::string_view user_id;
         double score;
         std::int64_t last_update;
-        std::vector<Node*> forward;
+        Node* backward;
+        int level_count;
+        // free for the owner; LeaderboardSet keeps the id's intern slot here
+        std::uint32_t tag;
+
+        Level* levels() noexcept { return reinterpret_cast<Level*>(this + 1); }
+        const Level* levels() const noexcept { return reinterpret_cast<const Level*>(this + 1); }
+        Node* next() const noexcept { return levels()[0].forward; }
     };
 
-    SkipList(int max_levels = 16, double probability = 0.5);
+    struct BulkEntry {
+        std::string_view user_id;
+        double score;
+        std::int64_t last_update;
+    };
+
+    // With `borrow_ids`, ids must outlive their nodes and lookups by id
+    // (find, erase, rank_of by id) are unavailable.
+    SkipList(int max_levels = 16, double probability = 0.5, bool borrow_ids = false);
     ~SkipList();
 
-    Node* upsert(const std::string& user_id, double score, std::int64_t timestamp);
-    Node* find(const std::string& user_id) const;
-    bool erase(const std::string& user_id);
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+
+    Node* upsert(std::string_view user_id, double score, std::int64_t timestamp);
+    Node* find(std::string_view user_id) const;
+    bool erase(std::string_view user_id);
+    // Node-level operations for owners that track nodes themselves.
+    // insert() requires that `user_id` is not in the list yet.
+    Node* insert(std::string_view user_id, double score, std::int64_t timestamp);
+    void update(Node* node, double score, std::int64_t timestamp);
+    void remove(Node* node);
     std::size_t size() const noexcept { return size_; }
-    Node* tail() const;
+    Node* head() const noexcept { return header_->next(); }
+    Node* tail() const noexcept { return tail_; }
     void clear();
+    // Replaces the contents with `entries`, which must already be in list
+    // order with unique ids. Links are built bottom-up in one O(n) pass with
+    // deterministic levels: every (1/p)-th node rises one level further.
+    // Throws std::invalid_argument, leaving the list untouched, otherwise.
+    void bulk_load(const std::vector<BulkEntry>& entries);
+    // Bytes the node arena has reserved from the system.
+    std::size_t arena_bytes() const noexcept { return arena_.reserved_bytes(); }
+    // Arena plus an estimate of the id index: its bucket array and one
+    // heap node per entry (the pair, a next pointer and the cached hash).
+    std::size_t memory_bytes() const noexcept {
+        using Entry = decltype(index_)::value_type;
+        return arena_bytes() + index_.bucket_count() * sizeof(void*) +
+               index_.size() * (sizeof(Entry) + 2 * sizeof(void*));
+    }
 
     std::vector<const Node*> top_k(std::size_t k) const;
-    std::size_t rank_of(const std::string& user_id) const;
+    // 1-based rank, 0 if the user is absent.
+    std::size_t rank_of(std::string_view user_id) const;
+    std::size_t rank_of(const Node* node) const;
+    // Node at a 1-based rank, or nullptr past the end.
+    Node* at_rank(std::size_t rank) const;
+    // Entries scoring at least `score`, which is also the rank of the last
+    // of them; with the spans this is one O(log n) descent.
+    std::size_t count_at_least(double score) const;
+    // Nodes ranked start..end inclusive (1-based), clipped to the list.
+    std::vector<const Node*> range_by_rank(std::size_t start, std::size_t end) const;
 
     template <typename Fn>
     void for_each(Fn&& fn) const {
-        Node* current = header_->forward[0];
-        while (current) {
+        for (const Node* current = head(); current; current = current->next()) {
             fn(*current);
-            current = current->forward[0];
         }
     }
 
+    static constexpr int kMaxSupportedLevels = 32;
+
 private:
+    // Size-classed free lists carved from 64 KiB slabs. Blocks are 16-byte
+    // granular; anything over 1 KiB (very long ids) goes to operator new.
+    class Arena {
+    public:
+        Arena() = default;
+        ~Arena();
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(std::size_t bytes);
+        void deallocate(void* block, std::size_t bytes) noexcept;
+        // Returns every block at once; pointers into the arena become invalid.
+        void release() noexcept;
+        std::size_t reserved_bytes() const noexcept { return reserved_; }
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        static constexpr std::size_t kGranularity = 16;
+        static constexpr std::size_t kSizeClasses = 64;
+        static constexpr std::size_t kSlabBytes = 64 * 1024;
+
+        std::vector<std::unique_ptr<std::max_align_t[]>> slabs_;
+        char* cursor_ = nullptr;
+        std::size_t remaining_ = 0;
+        std::array<FreeBlock*, kSizeClasses> free_{};
+        std::size_t reserved_ = 0;
+    };
+
     int random_level();
-    bool comes_before(const Node* lhs, double score, const std::string& user_id) const;
-    void insert_node(Node* node, int level, const std::vector<Node*>& update);
+    bool comes_before(const Node* lhs, double score, std::string_view user_id) const;
+    Node* create_node(int level, std::string_view user_id, double score, std::int64_t timestamp);
+    void destroy_node(Node* node) noexcept;
+    void link(Node* node, Node* const* hint = nullptr, const std::size_t* hint_rank = nullptr);
+    void unlink(Node* node, Node* const* update);
+    // Fills update[] with the rightmost node before `node` on every level
+    // and, if given, rank[] with each one's 1-based rank (0 for the header).
+    void find_path(const Node* node, Node** update, std::size_t* rank) const;
+    void reset_header();
+    void destroy_all() noexcept;
 
-    std::unique_ptr<Node> header_;
+    Arena arena_;
+    Node* header_ = nullptr;
+    Node* tail_ = nullptr;
     int max_levels_;
     double probability_;
+    bool borrow_ids_;
     int current_level_;
     std::size_t size_;
     mutable std::mt19937_64 rng_;
-    std::unordered_map<std::string, Node*> index_;
+    std::unordered_map<std::string_view, Node*> index_;
 };
 
 } // namespace engagehub::leaderboard
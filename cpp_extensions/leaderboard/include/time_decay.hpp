@@ -11,8 +11,17 @@ public:
     double apply(double base_score, std::int64_t last_update_timestamp, std::int64_t current_timestamp) const;
     double decay_factor() const noexcept { return decay_factor_; }
 
+    // Natural-log growth between two instants: ln(decay^-(to - from) in days).
+    // Scores normalised against a shared epoch grow by exp(log_growth(epoch, t)),
+    // so one multiplier converts them back to the score at t.
+    double log_growth(std::int64_t from_timestamp, std::int64_t to_timestamp) const noexcept {
+        return log_rate_ * static_cast<double>(to_timestamp - from_timestamp);
+    }
+
 private:
     double decay_factor_;
+    // -ln(decay_factor) per second; zero when scores never decay
+    double log_rate_;
 };
 
 } // namespace engagehub::leaderboard
@@ -1,11 +1,101 @@
 #include "leaderboard.hpp"
+#include "leaderboard_set.hpp"
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace py = pybind11;
 using namespace engagehub::leaderboard;
 
+namespace {
+
+py::dict entry_to_dict(const RankEntry& entry) {
+    py::dict obj;
+    obj["user_id"] = entry.user_id;
+    obj["score"] = entry.score;
+    obj["rank"] = entry.rank;
+    obj["last_update"] = entry.last_update;
+    return obj;
+}
+
+py::list entries_to_list(const std::vector<RankEntry>& entries) {
+    py::list result;
+    for (const auto& entry : entries) {
+        result.append(entry_to_dict(entry));
+    }
+    return result;
+}
+
+// Hands the converted batch to the board without the GIL. ScoreUpdate
+// views point into `user_ids`, which outlives the call.
+void apply_batch(Leaderboard& board, const std::vector<std::string>& user_ids,
+                 const std::vector<double>& points, const std::vector<std::int64_t>& timestamps) {
+    std::vector<ScoreUpdate> updates;
+    updates.reserve(user_ids.size());
+    for (std::size_t i = 0; i < user_ids.size(); ++i) {
+        updates.push_back(ScoreUpdate{user_ids[i], points[i], timestamps[i]});
+    }
+    py::gil_scoped_release release;
+    board.update_users(updates);
+}
+
+// Copies a 1-D buffer (numpy array, array.array, memoryview) of `T`.
+// `codes` lists the struct format characters accepted for `T`.
+template <typename T>
+std::vector<T> read_column(const py::buffer& column, const char* name, const std::string& codes) {
+    const auto info = column.request();
+    if (info.ndim != 1 || info.itemsize != static_cast<py::ssize_t>(sizeof(T)) || info.format.empty() ||
+        codes.find(info.format.back()) == std::string::npos) {
+        throw std::invalid_argument(std::string(name) + " must be a 1-D buffer of " +
+                                    (std::is_floating_point<T>::value ? "float64" : "int64"));
+    }
+    std::vector<T> values(static_cast<std::size_t>(info.shape[0]));
+    const auto* base = static_cast<const char*>(info.ptr);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        std::memcpy(&values[i], base + static_cast<py::ssize_t>(i) * info.strides[0], sizeof(T));
+    }
+    return values;
+}
+
+py::object optional_entry(const std::optional<RankInfo>& info) {
+    if (info) {
+        return entry_to_dict(*info);
+    }
+    return py::none();
+}
+
+// Wraps a Python callable as a board clock. None restores the system clock.
+// The board may drop its copy of the callable without the GIL, so the
+// last reference is released under an acquired GIL.
+std::function<std::int64_t()> python_clock(const py::object& callable) {
+    if (callable.is_none()) {
+        return {};
+    }
+    std::shared_ptr<py::function> fn(
+        new py::function(py::reinterpret_borrow<py::function>(callable)),
+        [](py::function* held) {
+            py::gil_scoped_acquire acquire;
+            delete held;
+        });
+    return [fn]() -> std::int64_t {
+        py::gil_scoped_acquire acquire;
+        return (*fn)().cast<std::int64_t>();
+    };
+}
+
+} // namespace
+
 PYBIND11_MODULE(cpp_leaderboard, m) {
     py::class_<RankEntry>(m, "RankEntry")
         .def_property_readonly("user_id", [](const RankEntry& entry) { return entry.user_id; })
@@ -13,51 +103,201 @@ PYBIND11_MODULE(cpp_leaderboard, m) {
         .def_property_readonly("rank", [](const RankEntry& entry) { return entry.rank; })
         .def_property_readonly("last_update", [](const RankEntry& entry) { return entry.last_update; });
 
-    py::class_<Leaderboard>(m, "Leaderboard")
-        .def(py::init<double, std::size_t>(),
+    // shared holder so a native flush stage can keep a board alive
+    py::class_<Leaderboard, std::shared_ptr<Leaderboard>>(m, "Leaderboard")
+        .def(py::init<double, std::size_t, std::size_t>(),
              py::arg("decay_factor") = 0.95,
-             py::arg("max_users") = 100000)
+             py::arg("max_users") = 100000,
+             py::arg("top_cache_size") = 100)
+        // Board calls drop the GIL while they wait on or hold the board lock,
+        // so reader threads run concurrently and a Python time source can
+        // always reacquire it.
         .def("update_user", &Leaderboard::update_user,
              py::arg("user_id"),
              py::arg("points"),
-             py::arg("timestamp"))
-        .def("get_top_users", [](Leaderboard& self, std::size_t k) {
-            const auto top = self.get_top_users(k);
+             py::arg("timestamp"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("update_users", [](Leaderboard& self, const py::iterable& updates) {
+            std::vector<std::string> user_ids;
+            std::vector<double> points;
+            std::vector<std::int64_t> timestamps;
+            for (const auto item : updates) {
+                if (!py::isinstance<py::sequence>(item) || py::isinstance<py::str>(item) ||
+                    (py::len(item) != 2 && py::len(item) != 3)) {
+                    throw std::invalid_argument("update_users expects (user_id, points[, timestamp]) items");
+                }
+                const auto row = py::reinterpret_borrow<py::sequence>(item);
+                const auto fields = py::len(row);
+                user_ids.push_back(row[0].cast<std::string>());
+                points.push_back(row[1].cast<double>());
+                timestamps.push_back(fields == 3 ? row[2].cast<std::int64_t>() : 0);
+            }
+            apply_batch(self, user_ids, points, timestamps);
+        }, py::arg("updates"))
+        .def("update_users_arrays", [](Leaderboard& self, const py::sequence& user_ids,
+                                       const py::buffer& points, const py::object& timestamps) {
+            const auto values = read_column<double>(points, "points", "d");
+            const auto times = timestamps.is_none()
+                                   ? std::vector<std::int64_t>(values.size(), 0)
+                                   : read_column<std::int64_t>(timestamps.cast<py::buffer>(), "timestamps", "ql");
+            if (py::len(user_ids) != values.size() || times.size() != values.size()) {
+                throw std::invalid_argument("update_users_arrays needs columns of equal length");
+            }
+            std::vector<std::string> ids;
+            ids.reserve(values.size());
+            for (const auto user_id : user_ids) {
+                ids.push_back(py::str(user_id).cast<std::string>());
+            }
+            apply_batch(self, ids, values, times);
+        }, py::arg("user_ids"), py::arg("points"), py::arg("timestamps") = py::none())
+        .def("get_top_users", [](const Leaderboard& self, std::size_t k) {
+            std::vector<RankEntry> top;
+            {
+                py::gil_scoped_release release;
+                top = self.get_top_users(k);
+            }
+            return entries_to_list(top);
+        }, py::arg("k"))
+        .def("get_top_users_json", [](const Leaderboard& self, std::size_t k) {
+            std::string payload;
+            {
+                py::gil_scoped_release release;
+                payload = self.get_top_users_json(k);
+            }
+            return py::bytes(payload);
+        }, py::arg("k"))
+        .def_property_readonly("top_version", &Leaderboard::top_version)
+        .def_property_readonly("top_cache_size", &Leaderboard::top_cache_size)
+        .def("get_users_in_rank_range", [](const Leaderboard& self, std::size_t start, std::size_t end) {
+            std::vector<RankEntry> entries;
+            {
+                py::gil_scoped_release release;
+                entries = self.get_users_in_rank_range(start, end);
+            }
+            return entries_to_list(entries);
+        }, py::arg("start"), py::arg("end"))
+        .def("get_users_around", [](const Leaderboard& self, const std::string& user_id, std::size_t radius) {
+            std::vector<RankEntry> entries;
+            {
+                py::gil_scoped_release release;
+                entries = self.get_users_around(user_id, radius);
+            }
+            return entries_to_list(entries);
+        }, py::arg("user_id"), py::arg("radius"))
+        .def("get_user_rank", [](const Leaderboard& self, const std::string& user_id) -> py::object {
+            std::optional<RankInfo> info;
+            {
+                py::gil_scoped_release release;
+                info = self.get_user_rank(user_id);
+            }
+            return optional_entry(info);
+        }, py::arg("user_id"))
+        .def("get_percentile", [](const Leaderboard& self, const std::string& user_id) -> py::object {
+            std::optional<double> percentile;
+            {
+                py::gil_scoped_release release;
+                percentile = self.get_percentile(user_id);
+            }
+            if (percentile) {
+                return py::float_(*percentile);
+            }
+            return py::none();
+        }, py::arg("user_id"))
+        .def("get_score_quantiles", &Leaderboard::get_score_quantiles, py::arg("quantiles"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_histogram", [](const Leaderboard& self, std::size_t bins) {
+            std::vector<HistogramBin> histogram;
+            {
+                py::gil_scoped_release release;
+                histogram = self.get_histogram(bins);
+            }
             py::list result;
-            for (const auto& entry : top) {
+            for (const auto& bin : histogram) {
                 py::dict obj;
-                obj["user_id"] = entry.user_id;
-                obj["score"] = entry.score;
-                obj["rank"] = entry.rank;
-                obj["last_update"] = entry.last_update;
-                result.append(std::move(obj));
+                obj["lower"] = bin.lower;
+                obj["upper"] = bin.upper;
+                obj["count"] = bin.count;
+                result.append(obj);
             }
             return result;
-        }, py::arg("k"))
-        .def("get_user_rank", [](Leaderboard& self, const std::string& user_id) -> py::object {
-            if (auto info = self.get_user_rank(user_id)) {
-                py::dict obj;
-                obj["user_id"] = info->user_id;
-                obj["score"] = info->score;
-                obj["rank"] = info->rank;
-                obj["last_update"] = info->last_update;
-                return py::object(obj);
+        }, py::arg("bins"))
+        .def("save_to_json", &Leaderboard::save_to_json, py::arg("filepath"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("load_from_json", &Leaderboard::load_from_json, py::arg("filepath"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("save_snapshot", &Leaderboard::save_snapshot, py::arg("filepath"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("load_snapshot", &Leaderboard::load_snapshot, py::arg("filepath"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("size", &Leaderboard::size, py::call_guard<py::gil_scoped_release>())
+        .def("get_current_time", &Leaderboard::get_current_time, py::call_guard<py::gil_scoped_release>())
+        .def("set_time_source", [](Leaderboard& self, const py::object& callable) {
+            auto clock_fn = python_clock(callable);
+            py::gil_scoped_release release;
+            self.set_time_source(std::move(clock_fn));
+        }, py::arg("callable"));
+
+    // Boards are fixed by name; update_user reaches every receives_all board
+    // plus those listed in `boards`.
+    py::class_<LeaderboardSet, std::shared_ptr<LeaderboardSet>>(m, "LeaderboardSet")
+        .def(py::init<>())
+        .def("add_board", [](LeaderboardSet& self, const std::string& name, std::int64_t window_seconds,
+                             std::int64_t window_origin, double decay_factor, std::size_t max_users,
+                             bool receives_all) {
+            BoardSpec spec{name, window_seconds, window_origin, decay_factor, max_users, receives_all};
+            py::gil_scoped_release release;
+            return self.add_board(std::move(spec));
+        }, py::arg("name"), py::arg("window_seconds") = 0, py::arg("window_origin") = 0,
+           py::arg("decay_factor") = 1.0, py::arg("max_users") = 0, py::arg("receives_all") = true)
+        .def("board_names", &LeaderboardSet::board_names, py::call_guard<py::gil_scoped_release>())
+        .def("update_user", &LeaderboardSet::update_user,
+             py::arg("user_id"),
+             py::arg("points"),
+             py::arg("timestamp") = 0,
+             py::arg("boards") = std::vector<std::string>{},
+             py::call_guard<py::gil_scoped_release>())
+        .def("rotate_windows", &LeaderboardSet::rotate_windows, py::call_guard<py::gil_scoped_release>())
+        .def("get_top_users", [](const LeaderboardSet& self, const std::string& board, std::size_t k,
+                                 bool previous_window) {
+            std::vector<RankEntry> top;
+            {
+                py::gil_scoped_release release;
+                top = self.get_top_users(board, k, previous_window);
+            }
+            return entries_to_list(top);
+        }, py::arg("board"), py::arg("k"), py::arg("previous_window") = false)
+        .def("get_user_rank", [](const LeaderboardSet& self, const std::string& board, const std::string& user_id,
+                                 bool previous_window) {
+            std::optional<RankInfo> info;
+            {
+                py::gil_scoped_release release;
+                info = self.get_user_rank(board, user_id, previous_window);
+            }
+            return optional_entry(info);
+        }, py::arg("board"), py::arg("user_id"), py::arg("previous_window") = false)
+        .def("get_user_ranks", [](const LeaderboardSet& self, const std::string& user_id) {
+            std::vector<std::string> names;
+            std::vector<std::optional<RankInfo>> ranks;
+            {
+                py::gil_scoped_release release;
+                // boards are only ever appended, so names cover every rank
+                ranks = self.get_user_ranks(user_id);
+                names = self.board_names();
             }
-            return py::object(py::none());
+            py::dict result;
+            for (std::size_t i = 0; i < ranks.size(); ++i) {
+                result[py::str(names[i])] = optional_entry(ranks[i]);
+            }
+            return result;
         }, py::arg("user_id"))
-        .def("save_to_json", &Leaderboard::save_to_json, py::arg("filepath"))
-        .def("load_from_json", &Leaderboard::load_from_json, py::arg("filepath"))
-        .def("size", &Leaderboard::size)
-        .def("get_current_time", &Leaderboard::get_current_time)
-        .def("set_time_source", [](Leaderboard& self, py::object callable) {
-            if (callable.is_none()) {
-                self.set_time_source({});
-                return;
-            }
-            py::function fn = py::reinterpret_borrow<py::function>(callable);
-            self.set_time_source([fn]() -> std::int64_t {
-                py::gil_scoped_acquire acquire;
-                return fn().cast<std::int64_t>();
-            });
+        .def("size", &LeaderboardSet::size, py::arg("board"), py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("interned_users", [](const LeaderboardSet& self) {
+            py::gil_scoped_release release;
+            return self.interned_users();
+        })
+        .def("set_time_source", [](LeaderboardSet& self, const py::object& callable) {
+            auto clock_fn = python_clock(callable);
+            py::gil_scoped_release release;
+            self.set_time_source(std::move(clock_fn));
         }, py::arg("callable"));
 }
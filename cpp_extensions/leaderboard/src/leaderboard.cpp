@@ -1,10 +1,20 @@
 #include "leaderboard.hpp"
 
+#include "byte_io.hpp"
+#include "hashing.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -24,7 +34,7 @@ std::string trim(const std::string& input) {
     return input.substr(begin, end - begin + 1);
 }
 
-std::string escape_json(const std::string& input) {
+std::string escape_json(std::string_view input) {
     std::string out;
     out.reserve(input.size());
     for (char ch : input) {
@@ -37,72 +47,366 @@ std::string escape_json(const std::string& input) {
     return out;
 }
 
+void append_entry_json(std::string& out, const RankEntry& entry) {
+    std::ostringstream object;
+    object.precision(12);
+    object << "{\"user_id\": \"" << escape_json(entry.user_id) << "\", \"score\": " << entry.score
+           << ", \"rank\": " << entry.rank << ", \"last_update\": " << entry.last_update << "}";
+    out += object.str();
+}
+
+std::string entries_to_json(const std::vector<RankEntry>& entries) {
+    std::string json = "[";
+    for (const auto& entry : entries) {
+        if (json.size() > 1) {
+            json += ", ";
+        }
+        append_entry_json(json, entry);
+    }
+    json += "]";
+    return json;
+}
+
+constexpr char kSnapshotMagic[4] = {'E', 'H', 'L', 'B'};
+constexpr std::uint16_t kSnapshotFormatVersion = 1;
+
+std::uint64_t double_bits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bits_double(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Keys may grow by up to e^64 before a rebase; that leaves ample double
+// range for accumulated points while rebasing stays rare (years at 0.95).
+constexpr double kMaxLogGrowth = 64.0;
+
 } // namespace
 
-Leaderboard::Leaderboard(double decay_factor, std::size_t max_users)
+Leaderboard::Leaderboard(double decay_factor, std::size_t max_users, std::size_t top_cache_size)
     : skip_list_(16, 0.5),
       decay_(decay_factor),
       max_users_(max_users),
-      clock_fn_(default_now_seconds) {}
+      clock_fn_(std::make_shared<const std::function<std::int64_t()>>(default_now_seconds)),
+      top_cache_size_(top_cache_size) {}
 
 void Leaderboard::set_time_source(std::function<std::int64_t()> clock_fn) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    clock_fn_ = std::move(clock_fn);
+    if (!clock_fn) {
+        clock_fn = default_now_seconds;
+    }
+    std::atomic_store(&clock_fn_, std::make_shared<const std::function<std::int64_t()>>(std::move(clock_fn)));
+    invalidate_top();
 }
 
 void Leaderboard::update_user(const std::string& user_id, double points, std::int64_t timestamp) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const std::int64_t now = timestamp > 0 ? timestamp : clock_fn_();
-    if (points == 0.0 && skip_list_.find(user_id) == nullptr) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    update_user_locked(user_id, points, timestamp);
+}
+
+void Leaderboard::update_users(const std::vector<ScoreUpdate>& updates) {
+    if (updates.empty()) {
+        return;
+    }
+    // Contributions are additive in key space, so all of a user's updates
+    // fold into one key delta and each user is repositioned once.
+    struct Pending {
+        std::string_view user_id;
+        double key_delta;
+        std::int64_t last_update;
+        bool scored;
+    };
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto clock_now = now();
+    std::int64_t latest = std::numeric_limits<std::int64_t>::min();
+    for (const auto& update : updates) {
+        latest = std::max(latest, update.timestamp > 0 ? update.timestamp : clock_now);
+    }
+    advance_epoch_locked(latest);
+
+    std::vector<Pending> pending;
+    pending.reserve(updates.size());
+    std::unordered_map<std::string_view, std::size_t> slots;
+    slots.reserve(updates.size());
+    for (const auto& update : updates) {
+        const auto at = update.timestamp > 0 ? update.timestamp : clock_now;
+        const double delta = update.points * std::exp(decay_.log_growth(epoch_, at));
+        const auto [slot, inserted] = slots.emplace(update.user_id, pending.size());
+        if (inserted) {
+            pending.push_back(Pending{update.user_id, delta, at, update.points != 0.0});
+            continue;
+        }
+        auto& merged = pending[slot->second];
+        merged.key_delta += delta;
+        merged.last_update = std::max(merged.last_update, at);
+        merged.scored = merged.scored || update.points != 0.0;
+    }
+
+    for (const auto& entry : pending) {
+        apply_locked(entry.user_id, entry.key_delta, entry.last_update, entry.scored);
+    }
+}
+
+void Leaderboard::update_user_locked(const std::string& user_id, double points, std::int64_t timestamp) {
+    const std::int64_t now = timestamp > 0 ? timestamp : this->now();
+    advance_epoch_locked(now);
+    // Points earned at `now` weigh decay^-(now - epoch_) against the epoch;
+    // older keys need no adjustment, which also keeps late events exact.
+    apply_locked(user_id, points * std::exp(decay_.log_growth(epoch_, now)), now, points != 0.0);
+}
+
+void Leaderboard::advance_epoch_locked(std::int64_t now) {
+    if (skip_list_.size() == 0) {
+        epoch_ = now;
+    } else if (decay_.log_growth(epoch_, now) > kMaxLogGrowth) {
+        rebase_locked(now);
+    }
+}
+
+void Leaderboard::apply_locked(std::string_view user_id, double key_delta, std::int64_t timestamp, bool scored) {
+    auto* existing = skip_list_.find(user_id);
+    if (!scored && existing == nullptr) {
         return;
     }
 
-    double new_score = points;
-    if (auto* existing = skip_list_.find(user_id)) {
-        const double decayed = decay_.apply(existing->score, existing->last_update, now);
-        new_score = decayed + points;
+    double key = key_delta;
+    std::int64_t last_update = timestamp;
+    // Judged against the K-th key before the write: a user that was below
+    // it and still is cannot have changed the top-K view.
+    const double threshold = top_threshold_locked();
+    bool touches_top = false;
+    if (existing) {
+        touches_top = existing->score >= threshold;
+        key += existing->score;
+        last_update = std::max(existing->last_update, timestamp);
     }
+    touches_top = touches_top || key >= threshold;
 
-    skip_list_.upsert(user_id, new_score, now);
+    if (existing) {
+        skip_list_.update(existing, key, last_update);
+    } else {
+        skip_list_.insert(user_id, key, last_update);
+    }
 
     if (max_users_ > 0 && skip_list_.size() > max_users_) {
         if (auto* tail = skip_list_.tail()) {
             if (tail->user_id != user_id || skip_list_.size() > max_users_) {
-                skip_list_.erase(tail->user_id);
+                touches_top = touches_top || skip_list_.size() <= top_cache_size_;
+                skip_list_.remove(tail);
             }
         }
     }
+    if (touches_top) {
+        invalidate_top();
+    }
+}
+
+double Leaderboard::top_threshold_locked() const {
+    if (top_cache_size_ == 0 || skip_list_.size() < top_cache_size_) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return skip_list_.at_rank(top_cache_size_)->score;
+}
+
+void Leaderboard::rebase_locked(std::int64_t epoch) {
+    const double scale = std::exp(-decay_.log_growth(epoch_, epoch));
+    std::vector<std::tuple<std::string, double, std::int64_t>> entries;
+    entries.reserve(skip_list_.size());
+    skip_list_.for_each([&](const SkipList::Node& node) {
+        entries.emplace_back(std::string(node.user_id), node.score * scale, node.last_update);
+    });
+    skip_list_.clear();
+    for (const auto& [user, key, last_update] : entries) {
+        skip_list_.upsert(user, key, last_update);
+    }
+    epoch_ = epoch;
 }
 
-std::vector<RankEntry> Leaderboard::get_top_users(std::size_t k) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const auto now = clock_fn_();
-    refresh_scores_locked(now);
+double Leaderboard::score_at_locked(const SkipList::Node& node, std::int64_t now) const {
+    // one multiplier for every node at `now`, so reported scores follow rank
+    return node.score * std::exp(-decay_.log_growth(epoch_, now));
+}
+
+std::vector<RankEntry> Leaderboard::to_entries_locked(const std::vector<const SkipList::Node*>& nodes,
+                                                      std::size_t first_rank, std::int64_t now) const {
     std::vector<RankEntry> results;
-    const auto nodes = skip_list_.top_k(k);
     results.reserve(nodes.size());
-    std::size_t rank = 1;
+    std::size_t rank = first_rank;
     for (const auto* node : nodes) {
-        results.push_back(RankEntry{node->user_id, node->score, rank++, node->last_update});
+        results.push_back(RankEntry{std::string(node->user_id), score_at_locked(*node, now), rank++, node->last_update});
     }
     return results;
 }
 
-std::optional<RankInfo> Leaderboard::get_user_rank(const std::string& user_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const auto now = clock_fn_();
-    refresh_scores_locked(now);
+std::vector<RankEntry> Leaderboard::get_top_users(std::size_t k) const {
+    // with the cache disabled there is no snapshot to serve from
+    if (top_cache_size_ != 0 && k <= top_cache_size_) {
+        const auto snapshot = get_top_snapshot();
+        const auto count = std::min(k, snapshot->entries.size());
+        return std::vector<RankEntry>(snapshot->entries.begin(),
+                                      snapshot->entries.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return to_entries_locked(skip_list_.top_k(k), 1, now());
+}
+
+std::shared_ptr<const TopSnapshot> Leaderboard::get_top_snapshot() const {
+    if (top_cache_size_ == 0) {
+        return nullptr;
+    }
+    const auto as_of = now();
+    const auto is_current = [&](const std::shared_ptr<const TopSnapshot>& snapshot) {
+        return snapshot && snapshot->version == top_version() && snapshot->as_of == as_of;
+    };
+    auto snapshot = std::atomic_load(&top_snapshot_);
+    if (is_current(snapshot)) {
+        return snapshot;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    // the version cannot move while writers are excluded
+    snapshot = std::atomic_load(&top_snapshot_);
+    if (is_current(snapshot)) {
+        return snapshot;
+    }
+    auto fresh = std::make_shared<TopSnapshot>();
+    fresh->version = top_version();
+    fresh->as_of = as_of;
+    fresh->entries = to_entries_locked(skip_list_.top_k(top_cache_size_), 1, as_of);
+    fresh->json = "[";
+    fresh->json_ends.reserve(fresh->entries.size());
+    for (const auto& entry : fresh->entries) {
+        if (fresh->json.size() > 1) {
+            fresh->json += ", ";
+        }
+        append_entry_json(fresh->json, entry);
+        fresh->json_ends.push_back(fresh->json.size());
+    }
+    fresh->json += "]";
+    // concurrent readers may each publish an equivalent snapshot
+    std::atomic_store(&top_snapshot_, std::shared_ptr<const TopSnapshot>(fresh));
+    return fresh;
+}
+
+std::string Leaderboard::get_top_users_json(std::size_t k) const {
+    if (top_cache_size_ == 0 || k > top_cache_size_) {
+        return entries_to_json(get_top_users(k));
+    }
+    const auto snapshot = get_top_snapshot();
+    if (k >= snapshot->entries.size()) {
+        return snapshot->json;
+    }
+    if (k == 0) {
+        return "[]";
+    }
+    return snapshot->json.substr(0, snapshot->json_ends[k - 1]) + "]";
+}
 
+std::vector<RankEntry> Leaderboard::get_users_in_rank_range(std::size_t start, std::size_t end) const {
+    if (start == 0 || start > end) {
+        throw std::invalid_argument("rank range must satisfy 1 <= start <= end");
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return to_entries_locked(skip_list_.range_by_rank(start, end), start, now());
+}
+
+std::vector<RankEntry> Leaderboard::get_users_around(const std::string& user_id, std::size_t radius) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto rank = skip_list_.rank_of(user_id);
+    if (rank == 0) {
+        return {};
+    }
+    radius = std::min(radius, skip_list_.size());
+    const auto start = rank > radius ? rank - radius : 1;
+    return to_entries_locked(skip_list_.range_by_rank(start, rank + radius), start, now());
+}
+
+std::optional<RankInfo> Leaderboard::get_user_rank(const std::string& user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     const auto* node = skip_list_.find(user_id);
     if (!node) {
         return std::nullopt;
     }
     const auto rank = skip_list_.rank_of(user_id);
-    return RankInfo{node->user_id, node->score, rank, node->last_update};
+    return RankInfo{std::string(node->user_id), score_at_locked(*node, now()), rank, node->last_update};
+}
+
+std::optional<double> Leaderboard::get_percentile(const std::string& user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto* node = skip_list_.find(user_id);
+    if (!node) {
+        return std::nullopt;
+    }
+    // ties share a percentile: only strictly lower keys count as below
+    const auto size = skip_list_.size();
+    const auto below = size - skip_list_.count_at_least(node->score);
+    return 100.0 * static_cast<double>(below) / static_cast<double>(size);
+}
+
+std::vector<double> Leaderboard::get_score_quantiles(const std::vector<double>& quantiles) const {
+    for (const double q : quantiles) {
+        if (!(q >= 0.0 && q <= 1.0)) {
+            throw std::invalid_argument("quantiles must be in [0, 1]");
+        }
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<double> scores;
+    const auto size = skip_list_.size();
+    if (size == 0) {
+        return scores;
+    }
+    const auto now = this->now();
+    scores.reserve(quantiles.size());
+    for (const double q : quantiles) {
+        // the ceil(q * n)-th lowest score, counted from the bottom of the list
+        const auto from_bottom = std::min<std::size_t>(
+            size, std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(q * static_cast<double>(size)))));
+        scores.push_back(score_at_locked(*skip_list_.at_rank(size - from_bottom + 1), now));
+    }
+    return scores;
+}
+
+std::vector<HistogramBin> Leaderboard::get_histogram(std::size_t bins) const {
+    if (bins == 0) {
+        throw std::invalid_argument("histogram needs at least one bin");
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<HistogramBin> histogram;
+    const auto size = skip_list_.size();
+    if (size == 0) {
+        return histogram;
+    }
+    const auto now = this->now();
+    const double scale = std::exp(-decay_.log_growth(epoch_, now));
+    // Keys map to scores by one positive multiplier, so equal-width bins
+    // over keys are equal-width bins over scores.
+    const double high = skip_list_.head()->score;
+    const double low = skip_list_.tail()->score;
+    if (high == low) {
+        histogram.push_back(HistogramBin{low * scale, high * scale, size});
+        return histogram;
+    }
+    const double width = (high - low) / static_cast<double>(bins);
+    histogram.reserve(bins);
+    std::size_t at_least_lower = size;
+    for (std::size_t i = 0; i < bins; ++i) {
+        const double lower = low + width * static_cast<double>(i);
+        const bool last = i + 1 == bins;
+        const double upper = last ? high : low + width * static_cast<double>(i + 1);
+        const std::size_t at_least_upper = last ? 0 : skip_list_.count_at_least(upper);
+        histogram.push_back(HistogramBin{lower * scale, upper * scale, at_least_lower - at_least_upper});
+        at_least_lower = at_least_upper;
+    }
+    return histogram;
 }
 
-void Leaderboard::save_to_json(const std::string& filepath) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void Leaderboard::save_to_json(const std::string& filepath) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     std::ofstream out(filepath);
     if (!out) {
         throw std::runtime_error("Failed to open file for writing: " + filepath);
@@ -119,14 +423,14 @@ void Leaderboard::save_to_json(const std::string& filepath) {
         }
         first = false;
         out << "    {\"user_id\": \"" << escape_json(node.user_id) << "\", "
-            "\"score\": " << node.score << ", \"last_update\": " << node.last_update << "}";
+            "\"score\": " << score_at_locked(node, node.last_update) << ", \"last_update\": " << node.last_update << "}";
     });
     out << "\n  ]\n";
     out << "}\n";
 }
 
 void Leaderboard::load_from_json(const std::string& filepath) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     std::ifstream in(filepath);
     if (!in) {
         throw std::runtime_error("Failed to open file for reading: " + filepath);
@@ -155,6 +459,9 @@ void Leaderboard::load_from_json(const std::string& filepath) {
     }
 
     skip_list_.clear();
+    invalidate_top();
+    epoch_ = std::numeric_limits<std::int64_t>::min();
+    std::vector<std::tuple<std::string, double, std::int64_t>> loaded;
 
     const auto entries_pos = content.find("\"entries\"");
     if (entries_pos == std::string::npos) {
@@ -212,35 +519,131 @@ void Leaderboard::load_from_json(const std::string& filepath) {
             const auto user = *user_opt;
             const double score = std::stod(*score_opt);
             const std::int64_t ts = std::stoll(*timestamp_opt);
-            skip_list_.upsert(user, score, ts);
+            loaded.emplace_back(user, score, ts);
+            epoch_ = std::max(epoch_, ts);
         }
 
         pos = obj_end + 1;
     }
+    // normalised to the newest update, so no key can overflow
+    for (const auto& [user, score, ts] : loaded) {
+        skip_list_.upsert(user, score * std::exp(decay_.log_growth(epoch_, ts)), ts);
+    }
+}
+
+void Leaderboard::save_snapshot(const std::string& filepath) const {
+    std::string bytes;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        ByteWriter out(bytes);
+        out.put_bytes(kSnapshotMagic, sizeof(kSnapshotMagic));
+        out.put<std::uint16_t>(kSnapshotFormatVersion);
+        out.put<std::uint16_t>(0);
+        out.put<std::uint64_t>(double_bits(decay_.decay_factor()));
+        out.put<std::uint64_t>(max_users_);
+        out.put<std::int64_t>(epoch_);
+        out.put<std::uint64_t>(skip_list_.size());
+        skip_list_.for_each([&](const SkipList::Node& node) {
+            out.put_varint(node.user_id.size());
+            out.put_bytes(node.user_id.data(), node.user_id.size());
+            out.put<std::uint64_t>(double_bits(node.score));
+            out.put<std::int64_t>(node.last_update);
+        });
+    }
+    ByteWriter(bytes).put<std::uint64_t>(hashing::murmur3_64(bytes.data(), bytes.size(), hashing::kDefaultSeed));
+
+    const std::string temp_path = filepath + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to open file for writing: " + temp_path);
+        }
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out.flush()) {
+            throw std::runtime_error("Failed to write leaderboard snapshot: " + temp_path);
+        }
+    }
+    // readers of `filepath` see either the old snapshot or the new one
+    if (std::rename(temp_path.c_str(), filepath.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to replace leaderboard snapshot: " + filepath);
+    }
+}
+
+void Leaderboard::load_snapshot(const std::string& filepath) {
+    const MappedFile file(filepath);
+    const auto snapshot = file.bytes();
+    constexpr std::size_t kHeaderSize = sizeof(kSnapshotMagic) + 2 * sizeof(std::uint16_t);
+    if (snapshot.size() < kHeaderSize + sizeof(std::uint64_t)) {
+        throw std::runtime_error("Leaderboard snapshot is truncated: " + filepath);
+    }
+    const auto body = snapshot.substr(0, snapshot.size() - sizeof(std::uint64_t));
+    ByteReader in(body);
+    if (in.get_bytes(sizeof(kSnapshotMagic)) != std::string_view(kSnapshotMagic, sizeof(kSnapshotMagic))) {
+        throw std::runtime_error("Not a leaderboard snapshot: " + filepath);
+    }
+    const auto version = in.get<std::uint16_t>();
+    if (version != kSnapshotFormatVersion) {
+        throw std::runtime_error("Unsupported leaderboard snapshot version: " + std::to_string(version));
+    }
+    in.get<std::uint16_t>();
+    ByteReader trailer(snapshot.substr(body.size()));
+    if (trailer.get<std::uint64_t>() != hashing::murmur3_64(body.data(), body.size(), hashing::kDefaultSeed)) {
+        throw std::runtime_error("Leaderboard snapshot checksum mismatch: " + filepath);
+    }
+
+    // decode everything before touching live state; ids stay in the mapping
+    const double decay_factor = bits_double(in.get<std::uint64_t>());
+    if (!(decay_factor > 0.0 && decay_factor <= 1.0)) {
+        throw std::runtime_error("Leaderboard snapshot has an invalid decay factor: " + filepath);
+    }
+    const TimeDecay decay(decay_factor);
+    const auto max_users = static_cast<std::size_t>(in.get<std::uint64_t>());
+    const auto epoch = in.get<std::int64_t>();
+    const auto count = in.get<std::uint64_t>();
+    // every entry takes at least 17 bytes, which bounds a corrupt count
+    if (count > in.remaining() / 17) {
+        throw std::runtime_error("Leaderboard snapshot is truncated: " + filepath);
+    }
+    std::vector<SkipList::BulkEntry> entries;
+    entries.reserve(static_cast<std::size_t>(count));
+    for (std::uint64_t i = 0; i < count; ++i) {
+        const auto id_length = in.get_varint();
+        if (id_length > in.remaining()) {
+            throw std::runtime_error("Leaderboard snapshot is truncated: " + filepath);
+        }
+        const auto user_id = in.get_bytes(static_cast<std::size_t>(id_length));
+        const double key = bits_double(in.get<std::uint64_t>());
+        entries.push_back(SkipList::BulkEntry{user_id, key, in.get<std::int64_t>()});
+    }
+    if (in.remaining() != 0) {
+        throw std::runtime_error("Leaderboard snapshot has trailing bytes: " + filepath);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    try {
+        skip_list_.bulk_load(entries);
+    } catch (const std::invalid_argument&) {
+        throw std::runtime_error("Leaderboard snapshot entries are out of order: " + filepath);
+    }
+    decay_ = decay;
+    max_users_ = max_users;
+    epoch_ = epoch;
+    invalidate_top();
 }
 
 std::size_t Leaderboard::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     return skip_list_.size();
 }
 
-double Leaderboard::get_current_time() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return static_cast<double>(clock_fn_());
+std::size_t Leaderboard::memory_bytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return skip_list_.memory_bytes();
 }
 
-void Leaderboard::refresh_scores_locked(std::int64_t now) {
-    std::vector<std::pair<std::string, double>> updates;
-    updates.reserve(skip_list_.size());
-    skip_list_.for_each([&](const SkipList::Node& node) {
-        const double decayed = decay_.apply(node.score, node.last_update, now);
-        if (std::fabs(decayed - node.score) > 1e-6 || node.last_update != now) {
-            updates.emplace_back(node.user_id, decayed);
-        }
-    });
-    for (const auto& [user, score] : updates) {
-        skip_list_.upsert(user, score, now);
-    }
+double Leaderboard::get_current_time() const {
+    return static_cast<double>(now());
 }
 
 } // namespace engagehub::leaderboard
@@ -0,0 +1,351 @@
+#include "leaderboard_set.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace engagehub::leaderboard {
+namespace {
+std::int64_t default_now_seconds() {
+    using namespace std::chrono;
+    return duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// same headroom as Leaderboard before keys are rebased
+constexpr double kMaxLogGrowth = 64.0;
+
+// Start of the window holding `timestamp`, flooring towards the past.
+std::int64_t window_floor(const BoardSpec& spec, std::int64_t timestamp) {
+    const auto offset = timestamp - spec.window_origin;
+    auto index = offset / spec.window_seconds;
+    if (offset % spec.window_seconds < 0) {
+        --index;
+    }
+    return spec.window_origin + index * spec.window_seconds;
+}
+} // namespace
+
+LeaderboardSet::LeaderboardSet()
+    : clock_fn_(std::make_shared<const std::function<std::int64_t()>>(default_now_seconds)) {}
+
+std::size_t LeaderboardSet::add_board(BoardSpec spec) {
+    if (spec.name.empty()) {
+        throw std::invalid_argument("LeaderboardSet boards need a name");
+    }
+    if (spec.window_seconds < 0) {
+        throw std::invalid_argument("LeaderboardSet window_seconds must be >= 0");
+    }
+    TimeDecay decay(spec.decay_factor);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (board_index_.count(spec.name) != 0) {
+        throw std::invalid_argument("Duplicate leaderboard name: " + spec.name);
+    }
+    const auto index = boards_.size();
+    board_index_.emplace(spec.name, index);
+    boards_.push_back(Board{std::move(spec), decay, std::make_unique<Window>(), std::make_unique<Window>(),
+                            std::nullopt});
+    return index;
+}
+
+std::vector<std::string> LeaderboardSet::board_names() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> names;
+    names.reserve(boards_.size());
+    for (const auto& board : boards_) {
+        names.push_back(board.spec.name);
+    }
+    return names;
+}
+
+void LeaderboardSet::set_time_source(std::function<std::int64_t()> clock_fn) {
+    if (!clock_fn) {
+        clock_fn = default_now_seconds;
+    }
+    std::atomic_store(&clock_fn_, std::make_shared<const std::function<std::int64_t()>>(std::move(clock_fn)));
+}
+
+const LeaderboardSet::Board& LeaderboardSet::board_locked(const std::string& name) const {
+    const auto it = board_index_.find(name);
+    if (it == board_index_.end()) {
+        throw std::invalid_argument("Unknown leaderboard: " + name);
+    }
+    return boards_[it->second];
+}
+
+void LeaderboardSet::update_user(const std::string& user_id, double points, std::int64_t timestamp,
+                                 const std::vector<std::string>& boards) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const std::int64_t now = timestamp > 0 ? timestamp : this->now();
+
+    // resolved before anything changes, so an unknown name leaves no trace
+    std::vector<std::size_t> targets;
+    targets.reserve(boards_.size());
+    for (std::size_t i = 0; i < boards_.size(); ++i) {
+        if (boards_[i].spec.receives_all) {
+            targets.push_back(i);
+        }
+    }
+    for (const auto& name : boards) {
+        const auto it = board_index_.find(name);
+        if (it == board_index_.end()) {
+            throw std::invalid_argument("Unknown leaderboard: " + name);
+        }
+        if (std::find(targets.begin(), targets.end(), it->second) == targets.end()) {
+            targets.push_back(it->second);
+        }
+    }
+
+    auto slot = find_slot_locked(user_id);
+    if (!slot) {
+        // a zero-point update never adds a user
+        if (points == 0.0) {
+            return;
+        }
+        slot = intern_locked(user_id);
+    }
+    // pinned so an eviction on one board cannot recycle the slot mid-update
+    ++refs_[*slot];
+    for (const auto index : targets) {
+        auto& board = boards_[index];
+        if (Window* window = writable_window_locked(board, now)) {
+            apply_locked(board, *window, *slot, points, now);
+        }
+    }
+    release_slot_locked(*slot);
+}
+
+void LeaderboardSet::rotate_windows() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto now = this->now();
+    for (auto& board : boards_) {
+        rotate_locked(board, now);
+    }
+}
+
+LeaderboardSet::Window* LeaderboardSet::writable_window_locked(Board& board, std::int64_t timestamp) {
+    if (board.spec.window_seconds == 0) {
+        return board.current.get();
+    }
+    if (!board.window_start) {
+        board.window_start = window_floor(board.spec, timestamp);
+    }
+    if (timestamp < *board.window_start) {
+        return nullptr;
+    }
+    rotate_locked(board, timestamp);
+    return board.current.get();
+}
+
+void LeaderboardSet::rotate_locked(Board& board, std::int64_t now) {
+    if (board.spec.window_seconds == 0 || !board.window_start || now < *board.window_start) {
+        return;
+    }
+    const auto elapsed = (now - *board.window_start) / board.spec.window_seconds;
+    if (elapsed == 0) {
+        return;
+    }
+    // The closed window becomes `previous` and the list it displaces is
+    // cleared for reuse; after a gap of two or more both are stale.
+    clear_window_locked(*board.previous);
+    if (elapsed == 1) {
+        std::swap(board.current, board.previous);
+    } else {
+        clear_window_locked(*board.current);
+    }
+    *board.window_start += elapsed * board.spec.window_seconds;
+}
+
+const LeaderboardSet::Window* LeaderboardSet::visible_window_locked(const Board& board, std::int64_t now,
+                                                                    bool previous) const {
+    if (board.spec.window_seconds == 0) {
+        return previous ? nullptr : board.current.get();
+    }
+    std::int64_t elapsed = 0;
+    if (board.window_start && now > *board.window_start) {
+        elapsed = (now - *board.window_start) / board.spec.window_seconds;
+    }
+    if (elapsed == 0) {
+        return previous ? board.previous.get() : board.current.get();
+    }
+    if (elapsed == 1) {
+        return previous ? board.current.get() : nullptr;
+    }
+    return nullptr;
+}
+
+void LeaderboardSet::apply_locked(Board& board, Window& window, std::uint32_t slot, double points,
+                                  std::int64_t timestamp) {
+    auto& list = window.list;
+    SkipList::Node* node = window.node(slot);
+    if (!node && points == 0.0) {
+        return;
+    }
+    if (list.size() == 0) {
+        window.epoch = timestamp;
+    } else if (board.decay.log_growth(window.epoch, timestamp) > kMaxLogGrowth) {
+        rebase_locked(board, window, timestamp);
+        // the rebuilt list has new nodes
+        node = window.node(slot);
+    }
+    // keys are normalised to the window's epoch, as in Leaderboard
+    const double delta = points * std::exp(board.decay.log_growth(window.epoch, timestamp));
+    if (node) {
+        list.update(node, node->score + delta, std::max(node->last_update, timestamp));
+    } else {
+        node = list.insert(ids_[slot], delta, timestamp);
+        node->tag = slot;
+        if (slot >= window.nodes.size()) {
+            window.nodes.resize(ids_.size(), nullptr);
+        }
+        window.nodes[slot] = node;
+        ++refs_[slot];
+    }
+
+    if (board.spec.max_users > 0 && list.size() > board.spec.max_users) {
+        SkipList::Node* tail = list.tail();
+        const auto evicted = tail->tag;
+        window.nodes[evicted] = nullptr;
+        list.remove(tail);
+        release_slot_locked(evicted);
+    }
+}
+
+void LeaderboardSet::rebase_locked(const Board& board, Window& window, std::int64_t epoch) {
+    struct Entry {
+        std::uint32_t slot;
+        double key;
+        std::int64_t last_update;
+    };
+    const double scale = std::exp(-board.decay.log_growth(window.epoch, epoch));
+    std::vector<Entry> entries;
+    entries.reserve(window.list.size());
+    window.list.for_each([&](const SkipList::Node& node) {
+        entries.push_back(Entry{node.tag, node.score * scale, node.last_update});
+    });
+    window.list.clear();
+    for (const auto& entry : entries) {
+        SkipList::Node* node = window.list.insert(ids_[entry.slot], entry.key, entry.last_update);
+        node->tag = entry.slot;
+        window.nodes[entry.slot] = node;
+    }
+    window.epoch = epoch;
+}
+
+void LeaderboardSet::clear_window_locked(Window& window) {
+    window.list.for_each([&](const SkipList::Node& node) {
+        window.nodes[node.tag] = nullptr;
+        release_slot_locked(node.tag);
+    });
+    window.list.clear();
+}
+
+std::optional<std::uint32_t> LeaderboardSet::find_slot_locked(std::string_view user_id) const {
+    const auto it = slots_.find(user_id);
+    if (it == slots_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::uint32_t LeaderboardSet::intern_locked(std::string_view user_id) {
+    std::uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        ids_[slot].assign(user_id.data(), user_id.size());
+    } else {
+        slot = static_cast<std::uint32_t>(ids_.size());
+        ids_.emplace_back(user_id);
+        refs_.push_back(0);
+    }
+    slots_.emplace(ids_[slot], slot);
+    return slot;
+}
+
+void LeaderboardSet::release_slot_locked(std::uint32_t slot) {
+    if (--refs_[slot] != 0) {
+        return;
+    }
+    // the characters stay until the slot is reused, as nodes being
+    // cleared may still view them
+    slots_.erase(ids_[slot]);
+    free_slots_.push_back(slot);
+}
+
+double LeaderboardSet::score_at_locked(const Board& board, const Window& window, const SkipList::Node& node,
+                                       std::int64_t now) const {
+    return node.score * std::exp(-board.decay.log_growth(window.epoch, now));
+}
+
+std::vector<RankEntry> LeaderboardSet::get_top_users(const std::string& board, std::size_t k,
+                                                     bool previous_window) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto& target = board_locked(board);
+    const auto now = this->now();
+    const Window* window = visible_window_locked(target, now, previous_window);
+    std::vector<RankEntry> results;
+    if (!window) {
+        return results;
+    }
+    const auto nodes = window->list.top_k(k);
+    results.reserve(nodes.size());
+    std::size_t rank = 1;
+    for (const auto* node : nodes) {
+        results.push_back(RankEntry{std::string(node->user_id), score_at_locked(target, *window, *node, now), rank++,
+                                    node->last_update});
+    }
+    return results;
+}
+
+std::optional<RankInfo> LeaderboardSet::get_user_rank(const std::string& board, const std::string& user_id,
+                                                      bool previous_window) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto& target = board_locked(board);
+    const auto slot = find_slot_locked(user_id);
+    const auto now = this->now();
+    const Window* window = visible_window_locked(target, now, previous_window);
+    if (!slot || !window) {
+        return std::nullopt;
+    }
+    const auto* node = window->node(*slot);
+    if (!node) {
+        return std::nullopt;
+    }
+    return RankInfo{user_id, score_at_locked(target, *window, *node, now), window->list.rank_of(node),
+                    node->last_update};
+}
+
+std::vector<std::optional<RankInfo>> LeaderboardSet::get_user_ranks(const std::string& user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::optional<RankInfo>> ranks(boards_.size());
+    const auto slot = find_slot_locked(user_id);
+    if (!slot) {
+        return ranks;
+    }
+    const auto now = this->now();
+    for (std::size_t i = 0; i < boards_.size(); ++i) {
+        const Window* window = visible_window_locked(boards_[i], now, false);
+        const auto* node = window ? window->node(*slot) : nullptr;
+        if (node) {
+            ranks[i] = RankInfo{user_id, score_at_locked(boards_[i], *window, *node, now),
+                                window->list.rank_of(node), node->last_update};
+        }
+    }
+    return ranks;
+}
+
+std::size_t LeaderboardSet::size(const std::string& board) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Window* window = visible_window_locked(board_locked(board), now(), false);
+    return window ? window->list.size() : 0;
+}
+
+std::size_t LeaderboardSet::interned_users() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return slots_.size();
+}
+
+} // namespace engagehub::leaderboard
@@ -1,18 +1,79 @@
 #include "skip_list.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
 
 namespace engagehub::leaderboard {
 
+static_assert(std::is_trivially_destructible<SkipList::Node>::value,
+              "arena nodes are released without running destructors");
+static_assert(sizeof(SkipList::Node) % alignof(SkipList::Node::Level) == 0,
+              "the tower must start aligned right after the node");
+
 namespace {
-constexpr int kMaxSupportedLevels = 32;
+std::size_t node_bytes(int level, std::size_t id_length) {
+    return sizeof(SkipList::Node) + static_cast<std::size_t>(level) * sizeof(SkipList::Node::Level) + id_length;
+}
+} // namespace
+
+SkipList::Arena::~Arena() {
+    release();
+}
+
+void* SkipList::Arena::allocate(std::size_t bytes) {
+    const std::size_t rounded = (bytes + kGranularity - 1) / kGranularity * kGranularity;
+    const std::size_t size_class = rounded / kGranularity - 1;
+    if (size_class >= kSizeClasses) {
+        reserved_ += rounded;
+        return ::operator new(rounded);
+    }
+    if (FreeBlock* block = free_[size_class]) {
+        free_[size_class] = block->next;
+        return block;
+    }
+    if (remaining_ < rounded) {
+        slabs_.emplace_back(new std::max_align_t[kSlabBytes / sizeof(std::max_align_t)]);
+        cursor_ = reinterpret_cast<char*>(slabs_.back().get());
+        remaining_ = kSlabBytes;
+        reserved_ += kSlabBytes;
+    }
+    void* block = cursor_;
+    cursor_ += rounded;
+    remaining_ -= rounded;
+    return block;
+}
+
+void SkipList::Arena::deallocate(void* block, std::size_t bytes) noexcept {
+    const std::size_t rounded = (bytes + kGranularity - 1) / kGranularity * kGranularity;
+    const std::size_t size_class = rounded / kGranularity - 1;
+    if (size_class >= kSizeClasses) {
+        reserved_ -= rounded;
+        ::operator delete(block);
+        return;
+    }
+    auto* freed = static_cast<FreeBlock*>(block);
+    freed->next = free_[size_class];
+    free_[size_class] = freed;
+}
+
+void SkipList::Arena::release() noexcept {
+    // Oversized blocks are owned by their nodes; the list frees them first.
+    slabs_.clear();
+    cursor_ = nullptr;
+    remaining_ = 0;
+    free_.fill(nullptr);
+    reserved_ = 0;
 }
 
-SkipList::SkipList(int max_levels, double probability)
-    : header_(std::make_unique<Node>()),
-      max_levels_(max_levels),
+SkipList::SkipList(int max_levels, double probability, bool borrow_ids)
+    : max_levels_(max_levels),
       probability_(probability),
+      borrow_ids_(borrow_ids),
       current_level_(1),
       size_(0),
       rng_(std::random_device{}()) {
@@ -22,18 +83,18 @@ SkipList::SkipList(int max_levels, double probability)
     if (probability_ <= 0.0 || probability_ >= 1.0) {
         throw std::invalid_argument("SkipList probability must be in (0,1)");
     }
-    header_->score = 0.0;
-    header_->last_update = 0;
-    header_->forward.assign(static_cast<std::size_t>(max_levels_), nullptr);
+    reset_header();
 }
 
 SkipList::~SkipList() {
-    Node* current = header_->forward[0];
-    while (current) {
-        Node* next = current->forward[0];
-        delete current;
-        current = next;
-    }
+    destroy_all();
+}
+
+void SkipList::reset_header() {
+    header_ = create_node(max_levels_, {}, 0.0, 0);
+    tail_ = nullptr;
+    current_level_ = 1;
+    size_ = 0;
 }
 
 int SkipList::random_level() {
@@ -45,7 +106,7 @@ int SkipList::random_level() {
     return level;
 }
 
-bool SkipList::comes_before(const Node* lhs, double score, const std::string& user_id) const {
+bool SkipList::comes_before(const Node* lhs, double score, std::string_view user_id) const {
     if (lhs->score > score) {
         return true;
     }
@@ -55,35 +116,136 @@ bool SkipList::comes_before(const Node* lhs, double score, const std::string& us
     return lhs->user_id < user_id;
 }
 
-SkipList::Node* SkipList::upsert(const std::string& user_id, double score, std::int64_t timestamp) {
-    erase(user_id);
+SkipList::Node* SkipList::create_node(int level, std::string_view user_id, double score, std::int64_t timestamp) {
+    void* block = arena_.allocate(node_bytes(level, borrow_ids_ ? 0 : user_id.size()));
+    auto* node = new (block) Node{user_id, score, timestamp, nullptr, level, 0};
+    Node::Level* levels = node->levels();
+    for (int i = 0; i < level; ++i) {
+        new (&levels[i]) Node::Level{};
+    }
+    if (borrow_ids_) {
+        return node;
+    }
+    char* chars = reinterpret_cast<char*>(levels + level);
+    if (!user_id.empty()) {
+        std::memcpy(chars, user_id.data(), user_id.size());
+    }
+    node->user_id = std::string_view(chars, user_id.size());
+    return node;
+}
 
-    const int node_level = random_level();
-    auto* node = new Node{user_id, score, timestamp, std::vector<Node*>(static_cast<std::size_t>(node_level), nullptr)};
+void SkipList::destroy_node(Node* node) noexcept {
+    arena_.deallocate(node, node_bytes(node->level_count, borrow_ids_ ? 0 : node->user_id.size()));
+}
+
+SkipList::Node* SkipList::upsert(std::string_view user_id, double score, std::int64_t timestamp) {
+    if (Node* node = find(user_id)) {
+        update(node, score, timestamp);
+        return node;
+    }
+    return insert(user_id, score, timestamp);
+}
 
-    std::vector<Node*> update(static_cast<std::size_t>(max_levels_), nullptr);
-    Node* current = header_.get();
+SkipList::Node* SkipList::insert(std::string_view user_id, double score, std::int64_t timestamp) {
+    Node* node = create_node(random_level(), user_id, score, timestamp);
+    link(node);
+    if (!borrow_ids_) {
+        index_.emplace(node->user_id, node);
+    }
+    return node;
+}
+
+void SkipList::update(Node* node, double score, std::int64_t timestamp) {
+    node->last_update = timestamp;
+    // still between its neighbours: nothing to relink
+    const Node* prev = node->backward;
+    const Node* next = node->next();
+    if ((!prev || comes_before(prev, score, node->user_id)) &&
+        (!next || !comes_before(next, score, node->user_id))) {
+        node->score = score;
+        return;
+    }
+    // Moving keeps the node, its tower and its index entry; the erase
+    // path doubles as a head start for the insert descent.
+    Node* path[kMaxSupportedLevels];
+    std::size_t rank[kMaxSupportedLevels];
+    find_path(node, path, rank);
+    unlink(node, path);
+    node->score = score;
+    link(node, path, rank);
+}
+
+void SkipList::find_path(const Node* node, Node** update, std::size_t* rank) const {
+    Node* current = header_;
+    std::size_t traversed = 0;
     for (int level = current_level_ - 1; level >= 0; --level) {
-        while (current->forward[level] && comes_before(current->forward[level], score, user_id)) {
-            current = current->forward[level];
+        while (current->levels()[level].forward &&
+               comes_before(current->levels()[level].forward, node->score, node->user_id)) {
+            traversed += current->levels()[level].span;
+            current = current->levels()[level].forward;
+        }
+        update[level] = current;
+        if (rank) {
+            rank[level] = traversed;
         }
-        update[static_cast<std::size_t>(level)] = current;
     }
+}
 
+// Links a detached node, keeping every span on the search path consistent:
+// rank[i] counts the level-0 steps taken to reach update[i]. A hint path
+// (nodes still in the list, with their ranks) lets a level resume from
+// its hint whenever that lies further along yet still before the node.
+void SkipList::link(Node* node, Node* const* hint, const std::size_t* hint_rank) {
+    Node* update[kMaxSupportedLevels];
+    std::size_t rank[kMaxSupportedLevels];
+    Node* current = header_;
+    for (int level = current_level_ - 1; level >= 0; --level) {
+        rank[level] = level == current_level_ - 1 ? 0 : rank[level + 1];
+        if (hint && hint_rank[level] > rank[level] && comes_before(hint[level], node->score, node->user_id)) {
+            current = hint[level];
+            rank[level] = hint_rank[level];
+        }
+        while (current->levels()[level].forward &&
+               comes_before(current->levels()[level].forward, node->score, node->user_id)) {
+            rank[level] += current->levels()[level].span;
+            current = current->levels()[level].forward;
+        }
+        update[level] = current;
+    }
+
+    const int node_level = node->level_count;
     if (node_level > current_level_) {
         for (int level = current_level_; level < node_level; ++level) {
-            update[static_cast<std::size_t>(level)] = header_.get();
+            rank[level] = 0;
+            update[level] = header_;
+            header_->levels()[level].span = size_;
         }
         current_level_ = node_level;
     }
 
-    insert_node(node, node_level, update);
-    index_[user_id] = node;
+    for (int level = 0; level < node_level; ++level) {
+        Node::Level& prev = update[level]->levels()[level];
+        Node::Level& own = node->levels()[level];
+        own.forward = prev.forward;
+        prev.forward = node;
+        own.span = prev.span - (rank[0] - rank[level]);
+        prev.span = rank[0] - rank[level] + 1;
+    }
+    // links above the new node now pass over one more entry
+    for (int level = node_level; level < current_level_; ++level) {
+        ++update[level]->levels()[level].span;
+    }
+
+    node->backward = update[0] == header_ ? nullptr : update[0];
+    if (Node* next = node->next()) {
+        next->backward = node;
+    } else {
+        tail_ = node;
+    }
     ++size_;
-    return node;
 }
 
-SkipList::Node* SkipList::find(const std::string& user_id) const {
+SkipList::Node* SkipList::find(std::string_view user_id) const {
     const auto it = index_.find(user_id);
     if (it == index_.end()) {
         return nullptr;
@@ -91,100 +253,198 @@ SkipList::Node* SkipList::find(const std::string& user_id) const {
     return it->second;
 }
 
-bool SkipList::erase(const std::string& user_id) {
+bool SkipList::erase(std::string_view user_id) {
     const auto it = index_.find(user_id);
     if (it == index_.end()) {
         return false;
     }
-    Node* target = it->second;
+    // by the node's own id: `user_id` may view the characters being freed
+    remove(it->second);
+    return true;
+}
 
-    std::vector<Node*> update(static_cast<std::size_t>(max_levels_), nullptr);
-    Node* current = header_.get();
-    for (int level = current_level_ - 1; level >= 0; --level) {
-        while (current->forward[level] && current->forward[level] != target &&
-               comes_before(current->forward[level], target->score, target->user_id)) {
-            current = current->forward[level];
-        }
-        update[static_cast<std::size_t>(level)] = current;
+void SkipList::remove(Node* node) {
+    Node* update[kMaxSupportedLevels];
+    find_path(node, update, nullptr);
+    unlink(node, update);
+    if (!borrow_ids_) {
+        index_.erase(node->user_id);
     }
+    destroy_node(node);
+}
 
-    bool removed = false;
-    for (int level = 0; level < static_cast<int>(target->forward.size()); ++level) {
-        if (update[static_cast<std::size_t>(level)]->forward[level] == target) {
-            update[static_cast<std::size_t>(level)]->forward[level] = target->forward[level];
-            removed = true;
+void SkipList::unlink(Node* node, Node* const* update) {
+    for (int level = 0; level < current_level_; ++level) {
+        Node::Level& prev = update[level]->levels()[level];
+        if (prev.forward == node) {
+            prev.span += node->levels()[level].span - 1;
+            prev.forward = node->levels()[level].forward;
+        } else {
+            --prev.span;
         }
     }
-
-    if (!removed) {
-        return false;
+    if (Node* next = node->next()) {
+        next->backward = node->backward;
+    } else {
+        tail_ = node->backward;
     }
-
-    while (current_level_ > 1 && header_->forward[current_level_ - 1] == nullptr) {
+    while (current_level_ > 1 && header_->levels()[current_level_ - 1].forward == nullptr) {
         --current_level_;
     }
-
-    index_.erase(it);
     --size_;
-    delete target;
-    return true;
 }
 
-void SkipList::clear() {
-    Node* current = header_->forward[0];
+void SkipList::destroy_all() noexcept {
+    // only blocks too large for a slab need returning one by one
+    Node* current = header_;
     while (current) {
-        Node* next = current->forward[0];
-        delete current;
+        Node* next = current->next();
+        destroy_node(current);
         current = next;
     }
-    for (auto& ptr : header_->forward) {
-        ptr = nullptr;
-    }
+    header_ = nullptr;
+}
+
+void SkipList::clear() {
+    destroy_all();
     index_.clear();
-    size_ = 0;
-    current_level_ = 1;
+    arena_.release();
+    reset_header();
+}
+
+void SkipList::bulk_load(const std::vector<BulkEntry>& entries) {
+    for (std::size_t i = 1; i < entries.size(); ++i) {
+        const auto& prev = entries[i - 1];
+        const auto& next = entries[i];
+        const bool ordered = prev.score > next.score || (prev.score == next.score && prev.user_id < next.user_id);
+        if (!ordered) {
+            throw std::invalid_argument("SkipList bulk_load entries must be sorted with unique ids");
+        }
+    }
+    // sorting by score only keeps equal ids together when their scores tie
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (!seen.insert(entry.user_id).second) {
+            throw std::invalid_argument("SkipList bulk_load entries must be sorted with unique ids");
+        }
+    }
+    clear();
+    if (!borrow_ids_) {
+        index_.reserve(entries.size());
+    }
+
+    const auto base = static_cast<std::size_t>(std::max(2L, std::lround(1.0 / probability_)));
+    Node* last[kMaxSupportedLevels];
+    std::size_t last_rank[kMaxSupportedLevels];
+    std::fill(last, last + kMaxSupportedLevels, header_);
+    std::fill(last_rank, last_rank + kMaxSupportedLevels, std::size_t{0});
+
+    Node* previous = nullptr;
+    std::size_t rank = 0;
+    for (const auto& entry : entries) {
+        ++rank;
+        int level = 1;
+        for (std::size_t r = rank; level < max_levels_ && r % base == 0; r /= base) {
+            ++level;
+        }
+        Node* node = create_node(level, entry.user_id, entry.score, entry.last_update);
+        for (int i = 0; i < level; ++i) {
+            last[i]->levels()[i] = Node::Level{node, rank - last_rank[i]};
+            last[i] = node;
+            last_rank[i] = rank;
+        }
+        node->backward = previous;
+        previous = node;
+        current_level_ = std::max(current_level_, level);
+        if (!borrow_ids_) {
+            index_.emplace(node->user_id, node);
+        }
+    }
+    // trailing links span the entries after their node, as link() expects
+    for (int i = 0; i < max_levels_; ++i) {
+        last[i]->levels()[i] = Node::Level{nullptr, entries.size() - last_rank[i]};
+    }
+    tail_ = previous;
+    size_ = entries.size();
 }
 
 std::vector<const SkipList::Node*> SkipList::top_k(std::size_t k) const {
     std::vector<const Node*> results;
     results.reserve(std::min(k, size_));
-    Node* current = header_->forward[0];
-    while (current && results.size() < k) {
+    for (const Node* current = head(); current && results.size() < k; current = current->next()) {
         results.push_back(current);
-        current = current->forward[0];
     }
     return results;
 }
 
-std::size_t SkipList::rank_of(const std::string& user_id) const {
-    std::size_t rank = 1;
-    Node* current = header_->forward[0];
-    while (current) {
-        if (current->user_id == user_id) {
+std::size_t SkipList::rank_of(std::string_view user_id) const {
+    return rank_of(find(user_id));
+}
+
+std::size_t SkipList::rank_of(const Node* target) const {
+    if (!target) {
+        return 0;
+    }
+    std::size_t rank = 0;
+    const Node* current = header_;
+    for (int level = current_level_ - 1; level >= 0; --level) {
+        while (current->levels()[level].forward &&
+               (current->levels()[level].forward == target ||
+                comes_before(current->levels()[level].forward, target->score, target->user_id))) {
+            rank += current->levels()[level].span;
+            current = current->levels()[level].forward;
+        }
+        if (current == target) {
             return rank;
         }
-        ++rank;
-        current = current->forward[0];
     }
     return 0;
 }
 
-SkipList::Node* SkipList::tail() const {
-    Node* current = header_->forward[0];
-    if (!current) {
+std::size_t SkipList::count_at_least(double score) const {
+    std::size_t count = 0;
+    const Node* current = header_;
+    for (int level = current_level_ - 1; level >= 0; --level) {
+        while (current->levels()[level].forward && current->levels()[level].forward->score >= score) {
+            count += current->levels()[level].span;
+            current = current->levels()[level].forward;
+        }
+    }
+    return count;
+}
+
+SkipList::Node* SkipList::at_rank(std::size_t rank) const {
+    if (rank == 0 || rank > size_) {
         return nullptr;
     }
-    while (current->forward[0]) {
-        current = current->forward[0];
+    std::size_t traversed = 0;
+    Node* current = header_;
+    for (int level = current_level_ - 1; level >= 0; --level) {
+        while (current->levels()[level].forward && traversed + current->levels()[level].span <= rank) {
+            traversed += current->levels()[level].span;
+            current = current->levels()[level].forward;
+        }
+        if (traversed == rank) {
+            return current;
+        }
     }
-    return current;
+    return nullptr;
 }
 
-void SkipList::insert_node(Node* node, int level, const std::vector<Node*>& update) {
-    for (int i = 0; i < level; ++i) {
-        node->forward[i] = update[static_cast<std::size_t>(i)]->forward[i];
-        update[static_cast<std::size_t>(i)]->forward[i] = node;
+std::vector<const SkipList::Node*> SkipList::range_by_rank(std::size_t start, std::size_t end) const {
+    std::vector<const Node*> results;
+    start = std::max<std::size_t>(start, 1);
+    end = std::min(end, size_);
+    if (start > end) {
+        return results;
     }
+    results.reserve(end - start + 1);
+    for (const Node* current = at_rank(start); current && results.size() <= end - start;
+         current = current->next()) {
+        results.push_back(current);
+    }
+    return results;
 }
 
 } // namespace engagehub::leaderboard
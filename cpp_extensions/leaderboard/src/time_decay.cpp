@@ -7,10 +7,11 @@
 namespace engagehub::leaderboard {
 
 TimeDecay::TimeDecay(double decay_factor)
-    : decay_factor_(decay_factor) {
+    : decay_factor_(decay_factor), log_rate_(0.0) {
     if (decay_factor_ <= 0.0 || decay_factor_ > 1.0) {
         throw std::invalid_argument("Decay factor must be in (0, 1]");
     }
+    log_rate_ = -std::log(decay_factor_) / 86400.0;
 }
 
 double TimeDecay::apply(double base_score, std::int64_t last_update_timestamp, std::int64_t current_timestamp) const {
@@ -0,0 +1,360 @@
+// Mixed-workload throughput, latency and memory benchmark for Leaderboard.
+//
+// For each board size the benchmark first populates a board with that many
+// users. It then replays Zipf-distributed traffic at every read/write mix,
+// with reader threads calling get_top_users and get_user_rank alongside the
+// writer. Next it applies the same skew through update_users batches.
+// Last, it saves and reloads the board as a binary snapshot and as JSON.
+// The board's clock advances as operations are applied, so writes run
+// through lazy decay and top-K invalidation as they do in production. One
+// JSON object per board size is written to stdout (or --output).
+//
+//   leaderboard_benchmark --users=10000,100000,1000000 --operations=1000000
+//       --read-percent=10,50,90 --reader-threads=2 --zipf=1.1 --batch=512
+
+#include "benchmark_support.hpp"
+#include "leaderboard.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using engagehub::LatencyHistogram;
+using engagehub::bench::JsonWriter;
+using engagehub::bench::Options;
+using engagehub::bench::ZipfGenerator;
+using engagehub::leaderboard::Leaderboard;
+using engagehub::leaderboard::ScoreUpdate;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr std::int64_t kBaseTime = 1696284800;
+constexpr std::size_t kTopK = 10;
+
+struct Config {
+    std::vector<std::size_t> user_counts;
+    std::size_t operations = 0;
+    std::vector<std::size_t> read_percents;
+    std::size_t reader_threads = 0;
+    std::size_t batch = 0;
+    double zipf = 0.0;
+    double decay = 0.0;
+    // the board clock moves one second per this many operations
+    std::size_t ops_per_second = 0;
+    // time one operation in this many on the writer
+    std::size_t latency_sample = 0;
+    std::string snapshot_dir;
+    bool json_snapshots = true;
+};
+
+std::uint64_t nanos_since(Clock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+double per_second(std::uint64_t count, std::uint64_t ns) {
+    return ns == 0 ? 0.0 : static_cast<double>(count) * 1e9 / static_cast<double>(ns);
+}
+
+double millis(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+std::uint64_t file_bytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+}
+
+// Zipf ranks drawn up front so the timed loops measure the board only.
+std::vector<std::uint32_t> zipf_stream(std::size_t users, std::size_t count, double exponent,
+                                       std::uint64_t seed) {
+    ZipfGenerator rank(users, exponent, seed);
+    std::vector<std::uint32_t> stream(count);
+    for (auto& user : stream) {
+        user = static_cast<std::uint32_t>(rank());
+    }
+    return stream;
+}
+
+class BoardClock {
+public:
+    std::int64_t now() const { return now_.load(std::memory_order_relaxed); }
+    void tick() { now_.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> now_{kBaseTime};
+};
+
+void populate(const Config& config, const std::vector<std::string>& ids, std::size_t users, Leaderboard& board,
+              BoardClock& clock, JsonWriter& json) {
+    LatencyHistogram latency;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < users; ++i) {
+        if (i % config.ops_per_second == 0) {
+            clock.tick();
+        }
+        const double points = static_cast<double>(1 + i % 97);
+        if (i % config.latency_sample == 0) {
+            const auto begin = Clock::now();
+            board.update_user(ids[i], points, clock.now());
+            latency.record(nanos_since(begin));
+        } else {
+            board.update_user(ids[i], points, clock.now());
+        }
+    }
+    const auto elapsed = nanos_since(start);
+
+    json.begin_object("populate");
+    json.field("updates_per_sec", per_second(users, elapsed));
+    json.latency("update_ns", latency.summary());
+    json.end_object();
+}
+
+void mixed(const Config& config, const std::vector<std::string>& ids, std::size_t users, std::size_t read_percent,
+           Leaderboard& board, BoardClock& clock, JsonWriter& json) {
+    const auto stream = zipf_stream(users, config.operations, config.zipf, 0x5eed + read_percent);
+
+    LatencyHistogram update_latency;
+    LatencyHistogram read_latency;
+    LatencyHistogram reader_top_latency;
+    LatencyHistogram reader_rank_latency;
+    std::atomic<std::uint64_t> reader_queries{0};
+    std::atomic<bool> running{true};
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> readers;
+    for (std::size_t r = 0; r < config.reader_threads; ++r) {
+        readers.emplace_back([&, r]() {
+            ZipfGenerator rank(users, config.zipf, 0xbeef + r);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            std::uint64_t queries = 0;
+            while (running.load(std::memory_order_acquire)) {
+                auto begin = Clock::now();
+                board.get_top_users(kTopK);
+                reader_top_latency.record(nanos_since(begin));
+                begin = Clock::now();
+                board.get_user_rank(ids[rank()]);
+                reader_rank_latency.record(nanos_since(begin));
+                queries += 2;
+            }
+            reader_queries.fetch_add(queries, std::memory_order_relaxed);
+        });
+    }
+    while (ready.load() != config.reader_threads) {
+        std::this_thread::yield();
+    }
+
+    std::size_t updates = 0;
+    std::size_t reads = 0;
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        if (i % config.ops_per_second == 0) {
+            clock.tick();
+        }
+        const auto& user = ids[stream[i]];
+        const bool sampled = i % config.latency_sample == 0;
+        const auto begin = sampled ? Clock::now() : Clock::time_point{};
+        // reads are spread evenly through the stream at the requested share
+        if (i % 100 < read_percent) {
+            if (reads++ % 2 == 0) {
+                board.get_user_rank(user);
+            } else {
+                board.get_top_users(kTopK);
+            }
+            if (sampled) {
+                read_latency.record(nanos_since(begin));
+            }
+        } else {
+            board.update_user(user, static_cast<double>(1 + i % 5), clock.now());
+            ++updates;
+            if (sampled) {
+                update_latency.record(nanos_since(begin));
+            }
+        }
+    }
+    const auto elapsed = nanos_since(start);
+    running.store(false, std::memory_order_release);
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    json.begin_object();
+    json.field("read_percent", read_percent);
+    json.field("operations", stream.size());
+    json.field("ops_per_sec", per_second(stream.size(), elapsed));
+    json.field("updates", updates);
+    json.field("reads", reads);
+    json.latency("update_ns", update_latency.summary());
+    json.latency("read_ns", read_latency.summary());
+    json.field("reader_queries", reader_queries.load());
+    json.field("reader_queries_per_sec", per_second(reader_queries.load(), elapsed));
+    json.latency("reader_top_users_ns", reader_top_latency.summary());
+    json.latency("reader_user_rank_ns", reader_rank_latency.summary());
+    json.end_object();
+}
+
+void batched(const Config& config, const std::vector<std::string>& ids, std::size_t users, Leaderboard& board,
+             BoardClock& clock, JsonWriter& json) {
+    const auto stream = zipf_stream(users, config.operations, config.zipf, 0xba7c4);
+    std::vector<ScoreUpdate> updates;
+    updates.reserve(config.batch);
+    LatencyHistogram latency;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < stream.size(); i += config.batch) {
+        updates.clear();
+        for (std::size_t j = i; j < std::min(stream.size(), i + config.batch); ++j) {
+            if (j % config.ops_per_second == 0) {
+                clock.tick();
+            }
+            updates.push_back(ScoreUpdate{ids[stream[j]], static_cast<double>(1 + j % 5), clock.now()});
+        }
+        const auto begin = Clock::now();
+        board.update_users(updates);
+        latency.record(nanos_since(begin));
+    }
+    const auto elapsed = nanos_since(start);
+
+    json.begin_object("batched");
+    json.field("batch", config.batch);
+    json.field("updates_per_sec", per_second(stream.size(), elapsed));
+    json.latency("batch_ns", latency.summary());
+    json.end_object();
+}
+
+void snapshots(const Config& config, std::size_t users, const Leaderboard& board, BoardClock& clock,
+               JsonWriter& json) {
+    const auto base = config.snapshot_dir + "/leaderboard_benchmark_" + std::to_string(users);
+    const auto reload = [&](auto&& save, auto&& load, const std::string& path, const char* key) {
+        Leaderboard restored(config.decay, users);
+        restored.set_time_source([&clock]() { return clock.now(); });
+        auto start = Clock::now();
+        save(path);
+        const auto save_ns = nanos_since(start);
+        start = Clock::now();
+        load(restored, path);
+        const auto load_ns = nanos_since(start);
+
+        const auto bytes = file_bytes(path);
+        json.begin_object(key);
+        json.field("file_bytes", bytes);
+        json.field("file_bytes_per_user", board.size() == 0 ? 0.0 : static_cast<double>(bytes) / board.size());
+        json.field("save_ms", millis(save_ns));
+        json.field("load_ms", millis(load_ns));
+        json.field("load_users_per_sec", per_second(restored.size(), load_ns));
+        json.field("loaded_users", restored.size());
+        json.end_object();
+        std::remove(path.c_str());
+    };
+
+    reload([&](const std::string& path) { board.save_snapshot(path); },
+           [](Leaderboard& restored, const std::string& path) { restored.load_snapshot(path); }, base + ".bin",
+           "binary_snapshot");
+    if (config.json_snapshots) {
+        reload([&](const std::string& path) { board.save_to_json(path); },
+               [](Leaderboard& restored, const std::string& path) { restored.load_from_json(path); },
+               base + ".json", "json_snapshot");
+    }
+}
+
+void run(const Config& config, const std::vector<std::string>& ids, std::size_t users, JsonWriter& json) {
+    BoardClock clock;
+    Leaderboard board(config.decay, users);
+    board.set_time_source([&clock]() { return clock.now(); });
+
+    json.begin_object();
+    json.field("users", users);
+    json.field("zipf", config.zipf);
+    json.field("decay_factor", config.decay);
+    json.field("reader_threads", config.reader_threads);
+    populate(config, ids, users, board, clock, json);
+
+    const auto bytes = board.memory_bytes();
+    json.begin_object("memory");
+    json.field("bytes", bytes);
+    json.field("bytes_per_user", static_cast<double>(bytes) / static_cast<double>(board.size()));
+    json.end_object();
+
+    json.begin_array("mixed");
+    for (const auto read_percent : config.read_percents) {
+        mixed(config, ids, users, read_percent, board, clock, json);
+    }
+    json.end_array();
+    batched(config, ids, users, board, clock, json);
+    snapshots(config, users, board, clock, json);
+    json.end_object();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options(argc, argv);
+        Config config;
+        config.user_counts = options.get_sizes("users", "10000,100000,1000000");
+        config.operations = options.get_size("operations", 1'000'000);
+        config.read_percents = options.get_sizes("read-percent", "10,50,90");
+        config.reader_threads = options.get_size("reader-threads", 2);
+        config.batch = std::max<std::size_t>(1, options.get_size("batch", 512));
+        config.zipf = options.get_double("zipf", 1.1);
+        config.decay = options.get_double("decay", 0.95);
+        config.ops_per_second = std::max<std::size_t>(1, options.get_size("ops-per-second", 1000));
+        config.latency_sample = std::max<std::size_t>(1, options.get_size("latency-sample", 16));
+        config.snapshot_dir = options.get("snapshot-dir", ".");
+        config.json_snapshots = options.get("json-snapshots", "true") == "true";
+        if (config.operations == 0 || config.user_counts.empty() || config.read_percents.empty()) {
+            throw std::invalid_argument("--operations, --users and --read-percent must be non-empty");
+        }
+        std::size_t max_users = 0;
+        for (const auto users : config.user_counts) {
+            if (users == 0) {
+                throw std::invalid_argument("--users entries must be positive");
+            }
+            max_users = std::max(max_users, users);
+        }
+        for (const auto percent : config.read_percents) {
+            if (percent > 100) {
+                throw std::invalid_argument("--read-percent entries must be at most 100");
+            }
+        }
+
+        std::vector<std::string> ids;
+        ids.reserve(max_users);
+        for (std::size_t i = 0; i < max_users; ++i) {
+            ids.push_back("user-" + std::to_string(i));
+        }
+
+        std::ofstream file;
+        const auto output = options.get("output", "");
+        if (!output.empty()) {
+            file.open(output);
+            if (!file) {
+                throw std::runtime_error("Failed to open file for writing: " + output);
+            }
+        }
+        JsonWriter json(output.empty() ? std::cout : file);
+        json.begin_object();
+        json.field("benchmark", "leaderboard");
+        json.field("operations", config.operations);
+        json.begin_array("runs");
+        for (const auto users : config.user_counts) {
+            run(config, ids, users, json);
+        }
+        json.end_array();
+        json.end_object();
+    } catch (const std::exception& error) {
+        std::cerr << "leaderboard_benchmark: " << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "leaderboard.hpp"
+#include "leaderboard_set.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using Catch::Approx;
+using engagehub::leaderboard::BoardSpec;
+using engagehub::leaderboard::Leaderboard;
+using engagehub::leaderboard::LeaderboardSet;
+
+namespace {
+constexpr std::int64_t kDay = 86400;
+constexpr std::int64_t kStart = 1696204800; // a UTC midnight
+
+BoardSpec all_time() {
+    return BoardSpec{"all_time", 0, 0, 1.0, 0, true};
+}
+
+BoardSpec daily() {
+    return BoardSpec{"daily", kDay, 0, 1.0, 0, true};
+}
+
+BoardSpec track(const std::string& name) {
+    return BoardSpec{name, 0, 0, 1.0, 0, false};
+}
+} // namespace
+
+TEST_CASE("LeaderboardSet fans updates out to default and named boards") {
+    LeaderboardSet set;
+    set.set_time_source([] { return kStart + 100; });
+    REQUIRE(set.add_board(all_time()) == 0);
+    REQUIRE(set.add_board(daily()) == 1);
+    REQUIRE(set.add_board(track("track:backend")) == 2);
+    REQUIRE_THROWS_AS(set.add_board(track("daily")), std::invalid_argument);
+    REQUIRE_THROWS_AS(set.add_board(BoardSpec{"", 0, 0, 1.0, 0, true}), std::invalid_argument);
+
+    set.update_user("alice", 10.0, kStart + 10, {"track:backend"});
+    set.update_user("bob", 30.0, kStart + 20);
+    set.update_user("alice", 25.0, kStart + 30, {"track:backend", "all_time"});
+    REQUIRE_THROWS_AS(set.update_user("carol", 5.0, kStart + 40, {"track:nope"}), std::invalid_argument);
+
+    REQUIRE(set.interned_users() == 2);
+    REQUIRE(set.size("all_time") == 2);
+    REQUIRE(set.size("track:backend") == 1);
+    REQUIRE(set.board_names() == std::vector<std::string>{"all_time", "daily", "track:backend"});
+
+    const auto top = set.get_top_users("all_time", 5);
+    REQUIRE(top.size() == 2);
+    REQUIRE(top[0].user_id == "alice");
+    REQUIRE(top[0].score == Approx(35.0));
+    REQUIRE(top[0].last_update == kStart + 30);
+
+    const auto ranks = set.get_user_ranks("bob");
+    REQUIRE(ranks.size() == 3);
+    REQUIRE(ranks[0]->rank == 2);
+    REQUIRE(ranks[1]->rank == 2);
+    REQUIRE_FALSE(ranks[2].has_value());
+    REQUIRE(set.get_user_rank("track:backend", "alice")->score == Approx(35.0));
+    REQUIRE_FALSE(set.get_user_rank("daily", "nobody").has_value());
+    REQUIRE_THROWS_AS(set.get_top_users("weekly", 1), std::invalid_argument);
+}
+
+TEST_CASE("LeaderboardSet rotates tumbling windows by swapping lists") {
+    LeaderboardSet set;
+    std::int64_t now = kStart + 100;
+    set.set_time_source([&now] { return now; });
+    set.add_board(all_time());
+    set.add_board(daily());
+
+    set.update_user("alice", 10.0, kStart + 100);
+    set.update_user("bob", 20.0, kStart + 200);
+
+    // the clock alone makes yesterday read as the closed window
+    now = kStart + kDay + 5;
+    REQUIRE(set.size("daily") == 0);
+    REQUIRE(set.get_top_users("daily", 5, true).size() == 2);
+
+    set.update_user("carol", 5.0, kStart + kDay + 10);
+    set.update_user("alice", 3.0, kStart + kDay + 20);
+    // an update for a closed window only reaches the boards still open to it
+    set.update_user("dave", 7.0, kStart + 50);
+    REQUIRE(set.get_user_rank("daily", "dave") == std::nullopt);
+    REQUIRE(set.get_user_rank("all_time", "dave").has_value());
+
+    const auto today = set.get_top_users("daily", 5);
+    REQUIRE(today.size() == 2);
+    REQUIRE(today[0].user_id == "carol");
+    REQUIRE(today[1].score == Approx(3.0));
+    const auto yesterday = set.get_top_users("daily", 5, true);
+    REQUIRE(yesterday.size() == 2);
+    REQUIRE(yesterday[0].user_id == "bob");
+    REQUIRE(set.get_user_rank("all_time", "alice")->score == Approx(13.0));
+
+    // two windows later neither list is current; bob is only on all-time now
+    now = kStart + 3 * kDay;
+    set.rotate_windows();
+    REQUIRE(set.size("daily") == 0);
+    REQUIRE(set.get_top_users("daily", 5, true).empty());
+    REQUIRE(set.interned_users() == 4);
+}
+
+TEST_CASE("LeaderboardSet recycles slots of users no board holds") {
+    LeaderboardSet set;
+    set.set_time_source([] { return kStart; });
+    set.add_board(BoardSpec{"hourly", 3600, 0, 1.0, 2, true});
+
+    set.update_user("a", 3.0, kStart);
+    set.update_user("b", 2.0, kStart);
+    set.update_user("c", 1.0, kStart);
+    REQUIRE(set.size("hourly") == 2);
+    // the evicted lowest entry gave its slot back
+    REQUIRE(set.interned_users() == 2);
+    REQUIRE_FALSE(set.get_user_rank("hourly", "c").has_value());
+
+    set.update_user("c", 0.0, kStart);
+    REQUIRE(set.interned_users() == 2);
+
+    set.update_user("d", 9.0, kStart + 2 * 3600);
+    set.update_user("e", 8.0, kStart + 2 * 3600);
+    REQUIRE(set.interned_users() == 2);
+    REQUIRE(set.get_top_users("hourly", 1)[0].user_id == "d");
+    REQUIRE(set.get_user_rank("hourly", "e")->rank == 2);
+}
+
+TEST_CASE("LeaderboardSet boards agree with independent leaderboards") {
+    LeaderboardSet set;
+    set.set_time_source([] { return kStart + 40 * kDay; });
+    set.add_board(BoardSpec{"decayed", 0, 0, 0.9, 0, true});
+    set.add_board(track("track:web"));
+
+    Leaderboard decayed(0.9, 0, 0);
+    Leaderboard web(1.0, 0, 0);
+    decayed.set_time_source([] { return kStart + 40 * kDay; });
+    web.set_time_source([] { return kStart + 40 * kDay; });
+
+    std::mt19937_64 rng(11);
+    for (int step = 0; step < 3000; ++step) {
+        const std::string user = "user-" + std::to_string(rng() % 200);
+        const double points = static_cast<double>(rng() % 20);
+        const std::int64_t at = kStart + step * 1000;
+        if (rng() % 3 == 0) {
+            set.update_user(user, points, at, {"track:web"});
+            web.update_user(user, points, at);
+        } else {
+            set.update_user(user, points, at);
+        }
+        decayed.update_user(user, points, at);
+    }
+
+    const auto compare = [&](const std::string& board, const Leaderboard& reference) {
+        const auto expected = reference.get_top_users(reference.size());
+        const auto actual = set.get_top_users(board, reference.size() + 5);
+        REQUIRE(actual.size() == expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            REQUIRE(actual[i].user_id == expected[i].user_id);
+            REQUIRE(actual[i].score == Approx(expected[i].score));
+            REQUIRE(actual[i].rank == expected[i].rank);
+        }
+    };
+    compare("decayed", decayed);
+    compare("track:web", web);
+    REQUIRE(set.interned_users() == decayed.size());
+}
+
+TEST_CASE("LeaderboardSet rebases a window without losing its entries") {
+    const std::int64_t now = kStart + 300 * kDay;
+    LeaderboardSet set;
+    set.set_time_source([now] { return now; });
+    set.add_board(BoardSpec{"halving", 0, 0, 0.5, 0, true});
+    Leaderboard reference(0.5, 0, 0);
+    reference.set_time_source([now] { return now; });
+
+    // at 0.5 keys outgrow e^64 after about 92 days, forcing rebases
+    for (int i = 0; i < 4; ++i) {
+        const std::int64_t at = kStart + i * 100 * kDay;
+        for (const char* user : {"alice", "bob", "carol"}) {
+            const double points = 1000.0 * (i + 1) + static_cast<double>(user[0]);
+            set.update_user(user, points, at);
+            reference.update_user(user, points, at);
+        }
+    }
+    const auto expected = reference.get_top_users(3);
+    const auto actual = set.get_top_users("halving", 3);
+    REQUIRE(actual.size() == 3);
+    for (std::size_t i = 0; i < 3; ++i) {
+        REQUIRE(actual[i].user_id == expected[i].user_id);
+        REQUIRE(actual[i].score == Approx(expected[i].score));
+    }
+    REQUIRE(set.get_user_rank("halving", "carol")->rank == 1);
+}
@@ -1,15 +1,29 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include "byte_io.hpp"
+#include "hashing.hpp"
 #include "leaderboard.hpp"
 #include "skip_list.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 using Catch::Approx;
 using engagehub::leaderboard::Leaderboard;
 using engagehub::leaderboard::RankEntry;
+using engagehub::leaderboard::ScoreUpdate;
 using engagehub::leaderboard::SkipList;
 
 TEST_CASE("SkipList maintains sorted order") {
@@ -28,6 +42,158 @@ TEST_CASE("SkipList maintains sorted order") {
     REQUIRE(list.rank_of("alice") == 3);
 }
 
+TEST_CASE("SkipList spans answer rank queries in any order of updates") {
+    SkipList list;
+    // reference ordering: descending score, then ascending id
+    std::map<std::string, double> scores;
+    std::mt19937_64 rng(7);
+    for (int step = 0; step < 4000; ++step) {
+        const std::string user = "user-" + std::to_string(rng() % 300);
+        if (rng() % 5 == 0) {
+            REQUIRE(list.erase(user) == (scores.erase(user) == 1));
+        } else {
+            const double score = static_cast<double>(rng() % 50);
+            list.upsert(user, score, step);
+            scores[user] = score;
+        }
+    }
+
+    std::vector<std::pair<double, std::string>> expected;
+    for (const auto& [user, score] : scores) {
+        expected.emplace_back(-score, user);
+    }
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(list.size() == expected.size());
+
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        const auto& user = expected[i].second;
+        REQUIRE(list.rank_of(user) == i + 1);
+        REQUIRE(list.at_rank(i + 1)->user_id == user);
+    }
+    REQUIRE(list.at_rank(0) == nullptr);
+    REQUIRE(list.at_rank(expected.size() + 1) == nullptr);
+    REQUIRE(list.rank_of("missing") == 0);
+
+    const auto range = list.range_by_rank(10, 19);
+    REQUIRE(range.size() == 10);
+    for (std::size_t i = 0; i < range.size(); ++i) {
+        REQUIRE(range[i]->user_id == expected[9 + i].second);
+    }
+    REQUIRE(list.range_by_rank(expected.size() - 1, expected.size() + 5).size() == 2);
+
+    // tail and backward links walk the same order in reverse
+    std::size_t index = expected.size();
+    for (const auto* node = list.tail(); node; node = node->backward) {
+        REQUIRE(node->user_id == expected[--index].second);
+    }
+    REQUIRE(index == 0);
+
+    list.clear();
+    REQUIRE(list.tail() == nullptr);
+    REQUIRE(list.at_rank(1) == nullptr);
+}
+
+TEST_CASE("SkipList repositions updated nodes without reallocating") {
+    SkipList list;
+    std::map<std::string, double> scores;
+    std::map<std::string, const SkipList::Node*> nodes;
+    for (int i = 0; i < 400; ++i) {
+        const std::string user = "user-" + std::to_string(i);
+        scores[user] = static_cast<double>(i);
+        nodes[user] = list.upsert(user, scores[user], 0);
+    }
+    const auto reserved = list.arena_bytes();
+
+    // small nudges mostly stay in place, larger jumps relink in both directions
+    std::mt19937_64 rng(11);
+    for (int step = 0; step < 20000; ++step) {
+        const std::string user = "user-" + std::to_string(rng() % 400);
+        const double delta = step % 7 == 0 ? static_cast<double>(rng() % 400) - 200.0
+                                           : static_cast<double>(rng() % 3) * 0.25 - 0.25;
+        scores[user] += delta;
+        REQUIRE(list.upsert(user, scores[user], step) == nodes[user]);
+    }
+    REQUIRE(list.arena_bytes() == reserved);
+    REQUIRE(list.size() == 400);
+
+    std::vector<std::pair<double, std::string>> expected;
+    for (const auto& [user, score] : scores) {
+        expected.emplace_back(-score, user);
+    }
+    std::sort(expected.begin(), expected.end());
+    std::size_t rank = 0;
+    const SkipList::Node* previous = nullptr;
+    for (const auto* node = list.head(); node; node = node->next()) {
+        REQUIRE(node->user_id == expected[rank].second);
+        REQUIRE(node->backward == previous);
+        REQUIRE(list.rank_of(node->user_id) == ++rank);
+        REQUIRE(list.at_rank(rank) == node);
+        previous = node;
+    }
+    REQUIRE(list.tail() == previous);
+}
+
+TEST_CASE("SkipList nodes share an arena and reuse freed blocks") {
+    SkipList list;
+    for (int i = 0; i < 5000; ++i) {
+        list.upsert("user-" + std::to_string(i), static_cast<double>(i), i);
+    }
+    const auto reserved = list.arena_bytes();
+    REQUIRE(reserved > 0);
+
+    // churn the same users: freed blocks are recycled, not re-reserved
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 5000; ++i) {
+            list.upsert("user-" + std::to_string(i), static_cast<double>(round * i % 977), i);
+        }
+    }
+    REQUIRE(list.size() == 5000);
+    REQUIRE(list.arena_bytes() <= reserved + 64 * 1024);
+
+    // an update may pass a view of the node's own id
+    const auto* node = list.find("user-42");
+    list.upsert(node->user_id, 1e9, 7);
+    REQUIRE(list.head()->user_id == "user-42");
+    REQUIRE(list.rank_of("user-42") == 1);
+
+    // ids too long for a pooled block are stored all the same
+    const std::string long_id(4096, 'x');
+    list.upsert(long_id, 2e9, 8);
+    REQUIRE(list.head()->user_id == long_id);
+    REQUIRE(list.erase(long_id));
+    REQUIRE(list.find(long_id) == nullptr);
+
+    list.clear();
+    REQUIRE(list.size() == 0);
+    REQUIRE(list.arena_bytes() < reserved);
+    list.upsert("again", 1.0, 1);
+    REQUIRE(list.head()->user_id == "again");
+}
+
+TEST_CASE("Leaderboard answers rank ranges and around-me windows") {
+    Leaderboard board(0.95, 100);
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    board.set_time_source([base_time]() { return base_time; });
+    for (int i = 0; i < 20; ++i) {
+        board.update_user("user-" + std::to_string(i), static_cast<double>(100 - i), base_time);
+    }
+
+    const auto range = board.get_users_in_rank_range(5, 7);
+    REQUIRE(range.size() == 3);
+    REQUIRE(range[0].user_id == "user-4");
+    REQUIRE(range[0].rank == 5);
+    REQUIRE(range[2].user_id == "user-6");
+    REQUIRE(board.get_users_in_rank_range(19, 50).size() == 2);
+    REQUIRE_THROWS_AS(board.get_users_in_rank_range(0, 3), std::invalid_argument);
+
+    const auto around = board.get_users_around("user-1", 2);
+    REQUIRE(around.size() == 4);
+    REQUIRE(around.front().rank == 1);
+    REQUIRE(around.back().user_id == "user-3");
+    REQUIRE(board.get_users_around("user-10", 1).size() == 3);
+    REQUIRE(board.get_users_around("nobody", 3).empty());
+}
+
 TEST_CASE("Leaderboard applies time decay") {
     Leaderboard board(0.95, 10);
     board.set_time_source([]() { return static_cast<std::int64_t>(1696284800); });
@@ -45,6 +211,179 @@ TEST_CASE("Leaderboard applies time decay") {
     REQUIRE(rank.score == Approx(expected).epsilon(0.05));
 }
 
+TEST_CASE("Leaderboard decays lazily against a shared epoch") {
+    const auto day = static_cast<std::int64_t>(86400);
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    std::int64_t now = base_time;
+    Leaderboard board(0.5, 100);
+    board.set_time_source([&now]() { return now; });
+
+    board.update_user("alice", 100.0, base_time);
+    board.update_user("bob", 60.0, base_time + day);
+    // a late event decays from its own timestamp
+    board.update_user("carol", 80.0, base_time + 2 * day);
+    board.update_user("carol", 40.0, base_time + day);
+
+    now = base_time + 2 * day;
+    auto top = board.get_top_users(3);
+    REQUIRE(top.size() == 3);
+    REQUIRE(top[0].user_id == "carol");
+    REQUIRE(top[0].score == Approx(80.0 + 20.0));
+    REQUIRE(top[0].last_update == base_time + 2 * day);
+    REQUIRE(top[1].user_id == "bob");
+    REQUIRE(top[1].score == Approx(30.0));
+    REQUIRE(top[2].score == Approx(25.0));
+
+    // reads leave stored state alone, so repeated queries agree
+    now = base_time + 4 * day;
+    REQUIRE(board.get_top_users(3)[0].score == Approx(25.0));
+    REQUIRE(board.get_user_rank("alice")->score == Approx(100.0 / 16.0));
+    REQUIRE(board.get_user_rank("alice")->last_update == base_time);
+
+    // two hundred half-lives forces a rebase; order and scores survive it
+    now = base_time + 200 * day;
+    board.update_user("dave", 1.0, now);
+    board.update_user("alice", 0.0, now);
+    top = board.get_top_users(4);
+    REQUIRE(top.size() == 4);
+    REQUIRE(top[0].user_id == "dave");
+    REQUIRE(top[0].score == Approx(1.0));
+    REQUIRE(top[1].user_id == "carol");
+    REQUIRE(top[1].score == Approx(100.0 * std::pow(0.5, 198.0)));
+    REQUIRE(top[3].user_id == "alice");
+    REQUIRE(top[3].last_update == now);
+}
+
+TEST_CASE("Leaderboard JSON snapshots keep decayed scores") {
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    std::int64_t now = base_time + 86400;
+    Leaderboard board(0.9, 100);
+    board.set_time_source([&now]() { return now; });
+    board.update_user("alice", 100.0, base_time);
+    board.update_user("bob", 95.0, base_time + 86400);
+
+    const auto path = std::string("leaderboard_decay_snapshot.json");
+    board.save_to_json(path);
+    Leaderboard restored;
+    restored.set_time_source([&now]() { return now; });
+    restored.load_from_json(path);
+    std::remove(path.c_str());
+
+    const auto top = restored.get_top_users(2);
+    REQUIRE(top.size() == 2);
+    REQUIRE(top[0].user_id == "bob");
+    REQUIRE(top[0].score == Approx(95.0));
+    REQUIRE(top[1].score == Approx(90.0));
+}
+
+TEST_CASE("SkipList bulk load builds consistent spans bottom-up") {
+    std::vector<std::string> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back("user-" + std::to_string(100000 + i));
+    }
+    std::vector<SkipList::BulkEntry> entries;
+    for (int i = 0; i < 1000; ++i) {
+        // pairs of equal scores exercise the id tie-break
+        entries.push_back(SkipList::BulkEntry{ids[static_cast<std::size_t>(i)], 5000.0 - i / 2, i});
+    }
+
+    SkipList list;
+    list.upsert("stale", 1.0, 0);
+    list.bulk_load(entries);
+    REQUIRE(list.size() == 1000);
+    REQUIRE(list.find("stale") == nullptr);
+    REQUIRE(list.tail()->user_id == ids.back());
+    for (std::size_t i = 0; i < ids.size(); i += 37) {
+        REQUIRE(list.rank_of(ids[i]) == i + 1);
+        REQUIRE(list.at_rank(i + 1)->user_id == ids[i]);
+    }
+
+    // the loaded list keeps working as a normal skip list
+    list.upsert(ids[999], 1e6, 1);
+    list.upsert("fresh", 4999.75, 2);
+    REQUIRE(list.head()->user_id == ids[999]);
+    REQUIRE(list.rank_of("fresh") == 4);
+    REQUIRE(list.erase(ids[500]));
+    // ids[999] and "fresh" now rank ahead of ids[501]; ids[500] is gone
+    REQUIRE(list.rank_of(ids[501]) == 503);
+    REQUIRE(list.at_rank(503)->user_id == ids[501]);
+    REQUIRE(list.size() == 1000);
+
+    std::swap(entries[3], entries[4]);
+    REQUIRE_THROWS_AS(list.bulk_load(entries), std::invalid_argument);
+    REQUIRE(list.size() == 1000);
+
+    // a repeated id with a different score passes the order check alone
+    const std::vector<SkipList::BulkEntry> repeated = {{"a", 10.0, 1}, {"b", 7.0, 1}, {"a", 5.0, 1}};
+    REQUIRE_THROWS_AS(list.bulk_load(repeated), std::invalid_argument);
+    REQUIRE(list.size() == 1000);
+    SkipList borrowed(16, 0.5, true);
+    REQUIRE_THROWS_AS(borrowed.bulk_load(repeated), std::invalid_argument);
+    REQUIRE(borrowed.size() == 0);
+}
+
+TEST_CASE("Leaderboard binary snapshots round-trip and reject corruption") {
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    std::int64_t now = base_time + 86400;
+    Leaderboard board(0.9, 500, 10);
+    board.set_time_source([&now]() { return now; });
+    for (int i = 0; i < 300; ++i) {
+        board.update_user("user-" + std::to_string(i), static_cast<double>(i % 97), base_time + i);
+    }
+    // ids that trip up the JSON loader
+    board.update_user("brace}bracket]\"quote", 500.0, base_time);
+
+    const auto path = std::string("leaderboard_snapshot.bin");
+    board.save_snapshot(path);
+    Leaderboard restored;
+    restored.set_time_source([&now]() { return now; });
+    restored.load_snapshot(path);
+
+    REQUIRE(restored.size() == board.size());
+    const auto expected = board.get_users_in_rank_range(1, 301);
+    const auto actual = restored.get_users_in_rank_range(1, 301);
+    REQUIRE(actual.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(actual[i].user_id == expected[i].user_id);
+        REQUIRE(actual[i].score == expected[i].score);
+        REQUIRE(actual[i].last_update == expected[i].last_update);
+    }
+    REQUIRE(actual[0].user_id == "brace}bracket]\"quote");
+    restored.update_user("user-1", 1000.0, now);
+    REQUIRE(restored.get_top_users(1)[0].user_id == "user-1");
+
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const auto write_file = [&](const std::string& contents) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    };
+    auto corrupt = bytes;
+    corrupt[40] = static_cast<char>(corrupt[40] ^ 0x5A);
+    write_file(corrupt);
+    REQUIRE_THROWS_AS(restored.load_snapshot(path), std::runtime_error);
+    write_file(bytes.substr(0, bytes.size() / 2));
+    REQUIRE_THROWS_AS(restored.load_snapshot(path), std::runtime_error);
+    write_file("EHSK" + bytes.substr(4));
+    REQUIRE_THROWS_AS(restored.load_snapshot(path), std::runtime_error);
+    // a well-formed file that repeats an id further down the ranking
+    auto duplicated = bytes.substr(0, bytes.size() - sizeof(std::uint64_t));
+    const auto original = duplicated.find("\x08user-100");
+    REQUIRE(original != std::string::npos);
+    duplicated.replace(original, 9, "\x08user-200");
+    engagehub::ByteWriter(duplicated)
+        .put<std::uint64_t>(engagehub::hashing::murmur3_64(duplicated.data(), duplicated.size(),
+                                                           engagehub::hashing::kDefaultSeed));
+    write_file(duplicated);
+    REQUIRE_THROWS_AS(restored.load_snapshot(path), std::runtime_error);
+    REQUIRE(restored.size() == board.size());
+    std::remove(path.c_str());
+    REQUIRE_THROWS_AS(restored.load_snapshot(path), std::runtime_error);
+}
+
 TEST_CASE("Leaderboard top-k returns ranked entries") {
     Leaderboard board(0.95, 10);
     const auto base_time = static_cast<std::int64_t>(1696284800);
@@ -59,3 +398,204 @@ TEST_CASE("Leaderboard top-k returns ranked entries") {
     REQUIRE(top[1].user_id == "alice");
     REQUIRE(top[1].rank == 2);
 }
+
+TEST_CASE("Leaderboard answers percentile, quantile and histogram queries from spans") {
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    Leaderboard board(1.0, 0, 0);
+    board.set_time_source([base_time]() { return base_time; });
+    REQUIRE(board.get_histogram(4).empty());
+    REQUIRE(board.get_score_quantiles({0.5}).empty());
+
+    std::mt19937_64 rng(5);
+    std::map<std::string, double> scores;
+    for (int step = 0; step < 2000; ++step) {
+        const std::string user = "user-" + std::to_string(rng() % 500);
+        const double points = static_cast<double>(rng() % 40) + 1.0;
+        board.update_user(user, points, base_time);
+        scores[user] += points;
+    }
+    std::vector<double> ascending;
+    for (const auto& [user, score] : scores) {
+        ascending.push_back(score);
+    }
+    std::sort(ascending.begin(), ascending.end());
+    const auto n = ascending.size();
+
+    for (const auto& [user, score] : scores) {
+        const auto below = std::lower_bound(ascending.begin(), ascending.end(), score) - ascending.begin();
+        REQUIRE(*board.get_percentile(user) == Approx(100.0 * static_cast<double>(below) / static_cast<double>(n)));
+    }
+    REQUIRE_FALSE(board.get_percentile("nobody").has_value());
+
+    const std::vector<double> quantiles = {0.0, 0.1, 0.5, 0.99, 1.0};
+    const auto values = board.get_score_quantiles(quantiles);
+    REQUIRE(values.size() == quantiles.size());
+    for (std::size_t i = 0; i < quantiles.size(); ++i) {
+        const auto nearest = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(quantiles[i] * n)));
+        REQUIRE(values[i] == Approx(ascending[nearest - 1]));
+    }
+    REQUIRE_THROWS_AS(board.get_score_quantiles({1.5}), std::invalid_argument);
+
+    const auto histogram = board.get_histogram(7);
+    REQUIRE(histogram.size() == 7);
+    REQUIRE(histogram.front().lower == ascending.front());
+    REQUIRE(histogram.back().upper == ascending.back());
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < histogram.size(); ++i) {
+        const auto& bin = histogram[i];
+        const auto first = std::lower_bound(ascending.begin(), ascending.end(), bin.lower);
+        const auto last = i + 1 == histogram.size() ? ascending.end()
+                                                     : std::lower_bound(ascending.begin(), ascending.end(), bin.upper);
+        REQUIRE(bin.count == static_cast<std::size_t>(last - first));
+        total += bin.count;
+    }
+    REQUIRE(total == n);
+    REQUIRE_THROWS_AS(board.get_histogram(0), std::invalid_argument);
+
+    Leaderboard flat(0.9, 0, 0);
+    flat.set_time_source([base_time]() { return base_time + 86400; });
+    flat.update_user("a", 10.0, base_time);
+    flat.update_user("b", 10.0, base_time);
+    const auto single = flat.get_histogram(3);
+    REQUIRE(single.size() == 1);
+    REQUIRE(single[0].count == 2);
+    REQUIRE(single[0].upper == Approx(9.0));
+    REQUIRE(*flat.get_percentile("b") == Approx(0.0));
+    REQUIRE(flat.get_score_quantiles({1.0})[0] == Approx(9.0));
+}
+
+TEST_CASE("Leaderboard batches coalesce duplicate users") {
+    const auto day = static_cast<std::int64_t>(86400);
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    Leaderboard batched(0.9, 100);
+    Leaderboard sequential(0.9, 100);
+    for (auto* board : {&batched, &sequential}) {
+        board->set_time_source([base_time, day]() { return base_time + 3 * day; });
+    }
+
+    const std::vector<std::string> users = {"alice", "bob", "alice", "carol", "alice", "bob", "dave"};
+    const std::vector<double> points = {10.0, 4.0, 5.0, 0.0, 2.5, -1.0, 7.0};
+    const std::vector<std::int64_t> times = {base_time, base_time + day, base_time + 2 * day,
+                                             base_time, base_time + day, 0, base_time + 3 * day};
+    std::vector<ScoreUpdate> updates;
+    for (std::size_t i = 0; i < users.size(); ++i) {
+        updates.push_back(ScoreUpdate{users[i], points[i], times[i]});
+        sequential.update_user(users[i], points[i], times[i]);
+    }
+    batched.update_users(updates);
+
+    // carol only ever had a zero-point update, so she never joins
+    REQUIRE(batched.size() == 3);
+    const auto expected = sequential.get_top_users(10);
+    const auto actual = batched.get_top_users(10);
+    REQUIRE(actual.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(actual[i].user_id == expected[i].user_id);
+        REQUIRE(actual[i].score == Approx(expected[i].score));
+        REQUIRE(actual[i].last_update == expected[i].last_update);
+    }
+    REQUIRE(actual[0].user_id == "alice");
+    REQUIRE(actual[0].last_update == base_time + 2 * day);
+}
+
+TEST_CASE("Leaderboard caches the top-K view until it changes") {
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    std::int64_t now = base_time;
+    Leaderboard board(0.95, 1000, 3);
+    board.set_time_source([&now]() { return now; });
+    for (int i = 0; i < 10; ++i) {
+        board.update_user("user-" + std::to_string(i), static_cast<double>(100 - 10 * i), base_time);
+    }
+
+    const auto first = board.get_top_snapshot();
+    REQUIRE(first->entries.size() == 3);
+    REQUIRE(first->entries[0].user_id == "user-0");
+    REQUIRE(board.get_top_snapshot() == first);
+
+    // below the K-th entry: same view
+    const auto version = board.top_version();
+    board.update_user("user-9", 5.0, base_time);
+    board.update_user("newcomer", 1.0, base_time);
+    REQUIRE(board.top_version() == version);
+    REQUIRE(board.get_top_snapshot() == first);
+
+    // climbing into the top region publishes a new view
+    board.update_user("user-5", 45.0, base_time);
+    REQUIRE(board.top_version() != version);
+    const auto second = board.get_top_snapshot();
+    REQUIRE(second != first);
+    REQUIRE(second->entries[0].user_id == "user-0");
+    REQUIRE(second->entries[1].user_id == "user-5");
+    REQUIRE(board.get_top_users(2).size() == 2);
+    REQUIRE(board.get_top_users(2)[1].score == Approx(95.0));
+
+    // scores are reported as of the current second
+    now = base_time + 86400;
+    const auto third = board.get_top_snapshot();
+    REQUIRE(third != second);
+    REQUIRE(third->entries[0].score == Approx(95.0));
+
+    REQUIRE(board.get_top_users_json(0) == "[]");
+    REQUIRE(board.get_top_users_json(1) ==
+            "[{\"user_id\": \"user-0\", \"score\": 95, \"rank\": 1, \"last_update\": 1696284800}]");
+    REQUIRE(board.get_top_users_json(3) == third->json);
+    const auto wide = board.get_top_users_json(5);
+    REQUIRE(wide.rfind(third->json.substr(0, third->json.size() - 1), 0) == 0);
+    REQUIRE(board.get_top_users(5).size() == 5);
+
+    Leaderboard uncached(0.95, 1000, 0);
+    uncached.update_user("solo", 1.0, base_time);
+    REQUIRE(uncached.get_top_snapshot() == nullptr);
+    REQUIRE(uncached.get_top_users(1).size() == 1);
+}
+
+TEST_CASE("Leaderboard serves top-k without a cache when top_cache_size is 0") {
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    Leaderboard board(0.95, 0, 0);
+    board.set_time_source([base_time]() { return base_time; });
+    REQUIRE(board.get_top_snapshot() == nullptr);
+    REQUIRE(board.get_top_users(0).empty());
+    REQUIRE(board.get_top_users_json(0) == "[]");
+
+    board.update_user("alice", 20.0, base_time);
+    board.update_user("bob", 10.0, base_time);
+    REQUIRE(board.get_top_users(0).empty());
+    REQUIRE(board.get_top_users_json(0) == "[]");
+    const auto top = board.get_top_users(5);
+    REQUIRE(top.size() == 2);
+    REQUIRE(top[0].user_id == "alice");
+    REQUIRE(board.get_top_users_json(1).find("\"alice\"") != std::string::npos);
+    REQUIRE(board.get_top_users_json(1).find("\"bob\"") == std::string::npos);
+}
+
+TEST_CASE("Leaderboard readers run alongside a writer") {
+    Leaderboard board(0.95, 500);
+    const auto base_time = static_cast<std::int64_t>(1696284800);
+    board.set_time_source([base_time]() { return base_time; });
+
+    std::atomic<int> unordered{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            for (int query = 0; query < 2000; ++query) {
+                const auto top = board.get_top_users(20);
+                for (std::size_t i = 1; i < top.size(); ++i) {
+                    if (top[i - 1].score < top[i].score || top[i].rank != i + 1) {
+                        unordered.fetch_add(1);
+                    }
+                }
+                board.get_user_rank("user-7");
+                board.size();
+            }
+        });
+    }
+    for (int i = 0; i < 20000; ++i) {
+        board.update_user("user-" + std::to_string(i % 700), 1.0 + i % 13, base_time + i);
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    REQUIRE(unordered.load() == 0);
+    REQUIRE(board.size() == 500);
+}
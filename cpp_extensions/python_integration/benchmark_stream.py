@@ -0,0 +1,131 @@
+"""End-to-end EventStreamProcessor benchmark with a Python flush callback.
+
+Complements ``event_processor/tests/stream_benchmark.cpp`` (pure C++ ingest,
+drain and query cost) by measuring what a bot or Django worker actually pays:
+GIL hand-offs, Python-side batch decoding, and ``push_events`` from several
+Python threads. Prints one JSON document, e.g.::
+
+    python3 python_integration/benchmark_stream.py --producers 1 2 4 --columnar
+"""
+
+from __future__ import annotations
+
+import argparse
+import bisect
+import itertools
+import json
+import random
+import threading
+import time
+
+import cpp_event_processor
+
+
+def zipf_sampler(n: int, exponent: float, seed: int):
+    cumulative = list(itertools.accumulate(1.0 / (k + 1) ** exponent for k in range(n)))
+    total = cumulative[-1]
+    rng = random.Random(seed)
+
+    def draw() -> int:
+        return min(bisect.bisect_left(cumulative, rng.random() * total), n - 1)
+
+    return draw
+
+
+def percentile(samples: list[float], quantile: float) -> float:
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(quantile * len(ordered)))]
+
+
+def run(args: argparse.Namespace, producers: int) -> dict:
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=args.ring,
+        num_threads=2,
+        batch_size=args.batch,
+        flush_interval_ms=50,
+        num_shards=args.shards,
+    )
+    delivered = 0
+    lock = threading.Lock()
+
+    def on_flush(batch) -> None:
+        nonlocal delivered
+        # touch the payload the way a real sink would
+        size = len(batch.user_ids) if args.columnar else len(batch)
+        with lock:
+            delivered += size
+
+    processor.set_flush_callback(on_flush, columnar=args.columnar)
+
+    now = int(time.time())
+    per_producer = args.events // producers
+    chunks = []
+    for producer in range(producers):
+        user = zipf_sampler(args.users, args.zipf, 17 + producer)
+        channel = zipf_sampler(args.channels, args.zipf, 71 + producer)
+        events = [("message", f"user-{user()}", f"channel-{channel()}", now) for _ in range(per_producer)]
+        chunks.append([events[i : i + args.chunk] for i in range(0, len(events), args.chunk)])
+
+    latencies: list[list[float]] = [[] for _ in range(producers)]
+    barrier = threading.Barrier(producers + 1)
+
+    def produce(index: int) -> None:
+        barrier.wait()
+        for chunk in chunks[index]:
+            start = time.perf_counter()
+            processor.push_events(chunk)
+            latencies[index].append((time.perf_counter() - start) * 1e6 / len(chunk))
+
+    threads = [threading.Thread(target=produce, args=(i,)) for i in range(producers)]
+    for thread in threads:
+        thread.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for thread in threads:
+        thread.join()
+    processor.flush_now()
+    elapsed = time.perf_counter() - start
+
+    pushed = per_producer * producers
+    samples = [value for per_thread in latencies for value in per_thread]
+    metrics = processor.get_metrics()
+    return {
+        "producers": producers,
+        "events": pushed,
+        "columnar": args.columnar,
+        "delivered": delivered,
+        "dropped": processor.events_dropped(),
+        "drop_rate": processor.events_dropped() / pushed if pushed else 0.0,
+        "end_to_end_events_per_sec": delivered / elapsed if elapsed > 0 else 0.0,
+        "push_us_per_event": {
+            "p50": percentile(samples, 0.50),
+            "p99": percentile(samples, 0.99),
+            "p999": percentile(samples, 0.999),
+        },
+        "enqueue_to_flush_us": metrics["enqueue_to_flush_us"],
+        "callback_us": metrics["callback_us"],
+    }
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--producers", type=int, nargs="+", default=[1, 2, 4])
+    parser.add_argument("--events", type=int, default=200_000)
+    parser.add_argument("--chunk", type=int, default=512, help="events per push_events call")
+    parser.add_argument("--ring", type=int, default=1 << 16)
+    parser.add_argument("--batch", type=int, default=512)
+    parser.add_argument("--shards", type=int, default=4)
+    parser.add_argument("--users", type=int, default=100_000)
+    parser.add_argument("--channels", type=int, default=1_000)
+    parser.add_argument("--zipf", type=float, default=1.1)
+    parser.add_argument("--columnar", action="store_true", help="deliver columnar batches")
+    args = parser.parse_args()
+
+    runs = [run(args, producers) for producers in args.producers]
+    print(json.dumps({"benchmark": "event_processor_python", "runs": runs}, indent=2))
+
+
+if __name__ == "__main__":
+    main()
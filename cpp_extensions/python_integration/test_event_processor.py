@@ -1,9 +1,11 @@
+import asyncio
 import threading
 import time
 
 import pytest
 
 import cpp_event_processor
+import cpp_leaderboard
 
 
 def test_event_processor_flow():
@@ -64,3 +66,302 @@ def test_event_processor_drop_when_full():
     assert successes <= 16
     dropped = processor.events_dropped()
     assert dropped >= 0
+
+
+def test_event_processor_sharded_consumers():
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=4096,
+        num_threads=2,
+        batch_size=64,
+        flush_interval_ms=50,
+        num_shards=4,
+    )
+    assert processor.shard_count() == 4
+
+    flushed = []
+    lock = threading.Lock()
+
+    def callback(events):
+        with lock:
+            flushed.extend(events)
+
+    processor.set_flush_callback(callback)
+
+    now = int(time.time())
+    for idx in range(400):
+        assert processor.push_event("message", f"user-{idx % 40}", f"channel-{idx % 8}", now)
+
+    processor.flush_now()
+
+    assert len(flushed) == 400
+    top_channels = processor.get_top_channels(8)
+    assert len(top_channels) == 8
+    assert all(count == 50 for _, count in top_channels)
+    assert processor.get_unique_users_last_hour() >= 38
+
+
+def test_event_processor_bulk_push():
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024,
+        num_threads=1,
+        batch_size=64,
+        flush_interval_ms=50,
+    )
+
+    flushed = []
+    lock = threading.Lock()
+
+    def callback(events):
+        with lock:
+            flushed.extend(events)
+
+    processor.set_flush_callback(callback)
+
+    now = int(time.time())
+    accepted = processor.push_events(
+        [("message", f"user-{idx}", "general", now) for idx in range(100)]
+    )
+    assert accepted == 100
+
+    accepted = processor.push_events(
+        ["reaction"] * 50,
+        [f"user-{idx}" for idx in range(50)],
+        ["random"] * 50,
+        [now] * 50,
+    )
+    assert accepted == 50
+
+    with pytest.raises(ValueError):
+        processor.push_events(["message"], ["user"], [], [now])
+
+    processor.flush_now()
+    assert len(flushed) == 150
+    assert processor.events_dropped() == 0
+
+
+def test_event_processor_columnar_flush():
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024,
+        num_threads=1,
+        batch_size=256,
+        flush_interval_ms=50,
+    )
+
+    batches = []
+    lock = threading.Lock()
+
+    def callback(batch):
+        with lock:
+            batches.append(batch)
+
+    processor.set_flush_callback(callback, columnar=True)
+
+    now = int(time.time())
+    for idx in range(20):
+        assert processor.push_event("message", f"user-{idx % 4}", "general", now + idx)
+    processor.flush_now()
+
+    assert sum(len(batch) for batch in batches) == 20
+    batch = batches[0]
+
+    timestamps = memoryview(batch.timestamps)
+    assert timestamps.format == "q"
+    assert timestamps.readonly
+    assert list(timestamps) == [now + idx for idx in range(len(batch))]
+
+    user_ids = memoryview(batch.user_ids)
+    strings = batch.strings
+    assert [strings[key] for key in user_ids] == [f"user-{idx % 4}" for idx in range(len(batch))]
+    assert batch.decode(memoryview(batch.channel_ids)[0]) == "general"
+
+    rows = batch.to_list()
+    assert rows[0]["type"] == "message"
+    assert rows[0]["timestamp"] == now
+
+
+def test_event_processor_block_overflow_policy():
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=8,
+        num_threads=1,
+        batch_size=16,
+        flush_interval_ms=10,
+        overflow_policy=cpp_event_processor.OverflowPolicy.BLOCK,
+        block_timeout_ms=5000,
+    )
+    assert processor.overflow_policy == cpp_event_processor.OverflowPolicy.BLOCK
+
+    now = int(time.time())
+    events = [("message", f"user-{idx}", "general", now) for idx in range(200)]
+    assert processor.push_events(events) == 200
+    processor.flush_now()
+
+    assert processor.events_dropped() == 0
+    assert processor.events_overwritten() == 0
+    assert processor.total_events_processed() == 200
+
+
+def test_event_processor_sketch_snapshot_round_trip(tmp_path):
+    now = int(time.time())
+    worker = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=32, flush_interval_ms=10
+    )
+    worker.set_flush_callback(lambda batch: None)
+    worker.push_events([("message", f"user-{idx}", "general", now) for idx in range(300)])
+    worker.flush_now()
+
+    snapshot = worker.serialize_sketches()
+    assert isinstance(snapshot, bytes)
+
+    aggregator = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=32, flush_interval_ms=10, num_shards=2
+    )
+    aggregator.merge_from(snapshot)
+    assert aggregator.get_unique_users_last_hour() == worker.get_unique_users_last_hour()
+    assert aggregator.estimate_channel_count("general") >= 300
+
+    path = tmp_path / "sketches.bin"
+    aggregator.save_sketches(str(path))
+    restarted = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=32, flush_interval_ms=10
+    )
+    restarted.load_sketches(str(path))
+    assert restarted.get_unique_users_last_hour() == worker.get_unique_users_last_hour()
+
+    with pytest.raises(RuntimeError):
+        restarted.merge_from(snapshot[:-1])
+
+
+def test_event_processor_unique_users_per_dimension():
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=32, flush_interval_ms=10, num_shards=2
+    )
+    processor.set_flush_callback(lambda batch: None)
+    now = int(time.time())
+    events = [("message", f"user-{idx}", "general", now) for idx in range(200)]
+    events += [("reaction", f"user-{idx}", "random", now) for idx in range(50)]
+    assert processor.push_events(events) == 250
+    processor.flush_now()
+
+    assert 190 <= processor.get_unique_users("general") <= 210
+    reactions = processor.get_unique_users("random", window_seconds=300)
+    assert 47 <= reactions <= 53
+    assert processor.get_unique_users("missing") == 0
+    assert processor.get_unique_users_by_event_type("reaction") == reactions
+    assert processor.dimension_memory_bytes() > 0
+
+    with pytest.raises(ValueError):
+        processor.get_unique_users("general", window_seconds=7200)
+
+
+def test_event_processor_metrics():
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=16, flush_interval_ms=10
+    )
+    assert processor.metrics_mode == cpp_event_processor.MetricsMode.SAMPLED
+    processor.metrics_mode = cpp_event_processor.MetricsMode.FULL
+    processor.set_flush_callback(lambda batch: None)
+
+    now = int(time.time())
+    processor.push_events([("message", f"user-{idx}", "general", now) for idx in range(64)])
+    processor.flush_now()
+
+    metrics = processor.get_metrics()
+    assert metrics["events_processed"] == 64
+    assert metrics["batches_flushed"] >= 4
+    assert metrics["pending_flush_tasks"] == 0
+    assert metrics["enqueue_to_flush_us"]["count"] == 64
+    assert metrics["callback_us"]["count"] == metrics["batches_flushed"]
+    latency = metrics["enqueue_to_flush_us"]
+    assert latency["p50"] <= latency["p99"] <= latency["p999"] <= latency["max"]
+    assert len(metrics["shards"]) == 1
+    assert 0.0 <= metrics["consumer_busy_ratio"] <= 1.0
+
+
+def test_event_processor_spill_journal_replays_after_restart(tmp_path):
+    journal = str(tmp_path / "journal")
+    now = int(time.time())
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=16, flush_interval_ms=10
+    )
+    processor.enable_spill_journal(journal)
+    assert processor.spill_journal_enabled()
+    # no callback yet, so every flushed batch goes to the journal
+    assert processor.push_events([("message", f"user-{idx}", "general", now) for idx in range(64)]) == 64
+    processor.flush_now()
+    assert processor.events_spilled() == 64
+    assert processor.get_metrics()["spill_pending_records"] > 0
+    del processor
+
+    delivered = []
+    lock = threading.Lock()
+
+    def callback(batch):
+        with lock:
+            delivered.extend(batch)
+
+    restarted = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=16, flush_interval_ms=10
+    )
+    restarted.set_flush_callback(callback)
+    restarted.enable_spill_journal(journal)
+    restarted.flush_now()
+
+    assert len(delivered) == 64
+    assert restarted.spilled_pending() == 0
+    assert restarted.events_replayed() == 64
+
+
+def test_event_processor_async_batches():
+    async def consume():
+        processor = cpp_event_processor.EventStreamProcessor(
+            buffer_size=1024, num_threads=1, batch_size=16, flush_interval_ms=10
+        )
+        stream = processor.batches(max_pending=8)
+        loop_thread = threading.get_ident()
+        handled_on = set()
+
+        now = int(time.time())
+        assert processor.push_events([("message", f"user-{idx}", "general", now) for idx in range(64)]) == 64
+        await asyncio.get_running_loop().run_in_executor(None, processor.flush_now)
+
+        users = []
+        async for batch in stream:
+            handled_on.add(threading.get_ident())
+            users.extend(event["user_id"] for event in batch)
+            if len(users) == 64:
+                break
+        assert sorted(users) == sorted(f"user-{idx}" for idx in range(64))
+        assert handled_on == {loop_thread}
+        assert stream.poll() is None
+
+        # a waiting consumer is woken by new batches and by close()
+        waiter = asyncio.ensure_future(stream.__anext__())
+        await asyncio.sleep(0.01)
+        assert not waiter.done()
+        assert processor.push_event("message", "late", "general", now)
+        batch = await asyncio.wait_for(waiter, timeout=2.0)
+        assert batch[0]["user_id"] == "late"
+
+        stream.close()
+        assert stream.closed
+        assert [batch async for batch in stream] == []
+
+    asyncio.run(consume())
+
+
+def test_event_processor_native_leaderboard_sink():
+    now = int(time.time())
+    board = cpp_leaderboard.Leaderboard(decay_factor=0.95, max_users=100)
+    board.set_time_source(lambda: now)
+    processor = cpp_event_processor.EventStreamProcessor(
+        buffer_size=1024, num_threads=1, batch_size=16, flush_interval_ms=10
+    )
+    sink = processor.add_leaderboard_sink([board], {"message": 1.0, "reaction": 2.0})
+    events = [("message", "alice", "general", now)] * 3 + [("reaction", "bob", "general", now)] * 2
+    events += [("join", "carol", "general", now)]
+    assert processor.push_events(events) == 6
+    processor.flush_now()
+
+    assert sink.events_scored() == 5
+    top = board.get_top_users(3)
+    assert [(entry["user_id"], entry["score"]) for entry in top] == [("bob", 4.0), ("alice", 3.0)]
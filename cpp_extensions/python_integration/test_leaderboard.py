@@ -1,3 +1,5 @@
+import array
+import json
 import math
 import time
 
@@ -50,3 +52,163 @@ def test_leaderboard_decay():
     assert rank is not None
     expected = 100.0 * math.pow(0.95, 3.0)
     assert rank["score"] == pytest.approx(expected, rel=0.05)
+
+
+def test_leaderboard_rank_range_and_around():
+    board = cpp_leaderboard.Leaderboard(decay_factor=0.95, max_users=100)
+    now = 1696284800
+    board.set_time_source(lambda: now)
+    for i in range(20):
+        board.update_user(f"user-{i}", float(100 - i), now)
+
+    page = board.get_users_in_rank_range(5, 7)
+    assert [entry["user_id"] for entry in page] == ["user-4", "user-5", "user-6"]
+    assert [entry["rank"] for entry in page] == [5, 6, 7]
+    assert len(board.get_users_in_rank_range(19, 50)) == 2
+    with pytest.raises(ValueError):
+        board.get_users_in_rank_range(0, 3)
+
+    window = board.get_users_around("user-10", 2)
+    assert [entry["rank"] for entry in window] == [9, 10, 11, 12, 13]
+    assert board.get_users_around("missing", 2) == []
+
+
+def test_leaderboard_top_cache_payload():
+    board = cpp_leaderboard.Leaderboard(decay_factor=0.95, max_users=100, top_cache_size=5)
+    now = 1696284800
+    board.set_time_source(lambda: now)
+    for i in range(10):
+        board.update_user(f"user-{i}", float(100 - i), now)
+
+    assert board.top_cache_size == 5
+    version = board.top_version
+    board.update_user("user-9", 1.0, now)
+    assert board.top_version == version
+
+    payload = board.get_top_users_json(3)
+    assert isinstance(payload, bytes)
+    assert json.loads(payload) == board.get_top_users(3)
+
+    board.update_user("user-8", 50.0, now)
+    assert board.top_version != version
+    assert json.loads(board.get_top_users_json(2))[0]["user_id"] == "user-8"
+    assert len(json.loads(board.get_top_users_json(8))) == 8
+
+
+def test_leaderboard_update_users_batches():
+    now = 1696284800
+    batched = cpp_leaderboard.Leaderboard(decay_factor=0.95)
+    sequential = cpp_leaderboard.Leaderboard(decay_factor=0.95)
+    updates = [("alice", 10.0, now), ("bob", 4.0), ("alice", 5.0, now + 60), ("carol", 0.0, now)]
+    for board in (batched, sequential):
+        board.set_time_source(lambda: now + 60)
+    for update in updates:
+        sequential.update_user(update[0], update[1], update[2] if len(update) == 3 else 0)
+    batched.update_users(iter(updates))
+
+    assert batched.size() == 2
+    assert [entry["user_id"] for entry in batched.get_top_users(5)] == ["alice", "bob"]
+    assert batched.get_user_rank("alice")["score"] == pytest.approx(sequential.get_user_rank("alice")["score"])
+    with pytest.raises(ValueError):
+        batched.update_users([("alice",)])
+
+    columns = cpp_leaderboard.Leaderboard()
+    columns.set_time_source(lambda: now)
+    columns.update_users_arrays(
+        ["dave", "erin", "dave"],
+        array.array("d", [1.0, 2.0, 3.0]),
+        array.array("q", [now, now, now]),
+    )
+    assert [entry["user_id"] for entry in columns.get_top_users(2)] == ["dave", "erin"]
+    assert columns.get_user_rank("dave")["score"] == pytest.approx(4.0)
+    with pytest.raises(ValueError):
+        columns.update_users_arrays(["dave"], array.array("f", [1.0]))
+    # unsigned stamps past INT64_MAX would read back as negative, i.e. "now"
+    with pytest.raises(ValueError):
+        columns.update_users_arrays(["dave"], array.array("d", [1.0]), array.array("Q", [2**63]))
+
+
+def test_leaderboard_update_users_numpy():
+    np = pytest.importorskip("numpy")
+    board = cpp_leaderboard.Leaderboard()
+    now = 1696284800
+    board.set_time_source(lambda: now)
+    ids = np.array(["user-%d" % (i % 50) for i in range(1000)])
+    points = np.ones(1000, dtype=np.float64)
+    stamps = np.full(1000, now, dtype=np.int64)
+    board.update_users_arrays(ids, points, stamps)
+    assert board.size() == 50
+    assert board.get_top_users(1)[0]["score"] == pytest.approx(20.0)
+
+
+def test_leaderboard_distribution_queries():
+    now = 1696284800
+    board = cpp_leaderboard.Leaderboard(decay_factor=1.0, max_users=0)
+    board.set_time_source(lambda: now)
+    for i in range(100):
+        board.update_user(f"user-{i}", float(i + 1), now)
+
+    assert board.get_percentile("user-99") == pytest.approx(99.0)
+    assert board.get_percentile("user-0") == pytest.approx(0.0)
+    assert board.get_percentile("missing") is None
+    assert board.get_score_quantiles([0.0, 0.5, 1.0]) == pytest.approx([1.0, 50.0, 100.0])
+    with pytest.raises(ValueError):
+        board.get_score_quantiles([-0.1])
+
+    histogram = board.get_histogram(4)
+    assert [bin["count"] for bin in histogram] == [25, 25, 25, 25]
+    assert histogram[0]["lower"] == pytest.approx(1.0)
+    assert histogram[-1]["upper"] == pytest.approx(100.0)
+
+
+def test_leaderboard_binary_snapshot(tmp_path):
+    now = 1696284800
+    board = cpp_leaderboard.Leaderboard(decay_factor=0.9, max_users=1000)
+    board.set_time_source(lambda: now)
+    for i in range(200):
+        board.update_user(f"user-{i}", float(i % 17), now - i)
+    board.update_user('odd}id]"', 99.0, now)
+
+    path = tmp_path / "leaderboard.bin"
+    board.save_snapshot(str(path))
+    restored = cpp_leaderboard.Leaderboard()
+    restored.set_time_source(lambda: now)
+    restored.load_snapshot(str(path))
+
+    assert restored.size() == board.size()
+    assert restored.get_users_in_rank_range(1, 201) == board.get_users_in_rank_range(1, 201)
+    assert restored.get_top_users(1)[0]["user_id"] == 'odd}id]"'
+
+    path.write_bytes(path.read_bytes()[:-3])
+    with pytest.raises(RuntimeError):
+        restored.load_snapshot(str(path))
+    assert restored.size() == board.size()
+
+
+def test_leaderboard_set_windows_and_tracks():
+    day = 86400
+    clock = {"now": 1696204800 + 60}
+    boards = cpp_leaderboard.LeaderboardSet()
+    boards.set_time_source(lambda: clock["now"])
+    boards.add_board("all_time")
+    boards.add_board("daily", window_seconds=day)
+    boards.add_board("track:backend", receives_all=False)
+
+    boards.update_user("alice", 10.0, boards=["track:backend"])
+    boards.update_user("bob", 20.0)
+    assert boards.interned_users == 2
+    assert boards.get_top_users("daily", 5)[0]["user_id"] == "bob"
+
+    ranks = boards.get_user_ranks("alice")
+    assert list(ranks) == ["all_time", "daily", "track:backend"]
+    assert ranks["all_time"]["rank"] == 2
+    assert ranks["track:backend"]["rank"] == 1
+
+    clock["now"] += day
+    boards.update_user("carol", 5.0)
+    assert [entry["user_id"] for entry in boards.get_top_users("daily", 5)] == ["carol"]
+    assert [entry["user_id"] for entry in boards.get_top_users("daily", 5, previous_window=True)] == ["bob", "alice"]
+    assert boards.size("all_time") == 3
+
+    with pytest.raises(ValueError):
+        boards.update_user("dave", 1.0, boards=["track:missing"])
@@ -7,3 +7,19 @@ echo "=== Running Performance Benchmarks ==="
 echo ""
 /usr/bin/python3 python_integration/benchmark_comparison.py
 
+
+if [ -x build/event_processor/event_processor_benchmark ]; then
+    echo ""
+    echo "=== Event processor multi-producer benchmark (JSON) ==="
+    build/event_processor/event_processor_benchmark --producers=1,2,4 --events=1000000
+fi
+
+if [ -x build/leaderboard/leaderboard_benchmark ]; then
+    echo ""
+    echo "=== Leaderboard mixed-workload benchmark (JSON) ==="
+    build/leaderboard/leaderboard_benchmark --users=10000,100000,1000000 --operations=1000000
+fi
+
+echo ""
+echo "=== Event processor end-to-end with Python callback (JSON) ==="
+/usr/bin/python3 python_integration/benchmark_stream.py --producers 1 2 4